@@ -31,6 +31,7 @@ ProjectileFlags = ["CLIENTID_BIT{}".format(i) for i in range(8)] + [
 	"NO_OWNER", "IS_DDNET", "BOUNCE_HORIZONTAL", "BOUNCE_VERTICAL",
 	"EXPLOSIVE", "FREEZE",
 ]
+Box2DBodyFlags = ["STATIC", "ASLEEP", "OTHERTEAM", "KINEMATIC"]
 
 Emoticons = ["OOP", "EXCLAMATION", "HEARTS", "DROP", "DOTDOT", "MUSIC", "SORRY", "GHOST", "SUSHI", "SPLATTEE", "DEVILTEE", "ZOMG", "ZZZ", "WTF", "EYES", "QUESTION"]
 
@@ -88,6 +89,7 @@ Flags = [
 	Flags("GAMEINFOFLAG2", GameInfoFlags2),
 	Flags("EXPLAYERFLAG", ExPlayerFlags),
 	Flags("PROJECTILEFLAG", ProjectileFlags),
+	Flags("BOX2DBODYFLAG", Box2DBodyFlags),
 ]
 
 Objects = [
@@ -263,6 +265,37 @@ Objects = [
 		NetTick("m_StartTick"),
 	]),
 
+	# A box2d body of a ddnet-box2d server, drawn with the Box2DShape item
+	# whose ID is m_Shape. The state is a keyframe taken at m_Tick, which
+	# only changes once the body moved too far from where the client
+	# extrapolates it to. m_Angle is in 1/65536 turns, the velocities are
+	# in 1/256 units and 1/65536 turns per tick.
+	NetObjectEx("Box2DBody", "box2d-body@netobj.ddnet-box2d", [
+		NetIntAny("m_X"),
+		NetIntAny("m_Y"),
+		NetIntAny("m_Angle"),
+		NetIntAny("m_Shape"),
+		NetIntAny("m_VelX"),
+		NetIntAny("m_VelY"),
+		NetIntAny("m_AngularVel"),
+		NetTick("m_Tick"),
+		NetIntAny("m_Flags"),
+	]),
+
+	NetObjectEx("Box2DShape", "box2d-shape@netobj.ddnet-box2d", [
+		NetIntAny("m_Width"),
+		NetIntAny("m_Height"),
+	]),
+
+	# The box2d world the Box2DBody items are in. m_TickTime is how many
+	# microseconds the world advances per tick, m_GravityX and m_GravityY
+	# are in 1/1000 meters per second squared, with 30 units per meter.
+	NetObjectEx("Box2DWorld", "box2d-world@netobj.ddnet-box2d", [
+		NetIntAny("m_TickTime"),
+		NetIntAny("m_GravityX"),
+		NetIntAny("m_GravityY"),
+	]),
+
 	## Events
 
 	NetEvent("Common", [
@@ -487,4 +520,7 @@ Messages = [
 		NetIntAny("m_ServerTimeBest"),
 		NetIntAny("m_PlayerTimeBest"),
 	]),
+
+	# Tells a ddnet-box2d server to send Box2DBody items instead of lasers.
+	NetMessageEx("Cl_Box2DSupport", "box2d-support@netmsg.ddnet-box2d", []),
 ]
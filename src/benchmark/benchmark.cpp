@@ -0,0 +1,109 @@
+#include "benchmark.h"
+
+#include <base/math.h>
+#include <base/system.h>
+#include <engine/config.h>
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/storage.h>
+#include <game/box2d_map.h>
+#include <game/collision.h>
+#include <game/layers.h>
+
+static bool LoadMap(const char *pMapName, CBenchmarkMap *pMap)
+{
+	IKernel *pKernel = IKernel::Create();
+	IStorage *pStorage = CreateLocalStorage();
+	IEngineMap *pEngineMap = CreateEngineMap();
+	pKernel->RegisterInterface(pStorage);
+	pKernel->RegisterInterface(pEngineMap); // register as both
+	pKernel->RegisterInterface(static_cast<IMap *>(pEngineMap), false);
+
+	bool Result = pEngineMap->Load(pMapName);
+	if(Result)
+	{
+		CLayers Layers;
+		CCollision Collision;
+		Layers.Init(pKernel);
+		Collision.Init(&Layers);
+		pMap->m_Width = Collision.GetWidth();
+		pMap->m_Height = Collision.GetHeight();
+		GetSolidTiles(&Collision, pMap->m_vSolid);
+	}
+	delete pKernel;
+	return Result;
+}
+
+// a floor with walls and rows of platforms, so the boxes have something to
+// land on when no map is given
+static void GenerateMap(CBenchmarkMap *pMap)
+{
+	pMap->m_Width = 500;
+	pMap->m_Height = 150;
+	pMap->m_vSolid.assign(pMap->m_Width * pMap->m_Height, 0);
+	for(int y = 0; y < pMap->m_Height; y++)
+	{
+		for(int x = 0; x < pMap->m_Width; x++)
+		{
+			bool Border = x < 2 || x >= pMap->m_Width - 2 || y >= pMap->m_Height - 4;
+			bool Platform = y > 20 && y % 12 == 0 && (x / 7) % 3 == 0;
+			bool Pillar = x % 40 == 0 && y > pMap->m_Height - 30;
+			pMap->m_vSolid[y * pMap->m_Width + x] = Border || Platform || Pillar;
+		}
+	}
+}
+
+// usage: benchmark [map] [-tees n] [-boxes n] [-ticks n] [-json file] [-demo file]
+int main(int argc, const char **argv)
+{
+	dbg_logger_stdout();
+
+	const char *pMapName = 0;
+	const char *pJsonFile = "benchmark.json";
+	const char *pDemoName = 0;
+	int NumTees = 16;
+	int NumBoxes = 300;
+	int NumTicks = 1000;
+	for(int i = 1; i < argc; i++)
+	{
+		if(str_comp(argv[i], "-tees") == 0 && i + 1 < argc)
+			NumTees = maximum(str_toint(argv[++i]), 0);
+		else if(str_comp(argv[i], "-boxes") == 0 && i + 1 < argc)
+			NumBoxes = maximum(str_toint(argv[++i]), 0);
+		else if(str_comp(argv[i], "-ticks") == 0 && i + 1 < argc)
+			NumTicks = maximum(str_toint(argv[++i]), 1);
+		else if(str_comp(argv[i], "-json") == 0 && i + 1 < argc)
+			pJsonFile = argv[++i];
+		else if(str_comp(argv[i], "-demo") == 0 && i + 1 < argc)
+			pDemoName = argv[++i];
+		else
+			pMapName = argv[i];
+	}
+
+	// the tee bodies read their joint settings from the config
+	IConfigManager *pConfigManager = CreateConfigManager();
+	pConfigManager->Reset();
+
+	CBenchmarkMap Map;
+	if(pMapName)
+	{
+		if(!LoadMap(pMapName, &Map))
+		{
+			dbg_msg("benchmark", "failed to load map '%s'", pMapName);
+			return -1;
+		}
+		dbg_msg("benchmark", "map '%s' (%dx%d)", pMapName, Map.m_Width, Map.m_Height);
+	}
+	else
+	{
+		GenerateMap(&Map);
+		dbg_msg("benchmark", "generated map (%dx%d)", Map.m_Width, Map.m_Height);
+	}
+
+	BenchmarkSnapshotStorage();
+	BenchmarkSnapshotDelta(pDemoName);
+	BenchmarkBox2DMap(Map);
+	if(!BenchmarkBox2DServer(Map, pMapName ? pMapName : "generated", NumTees, NumBoxes, NumTicks, pJsonFile))
+		return -1;
+	return 0;
+}
@@ -0,0 +1,27 @@
+#ifndef BENCHMARK_BENCHMARK_H
+#define BENCHMARK_BENCHMARK_H
+
+#include <vector>
+
+// a Width * Height mask of solid tiles, either loaded from a map or generated
+class CBenchmarkMap
+{
+public:
+	int m_Width;
+	int m_Height;
+	std::vector<unsigned char> m_vSolid;
+};
+
+// compares map colliders built from merged tile outlines against one box per tile
+void BenchmarkBox2DMap(const CBenchmarkMap &Map);
+// ticks tees and boxes in a box2d world like the server does, with scripted
+// explosions and hammer hits, and writes the time of every phase to a json file
+bool BenchmarkBox2DServer(const CBenchmarkMap &Map, const char *pMapName, int NumTees, int NumBoxes, int NumTicks, const char *pJsonFile);
+// compares the ring of CSnapshotStorage against a malloc() per snapshot,
+// with the snapshots kept and looked up like the server does
+void BenchmarkSnapshotStorage();
+// compares CSnapshotDelta against the scalar version it replaced on the
+// snapshots of a demo, or generated ones of a full server without one
+void BenchmarkSnapshotDelta(const char *pDemoName);
+
+#endif // BENCHMARK_BENCHMARK_H
@@ -0,0 +1,64 @@
+#include "benchmark.h"
+
+#include <base/system.h>
+#include <game/box2d_map.h>
+
+#include <box2d/box2d.h>
+
+static const int NUM_BOXES = 300;
+static const int NUM_STEPS = 500;
+
+static double Milliseconds(int64_t Ticks)
+{
+	return Ticks * 1000.0 / time_freq();
+}
+
+// drops boxes from every few empty tiles and steps the world like the server does
+static void Run(const char *pName, const CBenchmarkMap &Map, bool Merged)
+{
+	b2World World(b2Vec2(0.f, 9.81f));
+
+	int64_t BuildStart = time_get();
+	if(Merged)
+	{
+		std::vector<CTileOutline> vOutlines;
+		FindTileOutlines(Map.m_vSolid.data(), Map.m_Width, Map.m_Height, vOutlines);
+		CreateMapBody(&World, vOutlines);
+	}
+	else
+	{
+		CreateMapBodyPerTile(&World, Map.m_vSolid.data(), Map.m_Width, Map.m_Height);
+	}
+	int64_t BuildTime = time_get() - BuildStart;
+	int NumProxies = World.GetProxyCount();
+
+	int NumTiles = Map.m_Width * Map.m_Height;
+	int NumBoxes = 0;
+	for(int i = 0; i < NumTiles && NumBoxes < NUM_BOXES; i += 97)
+	{
+		if(Map.m_vSolid[i])
+			continue;
+		b2BodyDef BodyDef;
+		BodyDef.type = b2_dynamicBody;
+		BodyDef.position = b2Vec2(((i % Map.m_Width) * 32 + 16) / 30.f, ((i / Map.m_Width) * 32 + 16) / 30.f);
+		b2Body *pBody = World.CreateBody(&BodyDef);
+		b2PolygonShape Shape;
+		Shape.SetAsBox(0.5f, 0.5f);
+		pBody->CreateFixture(&Shape, 1.f);
+		NumBoxes++;
+	}
+
+	int64_t StepStart = time_get();
+	for(int i = 0; i < NUM_STEPS; i++)
+		World.Step(1.f / 30, 8, 3);
+	int64_t StepTime = time_get() - StepStart;
+
+	dbg_msg("box2d_map", "%s: build=%.2fms proxies=%d boxes=%d step=%.4fms/step",
+		pName, Milliseconds(BuildTime), NumProxies, NumBoxes, Milliseconds(StepTime) / NUM_STEPS);
+}
+
+void BenchmarkBox2DMap(const CBenchmarkMap &Map)
+{
+	Run("per_tile", Map, false);
+	Run("outlines", Map, true);
+}
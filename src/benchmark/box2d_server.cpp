@@ -0,0 +1,439 @@
+#include "benchmark.h"
+
+#include <base/math.h>
+#include <base/system.h>
+#include <engine/shared/compression.h>
+#include <engine/shared/config.h>
+#include <engine/shared/json.h>
+#include <engine/shared/snapshot.h>
+#include <game/box2d_map.h>
+#include <game/gamecore.h>
+#include <game/generated/protocol.h>
+#include <game/server/box2d_tee.h>
+#include <game/server/box2d_world.h>
+
+#include <memory>
+#include <string>
+
+enum
+{
+	PHASE_TEES = 0,
+	PHASE_EXPLOSIONS,
+	PHASE_STEP,
+	PHASE_SNAP,
+	NUM_PHASES,
+};
+
+static const char *s_apPhaseNames[NUM_PHASES] = {"tees", "explosions", "step", "snap"};
+
+// every this many ticks, something explodes next to one of the boxes
+static const int EXPLOSION_INTERVAL = 5;
+// and every tee hammers once in this many ticks
+static const int HAMMER_INTERVAL = 50;
+// and dies and respawns once in this many ticks
+static const int RESPAWN_INTERVAL = 150;
+
+static const ivec2 s_aBoxSizes[] = {ivec2(32, 32), ivec2(64, 32), ivec2(48, 48)};
+
+class CPhaseTime
+{
+public:
+	int64_t m_Total;
+	int64_t m_Max;
+
+	CPhaseTime() :
+		m_Total(0), m_Max(0) {}
+
+	void Add(int64_t Time)
+	{
+		m_Total += Time;
+		m_Max = maximum(m_Max, Time);
+	}
+};
+
+// the tee body as it was before CBox2DTee went kinematic, a dynamic circle
+// pulled by a mouse joint on a dummy body, to compare the two against
+class CJointTee
+{
+	CBox2DWorld *m_pWorld;
+	b2Body *m_pBody;
+	b2Body *m_pDummyBody;
+	b2MouseJoint *m_pJoint;
+
+	vec2 m_HammerDir;
+	int m_HammerTick;
+	int m_HammerTickAdd;
+
+public:
+	CJointTee() :
+		m_pWorld(0), m_pBody(0), m_pDummyBody(0), m_pJoint(0), m_HammerDir(0, 0), m_HammerTick(0), m_HammerTickAdd(0) {}
+
+	void Create(CBox2DWorld *pWorld, vec2 Pos)
+	{
+		m_pWorld = pWorld;
+
+		b2BodyDef BodyDef;
+		BodyDef.position = b2Vec2(Pos.x / B2_SCALE, Pos.y / B2_SCALE);
+		BodyDef.type = b2_dynamicBody;
+		m_pBody = m_pWorld->CreateBody(&BodyDef);
+
+		b2CircleShape Shape;
+		Shape.m_radius = 30 / 2 / B2_SCALE;
+		b2FixtureDef FixtureDef;
+		FixtureDef.density = 1.f;
+		FixtureDef.shape = &Shape;
+		m_pBody->CreateFixture(&FixtureDef);
+
+		b2BodyDef DummyBodyDef;
+		m_pDummyBody = m_pWorld->CreateBody(&DummyBodyDef);
+
+		// the defaults of the old b2_teejoint_* settings
+		b2MouseJointDef JointDef;
+		JointDef.bodyA = m_pDummyBody;
+		JointDef.bodyB = m_pBody;
+		JointDef.target = BodyDef.position;
+		JointDef.maxForce = 100000;
+		JointDef.damping = 4;
+		JointDef.stiffness = 100000;
+		JointDef.collideConnected = true;
+		m_pJoint = (b2MouseJoint *)m_pWorld->CreateJoint(&JointDef);
+		m_pBody->SetAwake(true);
+
+		m_HammerTick = 0;
+		m_HammerTickAdd = 0;
+	}
+
+	void Destroy()
+	{
+		if(m_pBody)
+		{
+			// takes the joint with it
+			m_pWorld->DestroyBody(m_pBody);
+			m_pWorld->DestroyBody(m_pDummyBody);
+		}
+		m_pWorld = 0;
+		m_pBody = 0;
+		m_pDummyBody = 0;
+		m_pJoint = 0;
+	}
+
+	void Hammer(vec2 Dir)
+	{
+		m_HammerDir = Dir;
+		m_HammerTick = 0;
+		m_HammerTickAdd = 10;
+	}
+
+	void Tick(vec2 Pos, float SteppedTime, float StepTime)
+	{
+		Pos += m_HammerDir * m_HammerTick;
+		m_HammerTick += m_HammerTickAdd;
+		if(m_HammerTick >= 60)
+			m_HammerTickAdd = -20;
+		else if(m_HammerTick == 0)
+			m_HammerTickAdd = 0;
+
+		m_pJoint->SetTarget(b2Vec2(Pos.x / B2_SCALE, Pos.y / B2_SCALE));
+	}
+
+	b2Body *Body() const { return m_pBody; }
+};
+
+class CServerRun
+{
+public:
+	const char *m_pName;
+	int m_ExplosionMode;
+	// use CJointTee instead of CBox2DTee
+	bool m_JointTees;
+	// the tees run back and forth over this many units, at most
+	// m_TeeRange * m_TeeFrequency units per tick
+	float m_TeeRange;
+	float m_TeeFrequency;
+	CPhaseTime m_aPhases[NUM_PHASES];
+	int m_NumTees;
+	int m_NumBoxes;
+	int m_MaxParticles;
+	int m_MaxSnapItems;
+	// how far a tee body was behind its tee after a step, and the fastest
+	// box in units per tick, flung boxes and tunneling show up in these
+	float m_MaxTeeLag;
+	float m_MaxBoxSpeed;
+	int64_t m_SnapshotBytes;
+	int64_t m_DeltaBytes;
+	int64_t m_CompressedBytes;
+};
+
+static double Milliseconds(int64_t Ticks)
+{
+	return Ticks * 1000.0 / time_freq();
+}
+
+static vec2 TilePos(const CBenchmarkMap &Map, int Index)
+{
+	return vec2((Index % Map.m_Width) * 32 + 16, (Index / Map.m_Width) * 32 + 16);
+}
+
+// the boxes of the server, just without the entity
+static b2Body *CreateBox(CBox2DWorld *pWorld, vec2 Pos, ivec2 Size)
+{
+	CBox2DBodyState Body;
+	Body.m_Type = b2_dynamicBody;
+	Body.m_Pos = Pos;
+	Body.m_Angle = 0.0f;
+	Body.m_Vel = vec2(0, 0);
+	Body.m_AngularVel = 0.0f;
+	Body.m_Size = Size;
+	Body.m_Density = 1.0f;
+	Body.m_Friction = 0.2f;
+	return CreateBox2DBox(pWorld, Body, 0);
+}
+
+// ticks a world with tees and boxes like the server does, with one client
+// that sees everything
+template<class TTee>
+static void Run(CServerRun *pRun, const CBenchmarkMap &Map, int NumTees, int NumBoxes, int NumTicks)
+{
+	pRun->m_NumTees = NumTees;
+	pRun->m_NumBoxes = NumBoxes;
+	pRun->m_MaxParticles = 0;
+	pRun->m_MaxSnapItems = 0;
+	pRun->m_MaxTeeLag = 0.0f;
+	pRun->m_MaxBoxSpeed = 0.0f;
+	pRun->m_SnapshotBytes = 0;
+	pRun->m_DeltaBytes = 0;
+	pRun->m_CompressedBytes = 0;
+
+	float TickTime = 1.f / g_Config.m_B2WorldFps;
+	CBox2DWorld World(b2Vec2(0.f, 9.81f));
+	std::vector<CTileOutline> vOutlines;
+	FindTileOutlines(Map.m_vSolid.data(), Map.m_Width, Map.m_Height, vOutlines);
+	CreateMapBody(&World, vOutlines);
+
+	// spread the tees and boxes over the empty tiles
+	std::vector<vec2> vSpawns;
+	int NumTiles = Map.m_Width * Map.m_Height;
+	for(int i = 0; i < NumTiles; i += 97)
+	{
+		if(!Map.m_vSolid[i])
+			vSpawns.push_back(TilePos(Map, i));
+	}
+	if(vSpawns.empty())
+	{
+		dbg_msg("box2d_server", "the map has no empty tiles");
+		return;
+	}
+
+	std::vector<TTee> vTees(NumTees);
+	std::vector<vec2> vTeeSpawns;
+	for(int i = 0; i < NumTees; i++)
+	{
+		vTeeSpawns.push_back(vSpawns[(i * 7) % vSpawns.size()]);
+		vTees[i].Create(&World, vTeeSpawns[i]);
+	}
+
+	struct CBox
+	{
+		b2Body *m_pBody;
+		int m_SnapSlot;
+		int m_Shape;
+		CNetObj_Box2DBody m_Keyframe;
+	};
+	std::vector<CBox> vBoxes;
+	for(int i = 0; i < NumBoxes; i++)
+	{
+		CBox Box;
+		Box.m_Shape = i % (int)(sizeof(s_aBoxSizes) / sizeof(s_aBoxSizes[0]));
+		// stack them once every spawn is taken
+		int Spawn = i * 7 + 3;
+		vec2 Pos = vSpawns[Spawn % vSpawns.size()] - vec2(0, Spawn / (int)vSpawns.size() * 64);
+		Box.m_pBody = CreateBox(&World, Pos, s_aBoxSizes[Box.m_Shape]);
+		Box.m_SnapSlot = World.AddSnapBody(Box.m_pBody);
+		mem_zero(&Box.m_Keyframe, sizeof(Box.m_Keyframe));
+		Box.m_Keyframe.m_Tick = -1;
+		Box.m_Keyframe.m_Shape = Box.m_Shape;
+		vBoxes.push_back(Box);
+	}
+
+	CNetObjHandler NetObjHandler;
+	std::unique_ptr<CSnapshotDelta> pSnapshotDelta(new CSnapshotDelta());
+	for(int i = 0; i < NUM_NETOBJTYPES; i++)
+		pSnapshotDelta->SetStaticsize(i, NetObjHandler.GetObjSize(i));
+	std::unique_ptr<CSnapshotBuilder> pBuilder(new CSnapshotBuilder());
+	std::vector<char> vSnapshot(CSnapshot::MAX_SIZE);
+	std::vector<char> vPrevSnapshot(CSnapshot::MAX_SIZE);
+	std::vector<char> vDelta(CSnapshot::MAX_SIZE);
+	std::vector<char> vCompressed(CSnapshot::MAX_SIZE);
+	CSnapshot *pSnapshot = (CSnapshot *)vSnapshot.data();
+	CSnapshot *pPrevSnapshot = (CSnapshot *)vPrevSnapshot.data();
+	pPrevSnapshot->Clear();
+
+	float ExplosionStrength = CTuningParams().m_ExplosionStrength;
+
+	std::vector<vec2> vTeeTargets(NumTees);
+	for(int Tick = 0; Tick < NumTicks; Tick++)
+	{
+		// the tees run back and forth and hammer in the direction they run
+		int64_t Start = time_get();
+		for(int i = 0; i < NumTees; i++)
+		{
+			float Phase = Tick * pRun->m_TeeFrequency + i;
+			if((Tick + i * 11) % RESPAWN_INTERVAL == 0)
+			{
+				vTees[i].Destroy();
+				vTees[i].Create(&World, vTeeSpawns[i]);
+			}
+			if((Tick + i * 7) % HAMMER_INTERVAL == 0)
+				vTees[i].Hammer(vec2(cosf(Phase) >= 0 ? 1.0f : -1.0f, 0.0f));
+			vTeeTargets[i] = vTeeSpawns[i] + vec2(sinf(Phase) * pRun->m_TeeRange, 0.0f);
+			vTees[i].Tick(vTeeTargets[i], TickTime, TickTime);
+		}
+		pRun->m_aPhases[PHASE_TEES].Add(time_get() - Start);
+
+		Start = time_get();
+		if(!vBoxes.empty() && Tick % EXPLOSION_INTERVAL == 0)
+		{
+			b2Body *pTarget = vBoxes[(Tick / EXPLOSION_INTERVAL) % vBoxes.size()].m_pBody;
+			World.m_Explosions.Create(pTarget->GetPosition() + b2Vec2(0.0f, 24.0f / B2_SCALE), ExplosionStrength, pRun->m_ExplosionMode);
+		}
+		World.m_Explosions.Tick();
+		pRun->m_aPhases[PHASE_EXPLOSIONS].Add(time_get() - Start);
+		pRun->m_MaxParticles = maximum(pRun->m_MaxParticles, World.m_Explosions.NumActiveParticles());
+
+		Start = time_get();
+		World.StartStep(TickTime, TickTime, 1, 8, 3, 0);
+		pRun->m_aPhases[PHASE_STEP].Add(time_get() - Start);
+
+		// the hammer swing isn't part of the target, it's at most 60 units
+		for(int i = 0; i < NumTees; i++)
+		{
+			b2Vec2 TeePos = vTees[i].Body()->GetPosition();
+			pRun->m_MaxTeeLag = maximum(pRun->m_MaxTeeLag, distance(vec2(TeePos.x, TeePos.y) * B2_SCALE, vTeeTargets[i]));
+		}
+		for(const CBox &Box : vBoxes)
+			pRun->m_MaxBoxSpeed = maximum(pRun->m_MaxBoxSpeed, Box.m_pBody->GetLinearVelocity().Length() * B2_SCALE * TickTime);
+
+		// build the snapshot and the delta against the last one, as the
+		// server does for a client that acked every snapshot
+		Start = time_get();
+		pBuilder->Init();
+		for(int i = 0; i < (int)(sizeof(s_aBoxSizes) / sizeof(s_aBoxSizes[0])); i++)
+		{
+			CNetObj_Box2DShape *pShape = static_cast<CNetObj_Box2DShape *>(pBuilder->NewItem(NETOBJTYPE_BOX2DSHAPE, i, sizeof(CNetObj_Box2DShape)));
+			if(!pShape)
+				break;
+			pShape->m_Width = s_aBoxSizes[i].x;
+			pShape->m_Height = s_aBoxSizes[i].y;
+		}
+		for(unsigned i = 0; i < vBoxes.size(); i++)
+		{
+			CBox &Box = vBoxes[i];
+			UpdateBox2DKeyframe(&Box.m_Keyframe, Box.m_pBody, Tick, TickTime,
+				g_Config.m_B2KeyframeInterval, g_Config.m_B2KeyframeError, length(vec2(s_aBoxSizes[Box.m_Shape].x, s_aBoxSizes[Box.m_Shape].y)) / 2);
+			CNetObj_Box2DBody *pBody = static_cast<CNetObj_Box2DBody *>(pBuilder->NewItem(NETOBJTYPE_BOX2DBODY, i, sizeof(CNetObj_Box2DBody)));
+			if(!pBody)
+				break;
+			*pBody = Box.m_Keyframe;
+		}
+		int SnapshotSize = pBuilder->Finish(pSnapshot);
+		int DeltaSize = pSnapshotDelta->CreateDelta(pPrevSnapshot, pSnapshot, vDelta.data());
+		int CompressedSize = DeltaSize ? CVariableInt::Compress(vDelta.data(), DeltaSize, vCompressed.data(), vCompressed.size()) : 0;
+		pRun->m_aPhases[PHASE_SNAP].Add(time_get() - Start);
+
+		pRun->m_MaxSnapItems = maximum(pRun->m_MaxSnapItems, pSnapshot->NumItems());
+		pRun->m_SnapshotBytes += SnapshotSize;
+		pRun->m_DeltaBytes += DeltaSize;
+		pRun->m_CompressedBytes += CompressedSize;
+		std::swap(pSnapshot, pPrevSnapshot);
+	}
+
+	for(TTee &Tee : vTees)
+		Tee.Destroy();
+}
+
+static void Run(CServerRun *pRun, const CBenchmarkMap &Map, int NumTees, int NumBoxes, int NumTicks)
+{
+	if(pRun->m_JointTees)
+		Run<CJointTee>(pRun, Map, NumTees, NumBoxes, NumTicks);
+	else
+		Run<CBox2DTee>(pRun, Map, NumTees, NumBoxes, NumTicks);
+}
+
+static void AddRunJson(std::string &Json, const CServerRun &Run, int NumTicks)
+{
+	char aBuf[512];
+	str_format(aBuf, sizeof(aBuf), "{\"name\":\"%s\",\"tees\":%d,\"boxes\":%d,\"phases\":{", Run.m_pName, Run.m_NumTees, Run.m_NumBoxes);
+	Json += aBuf;
+	for(int i = 0; i < NUM_PHASES; i++)
+	{
+		const CPhaseTime &Phase = Run.m_aPhases[i];
+		str_format(aBuf, sizeof(aBuf), "%s\"%s\":{\"total_ms\":%.4f,\"avg_ms\":%.4f,\"max_ms\":%.4f}",
+			i ? "," : "", s_apPhaseNames[i], Milliseconds(Phase.m_Total), Milliseconds(Phase.m_Total) / NumTicks, Milliseconds(Phase.m_Max));
+		Json += aBuf;
+	}
+	str_format(aBuf, sizeof(aBuf), "},\"max_particles\":%d,\"max_snap_items\":%d,\"max_tee_lag\":%.2f,\"max_box_speed\":%.2f,\"snapshot_bytes\":%lld,\"delta_bytes\":%lld,\"compressed_bytes\":%lld}",
+		Run.m_MaxParticles, Run.m_MaxSnapItems, Run.m_MaxTeeLag, Run.m_MaxBoxSpeed, (long long)Run.m_SnapshotBytes, (long long)Run.m_DeltaBytes, (long long)Run.m_CompressedBytes);
+	Json += aBuf;
+}
+
+bool BenchmarkBox2DServer(const CBenchmarkMap &Map, const char *pMapName, int NumTees, int NumBoxes, int NumTicks, const char *pJsonFile)
+{
+	CServerRun aRuns[4];
+	aRuns[0].m_pName = "rays";
+	aRuns[0].m_ExplosionMode = CBox2DExplosions::MODE_RAYS;
+	aRuns[0].m_JointTees = false;
+	aRuns[0].m_TeeRange = 96.0f;
+	aRuns[0].m_TeeFrequency = 0.05f;
+	aRuns[1].m_pName = "particles";
+	aRuns[1].m_ExplosionMode = CBox2DExplosions::MODE_PARTICLES;
+	aRuns[1].m_JointTees = false;
+	aRuns[1].m_TeeRange = 96.0f;
+	aRuns[1].m_TeeFrequency = 0.05f;
+	// tees on speedups, faster than box2d moves a body in one step
+	aRuns[2].m_pName = "speedup";
+	aRuns[2].m_ExplosionMode = CBox2DExplosions::MODE_RAYS;
+	aRuns[2].m_JointTees = false;
+	aRuns[2].m_TeeRange = 480.0f;
+	aRuns[2].m_TeeFrequency = 0.3f;
+	// the same as "rays" with the old mouse joint tees, the tees and step
+	// phases of the two compare the tee bodies
+	aRuns[3].m_pName = "joint";
+	aRuns[3].m_ExplosionMode = CBox2DExplosions::MODE_RAYS;
+	aRuns[3].m_JointTees = true;
+	aRuns[3].m_TeeRange = 96.0f;
+	aRuns[3].m_TeeFrequency = 0.05f;
+
+	char aMapName[128];
+	char aBuf[256];
+	std::string Json;
+	str_format(aBuf, sizeof(aBuf), "{\"map\":\"%s\",\"width\":%d,\"height\":%d,\"ticks\":%d,\"runs\":[",
+		EscapeJson(aMapName, sizeof(aMapName), pMapName), Map.m_Width, Map.m_Height, NumTicks);
+	Json += aBuf;
+	for(unsigned i = 0; i < sizeof(aRuns) / sizeof(aRuns[0]); i++)
+	{
+		Run(&aRuns[i], Map, NumTees, NumBoxes, NumTicks);
+		if(i)
+			Json += ",";
+		AddRunJson(Json, aRuns[i], NumTicks);
+
+		dbg_msg("box2d_server", "%s: tees=%.4fms explosions=%.4fms step=%.4fms snap=%.4fms per tick, %lld snapshot bytes, tee lag %.2f, box speed %.2f",
+			aRuns[i].m_pName,
+			Milliseconds(aRuns[i].m_aPhases[PHASE_TEES].m_Total) / NumTicks,
+			Milliseconds(aRuns[i].m_aPhases[PHASE_EXPLOSIONS].m_Total) / NumTicks,
+			Milliseconds(aRuns[i].m_aPhases[PHASE_STEP].m_Total) / NumTicks,
+			Milliseconds(aRuns[i].m_aPhases[PHASE_SNAP].m_Total) / NumTicks,
+			(long long)aRuns[i].m_SnapshotBytes, aRuns[i].m_MaxTeeLag, aRuns[i].m_MaxBoxSpeed);
+	}
+	Json += "]}\n";
+
+	IOHANDLE File = io_open(pJsonFile, IOFLAG_WRITE);
+	if(!File)
+	{
+		dbg_msg("box2d_server", "failed to open '%s' for writing", pJsonFile);
+		return false;
+	}
+	io_write(File, Json.c_str(), Json.size());
+	io_close(File);
+	dbg_msg("box2d_server", "wrote results to '%s'", pJsonFile);
+	return true;
+}
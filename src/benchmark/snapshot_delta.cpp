@@ -0,0 +1,396 @@
+#include "benchmark.h"
+
+#include <base/system.h>
+#include <engine/shared/compression.h>
+#include <engine/shared/demo.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/snapshot.h>
+#include <engine/storage.h>
+#include <game/generated/protocol.h>
+
+#include <vector>
+
+static const int NUM_ROUNDS = 20;
+// the snapshots are diffed against the one a few ticks before, like the
+// server does against the last acked one
+static const int ACK_DELAY = 3;
+
+static double Milliseconds(int64_t Ticks)
+{
+	return Ticks * 1000.0 / time_freq();
+}
+
+// CSnapshotDelta before the vectorized kernels and the key tables, diffing
+// one int at a time and looking keys up in fixed buckets or item by item
+class CReferenceSnapshotDelta
+{
+	enum
+	{
+		MAX_NETOBJSIZES = 64,
+		HASHLIST_SIZE = 256,
+	};
+
+	struct CItemList
+	{
+		int m_Num;
+		int m_aKeys[64];
+		int m_aIndex[64];
+	};
+
+	short m_aItemSizes[MAX_NETOBJSIZES];
+	int m_aSnapshotDataRate[0xffff];
+	int m_SnapshotCurrent;
+
+	static void GenerateHash(CItemList *pHashlist, CSnapshot *pSnapshot)
+	{
+		for(int i = 0; i < HASHLIST_SIZE; i++)
+			pHashlist[i].m_Num = 0;
+		for(int i = 0; i < pSnapshot->NumItems(); i++)
+		{
+			int Key = pSnapshot->GetItem(i)->Key();
+			int HashID = ((Key >> 12) & 0xf0) | (Key & 0xf);
+			if(pHashlist[HashID].m_Num != 64)
+			{
+				pHashlist[HashID].m_aIndex[pHashlist[HashID].m_Num] = i;
+				pHashlist[HashID].m_aKeys[pHashlist[HashID].m_Num] = Key;
+				pHashlist[HashID].m_Num++;
+			}
+		}
+	}
+
+	static int GetItemIndexHashed(int Key, const CItemList *pHashlist)
+	{
+		int HashID = ((Key >> 12) & 0xf0) | (Key & 0xf);
+		for(int i = 0; i < pHashlist[HashID].m_Num; i++)
+		{
+			if(pHashlist[HashID].m_aKeys[i] == Key)
+				return pHashlist[HashID].m_aIndex[i];
+		}
+		return -1;
+	}
+
+	static int DiffItem(int *pPast, int *pCurrent, int *pOut, int Size)
+	{
+		int Needed = 0;
+		for(; Size; Size--)
+		{
+			*pOut = *pCurrent - *pPast;
+			Needed |= *pOut;
+			pOut++;
+			pPast++;
+			pCurrent++;
+		}
+		return Needed;
+	}
+
+	void UndiffItem(int *pPast, int *pDiff, int *pOut, int Size)
+	{
+		for(; Size; Size--)
+		{
+			*pOut = *pPast + *pDiff;
+			if(*pDiff == 0)
+				m_aSnapshotDataRate[m_SnapshotCurrent] += 1;
+			else
+			{
+				unsigned char aBuf[16];
+				unsigned char *pEnd = CVariableInt::Pack(aBuf, *pDiff);
+				m_aSnapshotDataRate[m_SnapshotCurrent] += (int)(pEnd - (unsigned char *)aBuf) * 8;
+			}
+			pOut++;
+			pPast++;
+			pDiff++;
+		}
+	}
+
+public:
+	CReferenceSnapshotDelta()
+	{
+		mem_zero(m_aItemSizes, sizeof(m_aItemSizes));
+		mem_zero(m_aSnapshotDataRate, sizeof(m_aSnapshotDataRate));
+		m_SnapshotCurrent = 0;
+	}
+
+	void SetStaticsize(int ItemType, int Size)
+	{
+		if(ItemType >= 0 && ItemType < MAX_NETOBJSIZES)
+			m_aItemSizes[ItemType] = Size;
+	}
+
+	int CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData)
+	{
+		CSnapshotDelta::CData *pDelta = (CSnapshotDelta::CData *)pDstData;
+		int *pData = (int *)pDelta->m_aData;
+		pDelta->m_NumDeletedItems = 0;
+		pDelta->m_NumUpdateItems = 0;
+		pDelta->m_NumTempItems = 0;
+
+		CItemList aHashlist[HASHLIST_SIZE];
+		GenerateHash(aHashlist, pTo);
+		for(int i = 0; i < pFrom->NumItems(); i++)
+		{
+			CSnapshotItem *pFromItem = pFrom->GetItem(i);
+			if(GetItemIndexHashed(pFromItem->Key(), aHashlist) == -1)
+			{
+				pDelta->m_NumDeletedItems++;
+				*pData++ = pFromItem->Key();
+			}
+		}
+
+		GenerateHash(aHashlist, pFrom);
+		int aPastIndices[1024];
+		for(int i = 0; i < pTo->NumItems(); i++)
+			aPastIndices[i] = GetItemIndexHashed(pTo->GetItem(i)->Key(), aHashlist);
+
+		for(int i = 0; i < pTo->NumItems(); i++)
+		{
+			int ItemSize = pTo->GetItemSize(i);
+			CSnapshotItem *pCurItem = pTo->GetItem(i);
+			bool IncludeSize = pCurItem->Type() >= MAX_NETOBJSIZES || !m_aItemSizes[pCurItem->Type()];
+			if(aPastIndices[i] != -1)
+			{
+				int *pItemDataDst = pData + (IncludeSize ? 3 : 2);
+				if(DiffItem(pFrom->GetItem(aPastIndices[i])->Data(), pCurItem->Data(), pItemDataDst, ItemSize / 4))
+				{
+					*pData++ = pCurItem->Type();
+					*pData++ = pCurItem->ID();
+					if(IncludeSize)
+						*pData++ = ItemSize / 4;
+					pData += ItemSize / 4;
+					pDelta->m_NumUpdateItems++;
+				}
+			}
+			else
+			{
+				*pData++ = pCurItem->Type();
+				*pData++ = pCurItem->ID();
+				if(IncludeSize)
+					*pData++ = ItemSize / 4;
+				mem_copy(pData, pCurItem->Data(), ItemSize);
+				pData += ItemSize / 4;
+				pDelta->m_NumUpdateItems++;
+			}
+		}
+
+		if(!pDelta->m_NumDeletedItems && !pDelta->m_NumUpdateItems && !pDelta->m_NumTempItems)
+			return 0;
+		return (int)((char *)pData - (char *)pDstData);
+	}
+
+	// without the range checks, the deltas are our own
+	int UnpackDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData)
+	{
+		static CSnapshotBuilder s_Builder;
+		CSnapshotDelta::CData *pDelta = (CSnapshotDelta::CData *)pSrcData;
+		int *pData = (int *)pDelta->m_aData;
+		s_Builder.Init();
+
+		int *pDeleted = pData;
+		pData += pDelta->m_NumDeletedItems;
+		for(int i = 0; i < pFrom->NumItems(); i++)
+		{
+			CSnapshotItem *pFromItem = pFrom->GetItem(i);
+			bool Keep = true;
+			for(int d = 0; d < pDelta->m_NumDeletedItems && Keep; d++)
+				Keep = pDeleted[d] != pFromItem->Key();
+			if(Keep)
+				mem_copy(s_Builder.NewItem(pFromItem->Type(), pFromItem->ID(), pFrom->GetItemSize(i)), pFromItem->Data(), pFrom->GetItemSize(i));
+		}
+
+		for(int i = 0; i < pDelta->m_NumUpdateItems; i++)
+		{
+			int Type = *pData++;
+			int ID = *pData++;
+			int ItemSize = Type < MAX_NETOBJSIZES && m_aItemSizes[Type] ? m_aItemSizes[Type] : (*pData++) * 4;
+			m_SnapshotCurrent = Type;
+			int Key = (Type << 16) | ID;
+			int *pNewData = s_Builder.GetItemData(Key);
+			if(!pNewData)
+				pNewData = (int *)s_Builder.NewItem(Type, ID, ItemSize);
+			int FromIndex = pFrom->GetItemIndex(Key);
+			if(FromIndex != -1)
+				UndiffItem(pFrom->GetItem(FromIndex)->Data(), pData, pNewData, ItemSize / 4);
+			else
+				mem_copy(pNewData, pData, ItemSize);
+			pData += ItemSize / 4;
+		}
+		return s_Builder.Finish(pTo);
+	}
+};
+
+class CDemoSnapshots : public CDemoPlayer::IListener
+{
+public:
+	std::vector<std::vector<char>> m_vSnapshots;
+
+	void OnDemoPlayerSnapshot(void *pData, int Size) override
+	{
+		m_vSnapshots.emplace_back((char *)pData, (char *)pData + Size);
+	}
+	void OnDemoPlayerMessage(void *pData, int Size) override {}
+};
+
+static bool LoadDemoSnapshots(const char *pDemoName, CSnapshotDelta *pDelta, std::vector<std::vector<char>> &vSnapshots)
+{
+	IStorage *pStorage = CreateLocalStorage();
+	CDemoPlayer DemoPlayer(pDelta);
+	CDemoSnapshots Listener;
+	DemoPlayer.SetListener(&Listener);
+	bool Result = DemoPlayer.Load(pStorage, 0, pDemoName, IStorage::TYPE_ALL) != -1;
+	if(Result)
+	{
+		DemoPlayer.Play();
+		while(DemoPlayer.IsPlaying())
+			DemoPlayer.Update(false);
+		DemoPlayer.Stop();
+		vSnapshots.swap(Listener.m_vSnapshots);
+	}
+	delete pStorage;
+	return Result;
+}
+
+// what a client sees on a full server: all the player infos, the tees in
+// view, of which some stand still, the pickups of the area and projectiles
+// coming and going
+static void GenerateSnapshots(std::vector<std::vector<char>> &vSnapshots)
+{
+	CSnapshotBuilder Builder;
+	std::vector<char> vData(CSnapshot::MAX_SIZE);
+	for(int Tick = 0; Tick < 500; Tick++)
+	{
+		Builder.Init();
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			CNetObj_PlayerInfo *pInfo = (CNetObj_PlayerInfo *)Builder.NewItem(NETOBJTYPE_PLAYERINFO, i, sizeof(CNetObj_PlayerInfo));
+			pInfo->m_Local = i == 0;
+			pInfo->m_ClientID = i;
+			pInfo->m_Team = 0;
+			pInfo->m_Score = i * 10 + Tick / 200;
+			pInfo->m_Latency = 30 + (i * 7 + Tick / 50) % 20;
+		}
+		for(int i = 0; i < 24; i++)
+		{
+			bool Moving = i % 3 != 0;
+			int T = Moving ? Tick : 0;
+			CNetObj_Character *pChar = (CNetObj_Character *)Builder.NewItem(NETOBJTYPE_CHARACTER, i, sizeof(CNetObj_Character));
+			mem_zero(pChar, sizeof(*pChar));
+			pChar->m_Tick = T;
+			pChar->m_X = 1000 + i * 64 + (T * (i + 3)) % 400;
+			pChar->m_Y = 800 + (T * 5) % 100;
+			pChar->m_VelX = (i - 12) * 64;
+			pChar->m_VelY = Moving ? (T % 20) * 32 : 0;
+			pChar->m_Angle = (T * 13 + i) % 628;
+			pChar->m_Direction = Moving ? (i % 2) * 2 - 1 : 0;
+			pChar->m_HookState = Moving && T % 40 < 10;
+			pChar->m_HookX = pChar->m_X + 100;
+			pChar->m_HookY = pChar->m_Y - 100;
+			pChar->m_Health = 10;
+			pChar->m_Armor = 0;
+			pChar->m_Weapon = (i + T / 100) % 4;
+			pChar->m_Emote = 0;
+			pChar->m_AttackTick = T - T % 25;
+		}
+		for(int i = 0; i < 40; i++)
+		{
+			CNetObj_Pickup *pPickup = (CNetObj_Pickup *)Builder.NewItem(NETOBJTYPE_PICKUP, 100 + i, sizeof(CNetObj_Pickup));
+			pPickup->m_X = 500 + i * 96;
+			pPickup->m_Y = 1200;
+			pPickup->m_Type = i % 3;
+			pPickup->m_Subtype = 0;
+		}
+		for(int i = 0; i < 20; i++)
+		{
+			// a projectile lives for 40 ticks, a new id then
+			int Age = (Tick + i * 2) % 40;
+			int ID = 200 + ((Tick + i * 2) / 40 * 20 + i) % 1000;
+			CNetObj_Projectile *pProj = (CNetObj_Projectile *)Builder.NewItem(NETOBJTYPE_PROJECTILE, ID, sizeof(CNetObj_Projectile));
+			pProj->m_X = 1000 + i * 32;
+			pProj->m_Y = 900;
+			pProj->m_VelX = 1500;
+			pProj->m_VelY = -200;
+			pProj->m_Type = 1;
+			pProj->m_StartTick = Tick - Age;
+		}
+		int Size = Builder.Finish(vData.data());
+		vSnapshots.emplace_back(vData.begin(), vData.begin() + Size);
+	}
+}
+
+void BenchmarkSnapshotDelta(const char *pDemoName)
+{
+	CNetObjHandler NetObjHandler;
+	static CSnapshotDelta s_Delta;
+	static CReferenceSnapshotDelta s_Reference;
+	for(int i = 0; i < NUM_NETOBJTYPES; i++)
+	{
+		s_Delta.SetStaticsize(i, NetObjHandler.GetObjSize(i));
+		s_Reference.SetStaticsize(i, NetObjHandler.GetObjSize(i));
+	}
+
+	std::vector<std::vector<char>> vSnapshots;
+	if(pDemoName)
+	{
+		if(!LoadDemoSnapshots(pDemoName, &s_Delta, vSnapshots))
+		{
+			dbg_msg("snapshot_delta", "failed to load demo '%s'", pDemoName);
+			return;
+		}
+	}
+	else
+	{
+		GenerateSnapshots(vSnapshots);
+	}
+	int NumDeltas = (int)vSnapshots.size() - ACK_DELAY;
+	if(NumDeltas <= 0)
+	{
+		dbg_msg("snapshot_delta", "not enough snapshots");
+		return;
+	}
+
+	std::vector<char> vDelta(CSnapshot::MAX_SIZE);
+	std::vector<char> vReferenceDelta(CSnapshot::MAX_SIZE);
+	std::vector<char> vUnpacked(CSnapshot::MAX_SIZE);
+	std::vector<char> vReferenceUnpacked(CSnapshot::MAX_SIZE);
+	int64_t aCreateTime[2] = {0, 0};
+	int64_t aUnpackTime[2] = {0, 0};
+	int Mismatches = 0;
+	int64_t DeltaBytes = 0;
+	for(int Round = 0; Round < NUM_ROUNDS; Round++)
+	{
+		for(int i = 0; i < NumDeltas; i++)
+		{
+			CSnapshot *pFrom = (CSnapshot *)vSnapshots[i].data();
+			CSnapshot *pTo = (CSnapshot *)vSnapshots[i + ACK_DELAY].data();
+
+			int64_t Start = time_get();
+			int ReferenceSize = s_Reference.CreateDelta(pFrom, pTo, vReferenceDelta.data());
+			aCreateTime[0] += time_get() - Start;
+			Start = time_get();
+			int Size = s_Delta.CreateDelta(pFrom, pTo, vDelta.data());
+			aCreateTime[1] += time_get() - Start;
+			DeltaBytes += Size;
+			if(Size != ReferenceSize || mem_comp(vDelta.data(), vReferenceDelta.data(), Size) != 0)
+			{
+				Mismatches++;
+				continue;
+			}
+			if(!Size)
+				continue;
+
+			Start = time_get();
+			int ReferenceUnpackedSize = s_Reference.UnpackDelta(pFrom, (CSnapshot *)vReferenceUnpacked.data(), vReferenceDelta.data());
+			aUnpackTime[0] += time_get() - Start;
+			Start = time_get();
+			int UnpackedSize = s_Delta.UnpackDelta(pFrom, (CSnapshot *)vUnpacked.data(), vDelta.data(), Size);
+			aUnpackTime[1] += time_get() - Start;
+			if(UnpackedSize != ReferenceUnpackedSize || mem_comp(vUnpacked.data(), vReferenceUnpacked.data(), UnpackedSize) != 0)
+				Mismatches++;
+		}
+	}
+
+	int NumOps = NumDeltas * NUM_ROUNDS;
+	dbg_msg("snapshot_delta", "%s: %d snapshots, %d bytes per delta", pDemoName ? pDemoName : "generated", (int)vSnapshots.size(), (int)(DeltaBytes / NumOps));
+	dbg_msg("snapshot_delta", "create: reference=%.2fus current=%.2fus per delta", Milliseconds(aCreateTime[0]) * 1000 / NumOps, Milliseconds(aCreateTime[1]) * 1000 / NumOps);
+	dbg_msg("snapshot_delta", "unpack: reference=%.2fus current=%.2fus per delta", Milliseconds(aUnpackTime[0]) * 1000 / NumOps, Milliseconds(aUnpackTime[1]) * 1000 / NumOps);
+	if(Mismatches)
+		dbg_msg("snapshot_delta", "%d deltas differ from the reference", Mismatches);
+}
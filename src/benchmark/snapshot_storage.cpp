@@ -0,0 +1,132 @@
+#include "benchmark.h"
+
+#include <base/system.h>
+#include <engine/shared/snapshot.h>
+
+#include <vector>
+
+static const int NUM_CLIENTS = 64;
+static const int NUM_TICKS = 3000;
+static const int KEPT_TICKS = 150;
+
+static double Milliseconds(int64_t Ticks)
+{
+	return Ticks * 1000.0 / time_freq();
+}
+
+// the snapshot storage before the ring, a malloc() for every snapshot
+class CListSnapshotStorage
+{
+	class CHolder
+	{
+	public:
+		CHolder *m_pNext;
+		int m_Tick;
+		int m_SnapSize;
+		CSnapshot *m_pSnap;
+	};
+
+	CHolder *m_pFirst = 0;
+	CHolder *m_pLast = 0;
+
+public:
+	~CListSnapshotStorage() { PurgeUntil(0x7fffffff); }
+
+	void PurgeUntil(int Tick)
+	{
+		while(m_pFirst && m_pFirst->m_Tick < Tick)
+		{
+			CHolder *pNext = m_pFirst->m_pNext;
+			free(m_pFirst);
+			m_pFirst = pNext;
+		}
+		if(!m_pFirst)
+			m_pLast = 0;
+	}
+
+	void Add(int Tick, int DataSize, const void *pData)
+	{
+		CHolder *pHolder = (CHolder *)malloc(sizeof(CHolder) + DataSize);
+		pHolder->m_Tick = Tick;
+		pHolder->m_SnapSize = DataSize;
+		pHolder->m_pSnap = (CSnapshot *)(pHolder + 1);
+		mem_copy(pHolder->m_pSnap, pData, DataSize);
+		pHolder->m_pNext = 0;
+		if(m_pLast)
+			m_pLast->m_pNext = pHolder;
+		else
+			m_pFirst = pHolder;
+		m_pLast = pHolder;
+	}
+
+	int Get(int Tick, CSnapshot **ppData)
+	{
+		for(CHolder *pHolder = m_pFirst; pHolder; pHolder = pHolder->m_pNext)
+		{
+			if(pHolder->m_Tick == Tick)
+			{
+				*ppData = pHolder->m_pSnap;
+				return pHolder->m_SnapSize;
+			}
+		}
+		return -1;
+	}
+};
+
+// the snapshot sizes of a client, changing like the players in view do
+static int SnapSize(int Client, int Tick)
+{
+	return 2000 + ((Client * 131 + Tick / 25) * 7919) % 6000;
+}
+
+static void AddSnap(CListSnapshotStorage *pStorage, int Tick, int Size, const char *pData)
+{
+	pStorage->Add(Tick, Size, pData);
+}
+
+static int GetSnap(CListSnapshotStorage *pStorage, int Tick)
+{
+	CSnapshot *pSnap;
+	return pStorage->Get(Tick, &pSnap);
+}
+
+static void AddSnap(CSnapshotStorage *pStorage, int Tick, int Size, const char *pData)
+{
+	pStorage->Add(Tick, 0, Size, (void *)pData, 0);
+}
+
+static int GetSnap(CSnapshotStorage *pStorage, int Tick)
+{
+	CSnapshot *pSnap;
+	return pStorage->Get(Tick, 0, &pSnap, 0);
+}
+
+// purges, adds and looks up the acked snapshot of every client on every
+// tick like CServer::DoSnapshot(), the acked one is a few ticks old
+template<typename TStorage>
+static void Run(const char *pName, const std::vector<char> &vData)
+{
+	std::vector<TStorage> vStorages(NUM_CLIENTS);
+	int Found = 0;
+	int64_t Start = time_get();
+	for(int Tick = 0; Tick < NUM_TICKS; Tick++)
+	{
+		for(int c = 0; c < NUM_CLIENTS; c++)
+		{
+			vStorages[c].PurgeUntil(Tick - KEPT_TICKS);
+			AddSnap(&vStorages[c], Tick, SnapSize(c, Tick), vData.data());
+			Found += GetSnap(&vStorages[c], Tick - 3 - c % 5) >= 0;
+		}
+	}
+	int64_t Time = time_get() - Start;
+
+	dbg_msg("snapshot_storage", "%s: %.2fms (%.1fns per client and tick, %d acked found)",
+		pName, Milliseconds(Time), Milliseconds(Time) * 1e6 / (NUM_CLIENTS * NUM_TICKS), Found);
+}
+
+void BenchmarkSnapshotStorage()
+{
+	std::vector<char> vData(CSnapshot::MAX_SIZE, 1);
+	Run<CListSnapshotStorage>("list", vData);
+	Run<CSnapshotStorage>("ring", vData);
+}
@@ -262,9 +262,16 @@ public:
 
 	virtual void OnTick() = 0;
 	virtual void OnPreSnap() = 0;
+	// Called for the clients from several threads at once (see
+	// sv_snapshot_threads), it may only read the game and add snap items.
+	// ClientID -1 for the server demo is snapped on its own.
 	virtual void OnSnap(int ClientID) = 0;
 	virtual void OnPostSnap() = 0;
 
+	// Called once the ticks and the snapshots of a server frame are done,
+	// before network input is processed again.
+	virtual void OnTickFinished() = 0;
+
 	virtual void OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID) = 0;
 
 	// Called before map reload, for any data that the game wants to
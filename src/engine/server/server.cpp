@@ -276,6 +276,7 @@ void CServer::CClient::Reset()
 	m_LastAckedSnapshot = -1;
 	m_LastInputTick = -1;
 	m_SnapRate = CClient::SNAPRATE_INIT;
+	m_SnapBuilt = false;
 	m_Score = 0;
 	m_NextMapChunk = 0;
 	m_Flags = 0;
@@ -290,6 +291,9 @@ CServer::CServer() :
 	for(int i = 0; i < MAX_CLIENTS; i++)
 		m_aDemoRecorder[i] = CDemoRecorder(&m_SnapshotDelta, true);
 	m_aDemoRecorder[MAX_CLIENTS] = CDemoRecorder(&m_SnapshotDelta, false);
+	sphore_init(&m_SnapshotsDone);
+	m_SnapshotTagtime = 0;
+	m_EmptySnapshot.Clear();
 
 	m_TickSpeed = SERVER_TICK_SPEED;
 
@@ -336,6 +340,7 @@ CServer::~CServer()
 	}
 
 	delete m_pConnectionPool;
+	sphore_destroy(&m_SnapshotsDone);
 }
 
 bool CServer::IsClientNameAvailable(int ClientID, const char *pNameRequest)
@@ -834,28 +839,46 @@ void CServer::SendMsgRaw(int ClientID, const void *pData, int Size, int Flags)
 	m_NetServer.Send(&Packet);
 }
 
-void CServer::DoSnapshot()
+// the builder that SnapNewItem() adds to, each snapshot worker has its own
+static thread_local CSnapshotBuilder *s_pSnapshotBuilder = 0;
+
+class CSnapshotJob : public IJob
 {
-	GameServer()->OnPreSnap();
+	CServer *m_pServer;
+	void (CServer::*m_pfnWork)(int Worker);
+	int m_Worker;
 
-	// create snapshot for demo recording
-	if(m_aDemoRecorder[MAX_CLIENTS].IsRecording())
+	void Run() override
 	{
-		char aData[CSnapshot::MAX_SIZE];
-		int SnapshotSize;
+		(m_pServer->*m_pfnWork)(m_Worker);
+		sphore_signal(&m_pServer->m_SnapshotsDone);
+	}
 
-		// build snap and possibly add some messages
-		m_SnapshotBuilder.Init();
-		GameServer()->OnSnap(-1);
-		SnapshotSize = m_SnapshotBuilder.Finish(aData);
+public:
+	CSnapshotJob(CServer *pServer, void (CServer::*pfnWork)(int Worker), int Worker) :
+		m_pServer(pServer), m_pfnWork(pfnWork), m_Worker(Worker) {}
+};
 
-		// write snapshot
-		m_aDemoRecorder[MAX_CLIENTS].RecordSnapshot(Tick(), aData, SnapshotSize);
-	}
+void CServer::RunSnapshotWorkers(void (CServer::*pfnWork)(int Worker))
+{
+	// the main thread helps out
+	int NumWorkers = m_vpSnapshotWorkers.size();
+	for(int i = 1; i < NumWorkers; i++)
+		m_SnapshotJobs.Add(std::make_shared<CSnapshotJob>(this, pfnWork, i));
+	(this->*pfnWork)(0);
+	for(int i = 1; i < NumWorkers; i++)
+		sphore_wait(&m_SnapshotsDone);
+}
 
-	// create snapshots for all clients
-	for(int i = 0; i < MAX_CLIENTS; i++)
+void CServer::BuildSnapshots(int Worker)
+{
+	CSnapshotWorker *pWorker = m_vpSnapshotWorkers[Worker].get();
+	s_pSnapshotBuilder = &pWorker->m_Builder;
+
+	for(int i = Worker; i < MAX_CLIENTS; i += m_vpSnapshotWorkers.size())
 	{
+		m_aClients[i].m_SnapBuilt = false;
+
 		// client must be ingame to receive snapshots
 		if(m_aClients[i].m_State != CClient::STATE_INGAME)
 			continue;
@@ -868,108 +891,175 @@ void CServer::DoSnapshot()
 		if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_INIT && (Tick() % 10) != 0)
 			continue;
 
-		{
-			char aData[CSnapshot::MAX_SIZE];
-			CSnapshot *pData = (CSnapshot *)aData; // Fix compiler warning for strict-aliasing
-			char aDeltaData[CSnapshot::MAX_SIZE];
-			char aCompData[CSnapshot::MAX_SIZE];
-			int SnapshotSize;
-			int Crc;
-			static CSnapshot s_EmptySnap;
-			CSnapshot *pDeltashot = &s_EmptySnap;
-			int DeltashotSize;
-			int DeltaTick = -1;
-			int DeltaSize;
+		CSnapshot *pData = (CSnapshot *)pWorker->m_aData; // Fix compiler warning for strict-aliasing
+		CSnapshot *pDeltashot = &m_EmptySnapshot;
+		int DeltashotSize = sizeof(CSnapshot);
+		int DeltaTick = -1;
 
-			m_SnapshotBuilder.Init(m_aClients[i].m_Sixup);
+		pWorker->m_Builder.Init(m_aClients[i].m_Sixup);
 
-			GameServer()->OnSnap(i);
+		GameServer()->OnSnap(i);
 
-			// finish snapshot
-			SnapshotSize = m_SnapshotBuilder.Finish(pData);
+		// finish snapshot
+		int SnapshotSize = pWorker->m_Builder.Finish(pData);
+		m_aClients[i].m_SnapCrc = pData->Crc();
 
-			if(m_aDemoRecorder[i].IsRecording())
+		// remove old snapshos
+		// keep 3 seconds worth of snapshots
+		m_aClients[i].m_Snapshots.PurgeUntil(m_CurrentGameTick - SERVER_TICK_SPEED * 3);
+
+		// save it the snapshot
+		m_aClients[i].m_Snapshots.Add(m_CurrentGameTick, m_SnapshotTagtime, SnapshotSize, pData, 0);
+		m_aClients[i].m_pSnap = m_aClients[i].m_Snapshots.m_pLast->m_pSnap;
+		m_aClients[i].m_SnapSize = SnapshotSize;
+
+		// find snapshot that we can perform delta against
+		{
+			CSnapshot *pAckedSnap;
+			int AckedSize = m_aClients[i].m_Snapshots.Get(m_aClients[i].m_LastAckedSnapshot, 0, &pAckedSnap, 0);
+			if(AckedSize >= 0)
 			{
-				// write snapshot
-				m_aDemoRecorder[i].RecordSnapshot(Tick(), aData, SnapshotSize);
+				pDeltashot = pAckedSnap;
+				DeltashotSize = AckedSize;
+				DeltaTick = m_aClients[i].m_LastAckedSnapshot;
 			}
+			else
+			{
+				// no acked package found, force client to recover rate
+				if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_FULL)
+					m_aClients[i].m_SnapRate = CClient::SNAPRATE_RECOVER;
+			}
+		}
+		m_aClients[i].m_SnapDeltaTick = DeltaTick;
+		m_aClients[i].m_pSnapDeltaBase = pDeltashot;
+		m_aClients[i].m_SnapDeltaBaseSize = DeltashotSize;
+		m_aClients[i].m_SnapDeltaBaseCrc = pDeltashot->Crc();
+		m_aClients[i].m_SnapBuilt = true;
+	}
 
-			Crc = pData->Crc();
+	s_pSnapshotBuilder = 0;
+}
 
-			// remove old snapshos
-			// keep 3 seconds worth of snapshots
-			m_aClients[i].m_Snapshots.PurgeUntil(m_CurrentGameTick - SERVER_TICK_SPEED * 3);
+void CServer::FindSharedSnapshotDeltas()
+{
+	// the delta only depends on the two snapshots and the static item
+	// sizes, so clients with equal ones get the same delta
+	m_SnapDeltaCache.Clear();
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		CClient &Client = m_aClients[i];
+		if(Client.m_SnapBuilt)
+			Client.m_SnapDeltaSource = m_SnapDeltaCache.Find(i, Client.m_Sixup, Client.m_pSnapDeltaBase, Client.m_SnapDeltaBaseSize, Client.m_SnapDeltaBaseCrc, Client.m_pSnap, Client.m_SnapSize, Client.m_SnapCrc);
+	}
+}
 
-			// save it the snapshot
-			m_aClients[i].m_Snapshots.Add(m_CurrentGameTick, time_get(), SnapshotSize, pData, 0);
+void CServer::CreateSnapshotDeltas(int Worker)
+{
+	CSnapshotWorker *pWorker = m_vpSnapshotWorkers[Worker].get();
 
-			// find snapshot that we can perform delta against
-			s_EmptySnap.Clear();
+	for(int i = Worker; i < MAX_CLIENTS; i += m_vpSnapshotWorkers.size())
+	{
+		if(!m_aClients[i].m_SnapBuilt || m_aClients[i].m_SnapDeltaSource != i)
+			continue;
 
-			{
-				DeltashotSize = m_aClients[i].m_Snapshots.Get(m_aClients[i].m_LastAckedSnapshot, 0, &pDeltashot, 0);
-				if(DeltashotSize >= 0)
-					DeltaTick = m_aClients[i].m_LastAckedSnapshot;
-				else
-				{
-					// no acked package found, force client to recover rate
-					if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_FULL)
-						m_aClients[i].m_SnapRate = CClient::SNAPRATE_RECOVER;
-				}
-			}
+		// create delta
+		pWorker->m_Delta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, m_aClients[i].m_Sixup);
+		pWorker->m_Delta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, m_aClients[i].m_Sixup);
+		int DeltaSize = pWorker->m_Delta.CreateDelta(m_aClients[i].m_pSnapDeltaBase, m_aClients[i].m_pSnap, pWorker->m_aDeltaData);
 
-			// create delta
-			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, m_aClients[i].m_Sixup);
-			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, m_aClients[i].m_Sixup);
-			DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
+		// compress it
+		int CompSize = 0;
+		if(DeltaSize)
+			CompSize = CVariableInt::Compress(pWorker->m_aDeltaData, DeltaSize, pWorker->m_aCompData, sizeof(pWorker->m_aCompData));
+		m_aClients[i].m_vSnapCompData.assign(pWorker->m_aCompData, pWorker->m_aCompData + CompSize);
+	}
+}
 
-			if(DeltaSize)
-			{
-				// compress it
-				int SnapshotSize;
-				const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
-				int NumPackets;
+void CServer::DoSnapshot()
+{
+	GameServer()->OnPreSnap();
 
-				SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
-				NumPackets = (SnapshotSize + MaxSize - 1) / MaxSize;
+	// create snapshot for demo recording
+	if(m_aDemoRecorder[MAX_CLIENTS].IsRecording())
+	{
+		char aData[CSnapshot::MAX_SIZE];
+		int SnapshotSize;
 
-				for(int n = 0, Left = SnapshotSize; Left > 0; n++)
-				{
-					int Chunk = Left < MaxSize ? Left : MaxSize;
-					Left -= Chunk;
+		// build snap and possibly add some messages
+		m_SnapshotBuilder.Init();
+		GameServer()->OnSnap(-1);
+		SnapshotSize = m_SnapshotBuilder.Finish(aData);
 
-					if(NumPackets == 1)
-					{
-						CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
-						Msg.AddInt(m_CurrentGameTick);
-						Msg.AddInt(m_CurrentGameTick - DeltaTick);
-						Msg.AddInt(Crc);
-						Msg.AddInt(Chunk);
-						Msg.AddRaw(&aCompData[n * MaxSize], Chunk);
-						SendMsg(&Msg, MSGFLAG_FLUSH, i);
-					}
-					else
-					{
-						CMsgPacker Msg(NETMSG_SNAP, true);
-						Msg.AddInt(m_CurrentGameTick);
-						Msg.AddInt(m_CurrentGameTick - DeltaTick);
-						Msg.AddInt(NumPackets);
-						Msg.AddInt(n);
-						Msg.AddInt(Crc);
-						Msg.AddInt(Chunk);
-						Msg.AddRaw(&aCompData[n * MaxSize], Chunk);
-						SendMsg(&Msg, MSGFLAG_FLUSH, i);
-					}
-				}
-			}
-			else
+		// write snapshot
+		m_aDemoRecorder[MAX_CLIENTS].RecordSnapshot(Tick(), aData, SnapshotSize);
+	}
+
+	// create snapshots for all clients, then the deltas that aren't shared.
+	// time_get() isn't thread safe
+	m_SnapshotTagtime = time_get();
+	RunSnapshotWorkers(&CServer::BuildSnapshots);
+	FindSharedSnapshotDeltas();
+	RunSnapshotWorkers(&CServer::CreateSnapshotDeltas);
+
+	// send them, the network and the demo recorders are only used here
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(!m_aClients[i].m_SnapBuilt)
+			continue;
+
+		if(m_aDemoRecorder[i].IsRecording())
+		{
+			// write snapshot
+			m_aDemoRecorder[i].RecordSnapshot(Tick(), m_aClients[i].m_pSnap, m_aClients[i].m_SnapSize);
+		}
+
+		const std::vector<char> &vCompData = m_aClients[m_aClients[i].m_SnapDeltaSource].m_vSnapCompData;
+		const char *pCompData = vCompData.data();
+		int SnapshotSize = vCompData.size();
+		int Crc = m_aClients[i].m_SnapCrc;
+		int DeltaTick = m_aClients[i].m_SnapDeltaTick;
+
+		if(SnapshotSize)
+		{
+			const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
+			int NumPackets = (SnapshotSize + MaxSize - 1) / MaxSize;
+
+			for(int n = 0, Left = SnapshotSize; Left > 0; n++)
 			{
-				CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
-				Msg.AddInt(m_CurrentGameTick);
-				Msg.AddInt(m_CurrentGameTick - DeltaTick);
-				SendMsg(&Msg, MSGFLAG_FLUSH, i);
+				int Chunk = Left < MaxSize ? Left : MaxSize;
+				Left -= Chunk;
+
+				if(NumPackets == 1)
+				{
+					CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
+					Msg.AddInt(m_CurrentGameTick);
+					Msg.AddInt(m_CurrentGameTick - DeltaTick);
+					Msg.AddInt(Crc);
+					Msg.AddInt(Chunk);
+					Msg.AddRaw(&pCompData[n * MaxSize], Chunk);
+					SendMsg(&Msg, MSGFLAG_FLUSH, i);
+				}
+				else
+				{
+					CMsgPacker Msg(NETMSG_SNAP, true);
+					Msg.AddInt(m_CurrentGameTick);
+					Msg.AddInt(m_CurrentGameTick - DeltaTick);
+					Msg.AddInt(NumPackets);
+					Msg.AddInt(n);
+					Msg.AddInt(Crc);
+					Msg.AddInt(Chunk);
+					Msg.AddRaw(&pCompData[n * MaxSize], Chunk);
+					SendMsg(&Msg, MSGFLAG_FLUSH, i);
+				}
 			}
 		}
+		else
+		{
+			CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
+			Msg.AddInt(m_CurrentGameTick);
+			Msg.AddInt(m_CurrentGameTick - DeltaTick);
+			SendMsg(&Msg, MSGFLAG_FLUSH, i);
+		}
 	}
 
 	GameServer()->OnPostSnap();
@@ -2468,6 +2558,11 @@ int CServer::Run()
 	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 
 	Antibot()->Init();
+
+	m_SnapshotJobs.Init(g_Config.m_SvSnapshotThreads);
+	for(int i = 0; i < g_Config.m_SvSnapshotThreads + 1; i++)
+		m_vpSnapshotWorkers.emplace_back(new CSnapshotWorker(m_SnapshotDelta));
+
 	GameServer()->OnInit();
 	if(ErrorShutdown())
 	{
@@ -2640,6 +2735,8 @@ int CServer::Run()
 				if(g_Config.m_SvHighBandwidth || (m_CurrentGameTick % 2) == 0)
 					DoSnapshot();
 
+				GameServer()->OnTickFinished();
+
 				UpdateClientRconCommands();
 
 #if defined(CONF_FAMILY_UNIX)
@@ -2814,6 +2911,14 @@ void CServer::ConStatus(IConsole::IResult *pResult, void *pUser)
 		}
 		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 	}
+
+	const CSnapshotDeltaCache &Cache = pThis->m_SnapDeltaCache;
+	if(Cache.NumLookups())
+	{
+		str_format(aBuf, sizeof(aBuf), "snapshot deltas: %lld, shared: %lld (%d%%)",
+			(long long)Cache.NumLookups(), (long long)Cache.NumHits(), (int)(Cache.NumHits() * 100 / Cache.NumLookups()));
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+	}
 }
 
 static int GetAuthLevel(const char *pLevel)
@@ -3531,12 +3636,15 @@ void *CServer::SnapNewItem(int Type, int ID, int Size)
 		g_UuidManager.GetUuid(Type);
 	}
 	dbg_assert(ID >= 0 && ID <= 0xffff, "incorrect id");
-	return ID < 0 ? 0 : m_SnapshotBuilder.NewItem(Type, ID, Size);
+	CSnapshotBuilder *pBuilder = s_pSnapshotBuilder ? s_pSnapshotBuilder : &m_SnapshotBuilder;
+	return ID < 0 ? 0 : pBuilder->NewItem(Type, ID, Size);
 }
 
 void CServer::SnapSetStaticsize(int ItemType, int Size)
 {
 	m_SnapshotDelta.SetStaticsize(ItemType, Size);
+	for(auto &pWorker : m_vpSnapshotWorkers)
+		pWorker->m_Delta.SetStaticsize(ItemType, Size);
 }
 
 static CServer *CreateServer() { return new CServer(); }
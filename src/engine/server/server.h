@@ -15,6 +15,7 @@
 #include <engine/shared/demo.h>
 #include <engine/shared/econ.h>
 #include <engine/shared/fifo.h>
+#include <engine/shared/jobs.h>
 #include <engine/shared/netban.h>
 #include <engine/shared/network.h>
 #include <engine/shared/protocol.h>
@@ -24,6 +25,8 @@
 #include <base/tl/array.h>
 
 #include <list>
+#include <memory>
+#include <vector>
 
 #include "antibot.h"
 #include "authmanager.h"
@@ -161,6 +164,21 @@ public:
 		int m_LastInputTick;
 		CSnapshotStorage m_Snapshots;
 
+		// the snapshot of this tick, built by a snapshot worker and sent
+		// from the main thread
+		bool m_SnapBuilt;
+		int m_SnapCrc;
+		int m_SnapDeltaTick;
+		CSnapshot *m_pSnap;
+		int m_SnapSize;
+		CSnapshot *m_pSnapDeltaBase;
+		int m_SnapDeltaBaseSize;
+		unsigned m_SnapDeltaBaseCrc;
+		// the client whose delta is sent to this one as well, this client
+		// itself if its delta isn't the same as one of a client before it
+		int m_SnapDeltaSource;
+		std::vector<char> m_vSnapCompData; // empty if nothing changed
+
 		CInput m_LatestInput;
 		CInput m_aInputs[200]; // TODO: handle input better
 		int m_CurrentInput;
@@ -204,6 +222,33 @@ public:
 
 	CSnapshotDelta m_SnapshotDelta;
 	CSnapshotBuilder m_SnapshotBuilder;
+
+	// the main thread is worker 0, the others run on m_SnapshotJobs. a
+	// worker builds the snapshots of the clients with ClientID % NumWorkers
+	// equal to its index, so a client's snapshots always come from the
+	// same builder and keep the same extended item types
+	class CSnapshotWorker
+	{
+	public:
+		CSnapshotWorker(const CSnapshotDelta &Delta) :
+			m_Delta(Delta) {}
+
+		CSnapshotBuilder m_Builder;
+		CSnapshotDelta m_Delta;
+		char m_aData[CSnapshot::MAX_SIZE];
+		char m_aDeltaData[CSnapshot::MAX_SIZE];
+		char m_aCompData[CSnapshot::MAX_SIZE];
+	};
+	std::vector<std::unique_ptr<CSnapshotWorker>> m_vpSnapshotWorkers;
+	CJobPool m_SnapshotJobs;
+	SEMAPHORE m_SnapshotsDone;
+	int64_t m_SnapshotTagtime;
+	CSnapshot m_EmptySnapshot;
+	friend class CSnapshotJob;
+
+	// clients that acknowledged the same snapshot and got the same one
+	// this tick share one delta
+	CSnapshotDeltaCache m_SnapDeltaCache;
 	CSnapIDPool m_IDPool;
 	CNetServer m_NetServer;
 	CEcon m_Econ;
@@ -305,6 +350,10 @@ public:
 
 	virtual int SendMsg(CMsgPacker *pMsg, int Flags, int ClientID);
 
+	void RunSnapshotWorkers(void (CServer::*pfnWork)(int Worker));
+	void BuildSnapshots(int Worker);
+	void FindSharedSnapshotDeltas();
+	void CreateSnapshotDeltas(int Worker);
 	void DoSnapshot();
 
 	static int NewClientCallback(int ClientID, void *pUser, bool Sixup);
@@ -4,9 +4,19 @@
 #include "compression.h"
 #include "uuid_manager.h"
 
+#include <base/math.h>
+
 #include <game/generated/protocol.h>
 #include <game/generated/protocolglue.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SNAPSHOT_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 // CSnapshot
 
 CSnapshotItem *CSnapshot::GetItem(int Index) const
@@ -89,59 +99,99 @@ void CSnapshot::DebugDump()
 
 // CSnapshotDelta
 
-struct CItemList
+/*
+	An open addressed table from the item keys of a snapshot to their
+	indices, built once instead of searching the items for every key. The
+	first item of a key is found, like CSnapshot::GetItemIndex() does.
+*/
+class CItemIndexTable
 {
-	int m_Num;
-	int m_aKeys[64];
-	int m_aIndex[64];
-};
+	enum
+	{
+		// twice as many as CSnapshotBuilder can add, a power of two
+		MAX_SLOTS = 2048,
+	};
 
-enum
-{
-	HASHLIST_SIZE = 256,
-};
+	int m_aKeys[MAX_SLOTS];
+	int m_aIndices[MAX_SLOTS]; // -1 for empty slots
+	int m_Shift;
+	int m_Mask;
 
-static void GenerateHash(CItemList *pHashlist, CSnapshot *pSnapshot)
-{
-	for(int i = 0; i < HASHLIST_SIZE; i++)
-		pHashlist[i].m_Num = 0;
+	int Slot(int Key) const { return ((unsigned)Key * 0x9E3779B1u) >> m_Shift; }
 
-	for(int i = 0; i < pSnapshot->NumItems(); i++)
+public:
+	void Build(const CSnapshot *pSnapshot)
 	{
-		int Key = pSnapshot->GetItem(i)->Key();
-		int HashID = ((Key >> 12) & 0xf0) | (Key & 0xf);
-		if(pHashlist[HashID].m_Num != 64)
+		// at most half of the slots are used, so probing stays short
+		int NumItems = minimum(pSnapshot->NumItems(), (int)MAX_SLOTS / 2);
+		int Bits = 4;
+		while((1 << Bits) < NumItems * 2)
+			Bits++;
+		m_Shift = 32 - Bits;
+		m_Mask = (1 << Bits) - 1;
+		for(int i = 0; i <= m_Mask; i++)
+			m_aIndices[i] = -1;
+
+		for(int i = 0; i < NumItems; i++)
 		{
-			pHashlist[HashID].m_aIndex[pHashlist[HashID].m_Num] = i;
-			pHashlist[HashID].m_aKeys[pHashlist[HashID].m_Num] = Key;
-			pHashlist[HashID].m_Num++;
+			int Key = pSnapshot->GetItem(i)->Key();
+			int Slot = this->Slot(Key);
+			while(m_aIndices[Slot] != -1 && m_aKeys[Slot] != Key)
+				Slot = (Slot + 1) & m_Mask;
+			if(m_aIndices[Slot] == -1)
+			{
+				m_aKeys[Slot] = Key;
+				m_aIndices[Slot] = i;
+			}
 		}
 	}
-}
 
-static int GetItemIndexHashed(int Key, const CItemList *pHashlist)
-{
-	int HashID = ((Key >> 12) & 0xf0) | (Key & 0xf);
-	for(int i = 0; i < pHashlist[HashID].m_Num; i++)
+	int Find(int Key) const
 	{
-		if(pHashlist[HashID].m_aKeys[i] == Key)
-			return pHashlist[HashID].m_aIndex[i];
+		for(int Slot = this->Slot(Key); m_aIndices[Slot] != -1; Slot = (Slot + 1) & m_Mask)
+		{
+			if(m_aKeys[Slot] == Key)
+				return m_aIndices[Slot];
+		}
+		return -1;
 	}
+};
 
-	return -1;
+// the size CVariableInt::Pack() packs Value into
+static int PackedSize(int Value)
+{
+	unsigned Bits = Value ^ (Value >> 31); // the sign has its own bit
+	return 1 + (Bits >= 1u << 6) + (Bits >= 1u << 13) + (Bits >= 1u << 20) + (Bits >= 1u << 27);
 }
 
 int CSnapshotDelta::DiffItem(int *pPast, int *pCurrent, int *pOut, int Size)
 {
 	int Needed = 0;
-	while(Size)
+	int i = 0;
+#if defined(__AVX2__)
+	__m256i Changed8 = _mm256_setzero_si256();
+	for(; i + 8 <= Size; i += 8)
+	{
+		__m256i Diff = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(pCurrent + i)), _mm256_loadu_si256((const __m256i *)(pPast + i)));
+		_mm256_storeu_si256((__m256i *)(pOut + i), Diff);
+		Changed8 = _mm256_or_si256(Changed8, Diff);
+	}
+	Needed |= !_mm256_testz_si256(Changed8, Changed8);
+#endif
+#if defined(SNAPSHOT_SSE2)
+	__m128i Changed4 = _mm_setzero_si128();
+	for(; i + 4 <= Size; i += 4)
 	{
-		*pOut = *pCurrent - *pPast;
-		Needed |= *pOut;
-		pOut++;
-		pPast++;
-		pCurrent++;
-		Size--;
+		__m128i Diff = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(pCurrent + i)), _mm_loadu_si128((const __m128i *)(pPast + i)));
+		_mm_storeu_si128((__m128i *)(pOut + i), Diff);
+		Changed4 = _mm_or_si128(Changed4, Diff);
+	}
+	Needed |= _mm_movemask_epi8(_mm_cmpeq_epi32(Changed4, _mm_setzero_si128())) != 0xffff;
+#endif
+	for(; i < Size; i++)
+	{
+		pOut[i] = pCurrent[i] - pPast[i];
+		Needed |= pOut[i];
 	}
 
 	return Needed;
@@ -149,24 +199,23 @@ int CSnapshotDelta::DiffItem(int *pPast, int *pCurrent, int *pOut, int Size)
 
 void CSnapshotDelta::UndiffItem(int *pPast, int *pDiff, int *pOut, int Size)
 {
-	while(Size)
-	{
-		*pOut = *pPast + *pDiff;
-
-		if(*pDiff == 0)
-			m_aSnapshotDataRate[m_SnapshotCurrent] += 1;
-		else
-		{
-			unsigned char aBuf[16];
-			unsigned char *pEnd = CVariableInt::Pack(aBuf, *pDiff);
-			m_aSnapshotDataRate[m_SnapshotCurrent] += (int)(pEnd - (unsigned char *)aBuf) * 8;
-		}
-
-		pOut++;
-		pPast++;
-		pDiff++;
-		Size--;
-	}
+	int i = 0;
+#if defined(__AVX2__)
+	for(; i + 8 <= Size; i += 8)
+		_mm256_storeu_si256((__m256i *)(pOut + i), _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(pPast + i)), _mm256_loadu_si256((const __m256i *)(pDiff + i))));
+#endif
+#if defined(SNAPSHOT_SSE2)
+	for(; i + 4 <= Size; i += 4)
+		_mm_storeu_si128((__m128i *)(pOut + i), _mm_add_epi32(_mm_loadu_si128((const __m128i *)(pPast + i)), _mm_loadu_si128((const __m128i *)(pDiff + i))));
+#endif
+	for(; i < Size; i++)
+		pOut[i] = pPast[i] + pDiff[i];
+
+	// the bits the diff takes in the delta
+	int Rate = 0;
+	for(i = 0; i < Size; i++)
+		Rate += pDiff[i] == 0 ? 1 : PackedSize(pDiff[i]) * 8;
+	m_aSnapshotDataRate[m_SnapshotCurrent] += Rate;
 }
 
 CSnapshotDelta::CSnapshotDelta()
@@ -199,7 +248,6 @@ CSnapshotDelta::CData *CSnapshotDelta::EmptyDelta()
 	return &m_Empty;
 }
 
-// TODO: OPT: this should be made much faster
 int CSnapshotDelta::CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData)
 {
 	CData *pDelta = (CData *)pDstData;
@@ -214,14 +262,14 @@ int CSnapshotDelta::CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData
 	pDelta->m_NumUpdateItems = 0;
 	pDelta->m_NumTempItems = 0;
 
-	CItemList aHashlist[HASHLIST_SIZE];
-	GenerateHash(aHashlist, pTo);
+	CItemIndexTable Table;
+	Table.Build(pTo);
 
 	// pack deleted stuff
 	for(i = 0; i < pFrom->NumItems(); i++)
 	{
 		pFromItem = pFrom->GetItem(i);
-		if(GetItemIndexHashed(pFromItem->Key(), aHashlist) == -1)
+		if(Table.Find(pFromItem->Key()) == -1)
 		{
 			// deleted
 			pDelta->m_NumDeletedItems++;
@@ -230,7 +278,7 @@ int CSnapshotDelta::CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData
 		}
 	}
 
-	GenerateHash(aHashlist, pFrom);
+	Table.Build(pFrom);
 	int aPastIndices[1024];
 
 	// fetch previous indices
@@ -238,15 +286,15 @@ int CSnapshotDelta::CreateDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pDstData
 	const int NumItems = pTo->NumItems();
 	for(i = 0; i < NumItems; i++)
 	{
-		pCurItem = pTo->GetItem(i); // O(1) .. O(n)
-		aPastIndices[i] = GetItemIndexHashed(pCurItem->Key(), aHashlist); // O(n) .. O(n^n)
+		pCurItem = pTo->GetItem(i);
+		aPastIndices[i] = Table.Find(pCurItem->Key());
 	}
 
 	for(i = 0; i < NumItems; i++)
 	{
 		// do delta
-		ItemSize = pTo->GetItemSize(i); // O(1) .. O(n)
-		pCurItem = pTo->GetItem(i); // O(1) .. O(n)
+		ItemSize = pTo->GetItemSize(i);
+		pCurItem = pTo->GetItem(i);
 		PastIndex = aPastIndices[i];
 
 		bool IncludeSize = pCurItem->Type() >= MAX_NETOBJSIZES || !m_aItemSizes[pCurItem->Type()];
@@ -332,6 +380,9 @@ int CSnapshotDelta::UnpackDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData
 
 	Builder.Init();
 
+	CItemIndexTable FromTable;
+	FromTable.Build(pFrom);
+
 	// unpack deleted stuff
 	pDeleted = pData;
 	pData += pDelta->m_NumDeletedItems;
@@ -400,7 +451,7 @@ int CSnapshotDelta::UnpackDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData
 		if(!pNewData)
 			return -4;
 
-		FromIndex = pFrom->GetItemIndex(Key);
+		FromIndex = FromTable.Find(Key);
 		if(FromIndex != -1)
 		{
 			// we got an update so we need pTo apply the diff
@@ -421,31 +472,150 @@ int CSnapshotDelta::UnpackDelta(CSnapshot *pFrom, CSnapshot *pTo, void *pSrcData
 	return Builder.Finish(pTo);
 }
 
+// CSnapshotDeltaCache
+
+CSnapshotDeltaCache::CSnapshotDeltaCache()
+{
+	m_NumLookups = 0;
+	m_NumHits = 0;
+}
+
+int CSnapshotDeltaCache::Find(int Owner, int Variant, const CSnapshot *pBase, int BaseSize, unsigned BaseCrc, const CSnapshot *pSnap, int Size, unsigned Crc)
+{
+	m_NumLookups++;
+	for(const CEntry &Entry : m_vEntries)
+	{
+		if(Entry.m_BaseCrc == BaseCrc && Entry.m_Crc == Crc && Entry.m_Variant == Variant &&
+			Entry.m_BaseSize == BaseSize && Entry.m_Size == Size &&
+			mem_comp(Entry.m_pSnap, pSnap, Size) == 0 && mem_comp(Entry.m_pBase, pBase, BaseSize) == 0)
+		{
+			m_NumHits++;
+			return Entry.m_Owner;
+		}
+	}
+
+	CEntry Entry;
+	Entry.m_BaseCrc = BaseCrc;
+	Entry.m_Crc = Crc;
+	Entry.m_Variant = Variant;
+	Entry.m_pBase = pBase;
+	Entry.m_BaseSize = BaseSize;
+	Entry.m_pSnap = pSnap;
+	Entry.m_Size = Size;
+	Entry.m_Owner = Owner;
+	m_vEntries.push_back(Entry);
+	return Owner;
+}
+
 // CSnapshotStorage
 
-void CSnapshotStorage::Init()
+CSnapshotStorage::CSnapshotStorage()
 {
 	m_pFirst = 0;
 	m_pLast = 0;
+	m_WritePos = 0;
+	m_ArenaSize = MIN_ARENA_SIZE;
+	for(auto &pHolder : m_apTickSlots)
+		pHolder = 0;
+	m_NumUnslotted = 0;
 }
 
-void CSnapshotStorage::PurgeAll()
+CSnapshotStorage::~CSnapshotStorage()
 {
-	CHolder *pHolder = m_pFirst;
-	CHolder *pNext;
+	PurgeAll();
+}
 
-	while(pHolder)
-	{
-		pNext = pHolder->m_pNext;
-		free(pHolder);
-		pHolder = pNext;
-	}
+void CSnapshotStorage::Init()
+{
+	PurgeAll();
+}
+
+void CSnapshotStorage::PurgeAll()
+{
+	for(auto &Arena : m_vArenas)
+		free(Arena.m_pData);
+	m_vArenas.clear();
+	m_WritePos = 0;
+	for(auto &pHolder : m_apTickSlots)
+		pHolder = 0;
+	m_NumUnslotted = 0;
 
 	// no more snapshots in storage
 	m_pFirst = 0;
 	m_pLast = 0;
 }
 
+void *CSnapshotStorage::Allocate(int Size)
+{
+	if(!m_vArenas.empty())
+	{
+		CArena &Arena = m_vArenas.back();
+		if(!Arena.m_NumHolders)
+			m_WritePos = 0;
+		// the oldest holder of the last arena is at its start while the
+		// older arenas have holders left
+		int ReadPos = !Arena.m_NumHolders ? Arena.m_Size : m_vArenas.size() > 1 ? 0 : (char *)m_pFirst - Arena.m_pData;
+
+		// the free space is after the newest holder up to the oldest one,
+		// equal positions mean it's full
+		int Pos = -1;
+		if(m_WritePos > ReadPos)
+		{
+			if(Size <= Arena.m_Size - m_WritePos)
+				Pos = m_WritePos;
+			else if(Size <= ReadPos)
+				Pos = 0; // wrap around
+		}
+		else if(Size <= ReadPos - m_WritePos)
+		{
+			Pos = m_WritePos;
+		}
+
+		if(Pos >= 0)
+		{
+			Arena.m_NumHolders++;
+			m_WritePos = Pos + Size;
+			return Arena.m_pData + Pos;
+		}
+
+		// an empty arena that is too small isn't needed anymore
+		if(!Arena.m_NumHolders)
+		{
+			free(Arena.m_pData);
+			m_vArenas.pop_back();
+		}
+		m_ArenaSize *= 2;
+	}
+
+	while(m_ArenaSize < Size)
+		m_ArenaSize *= 2;
+	CArena Arena;
+	Arena.m_pData = (char *)malloc(m_ArenaSize);
+	Arena.m_Size = m_ArenaSize;
+	Arena.m_NumHolders = 1;
+	m_vArenas.push_back(Arena);
+	m_WritePos = Size;
+	return Arena.m_pData;
+}
+
+void CSnapshotStorage::Free(CHolder *pHolder)
+{
+	CHolder *&pSlot = m_apTickSlots[pHolder->m_Tick & (NUM_TICK_SLOTS - 1)];
+	if(pSlot == pHolder)
+		pSlot = 0;
+	else
+		m_NumUnslotted--;
+
+	// only the oldest holder is freed, it's in the first arena
+	CArena &Arena = m_vArenas.front();
+	Arena.m_NumHolders--;
+	if(!Arena.m_NumHolders && m_vArenas.size() > 1)
+	{
+		free(Arena.m_pData);
+		m_vArenas.erase(m_vArenas.begin());
+	}
+}
+
 void CSnapshotStorage::PurgeUntil(int Tick)
 {
 	CHolder *pHolder = m_pFirst;
@@ -456,7 +626,7 @@ void CSnapshotStorage::PurgeUntil(int Tick)
 		pNext = pHolder->m_pNext;
 		if(pHolder->m_Tick >= Tick)
 			return; // no more to remove
-		free(pHolder);
+		Free(pHolder);
 
 		// did we come to the end of the list?
 		if(!pNext)
@@ -481,7 +651,10 @@ void CSnapshotStorage::Add(int Tick, int64_t Tagtime, int DataSize, void *pData,
 	if(CreateAlt)
 		TotalSize += DataSize;
 
-	CHolder *pHolder = (CHolder *)malloc(TotalSize);
+	// keep the next holder aligned
+	TotalSize = (TotalSize + alignof(CHolder) - 1) & ~(int)(alignof(CHolder) - 1);
+
+	CHolder *pHolder = (CHolder *)Allocate(TotalSize);
 
 	// set data
 	pHolder->m_Tick = Tick;
@@ -506,29 +679,49 @@ void CSnapshotStorage::Add(int Tick, int64_t Tagtime, int DataSize, void *pData,
 	else
 		m_pFirst = pHolder;
 	m_pLast = pHolder;
+
+	// Get() returns the oldest holder of a tick, a newer one with the same
+	// tick is left out of the slot
+	CHolder *&pSlot = m_apTickSlots[Tick & (NUM_TICK_SLOTS - 1)];
+	if(pSlot && pSlot->m_Tick == Tick)
+	{
+		m_NumUnslotted++;
+	}
+	else
+	{
+		if(pSlot)
+			m_NumUnslotted++;
+		pSlot = pHolder;
+	}
 }
 
 int CSnapshotStorage::Get(int Tick, int64_t *pTagtime, CSnapshot **ppData, CSnapshot **ppAltData)
 {
-	CHolder *pHolder = m_pFirst;
-
-	while(pHolder)
+	CHolder *pHolder = m_apTickSlots[Tick & (NUM_TICK_SLOTS - 1)];
+	if(!pHolder || pHolder->m_Tick != Tick)
 	{
-		if(pHolder->m_Tick == Tick)
+		pHolder = 0;
+		// only search the list if some holders aren't in their slot
+		for(CHolder *pCur = m_NumUnslotted ? m_pFirst : 0; pCur; pCur = pCur->m_pNext)
 		{
-			if(pTagtime)
-				*pTagtime = pHolder->m_Tagtime;
-			if(ppData)
-				*ppData = pHolder->m_pSnap;
-			if(ppAltData)
-				*ppAltData = pHolder->m_pAltSnap;
-			return pHolder->m_SnapSize;
+			if(pCur->m_Tick == Tick)
+			{
+				pHolder = pCur;
+				break;
+			}
 		}
-
-		pHolder = pHolder->m_pNext;
 	}
 
-	return -1;
+	if(!pHolder)
+		return -1;
+
+	if(pTagtime)
+		*pTagtime = pHolder->m_Tagtime;
+	if(ppData)
+		*ppData = pHolder->m_pSnap;
+	if(ppAltData)
+		*ppAltData = pHolder->m_pAltSnap;
+	return pHolder->m_SnapSize;
 }
 
 // CSnapshotBuilder
@@ -5,6 +5,8 @@
 
 #include <base/system.h>
 
+#include <vector>
+
 // CSnapshot
 
 class CSnapshotItem
@@ -91,8 +93,56 @@ public:
 	int UnpackDelta(class CSnapshot *pFrom, class CSnapshot *pTo, void *pData, int DataSize);
 };
 
+// CSnapshotDeltaCache
+
+/*
+	Finds the deltas of a tick that are the same: the same snapshot against
+	the same base, with the same static item sizes (Variant). Entries are
+	keyed on the crcs of both snapshots. The crcs are just sums of the item
+	data, so a matching key is confirmed by comparing the snapshots, a
+	collision costs a delta but never gives a wrong one. The snapshots
+	aren't copied and must stay valid until Clear().
+*/
+class CSnapshotDeltaCache
+{
+	struct CEntry
+	{
+		unsigned m_BaseCrc;
+		unsigned m_Crc;
+		int m_Variant;
+		const CSnapshot *m_pBase;
+		int m_BaseSize;
+		const CSnapshot *m_pSnap;
+		int m_Size;
+		int m_Owner;
+	};
+	std::vector<CEntry> m_vEntries;
+	int64_t m_NumLookups;
+	int64_t m_NumHits;
+
+public:
+	CSnapshotDeltaCache();
+
+	void Clear() { m_vEntries.clear(); }
+	// returns the owner of an entry with the same delta, or adds one owned
+	// by Owner and returns Owner
+	int Find(int Owner, int Variant, const CSnapshot *pBase, int BaseSize, unsigned BaseCrc, const CSnapshot *pSnap, int Size, unsigned Crc);
+
+	// since the start, for the status
+	int64_t NumLookups() const { return m_NumLookups; }
+	int64_t NumHits() const { return m_NumHits; }
+};
+
 // CSnapshotStorage
 
+/*
+	The holders and their snapshots are stored one after another in a ring
+	of memory, adding one takes the space after the newest and purging
+	frees the oldest. If a snapshot doesn't fit, a ring twice as large is
+	started and the old one is freed once all of its snapshots are purged,
+	so the holders never move and nothing is allocated once the ring is
+	large enough for the snapshots kept.
+*/
 class CSnapshotStorage
 {
 public:
@@ -113,8 +163,41 @@ public:
 	CHolder *m_pFirst;
 	CHolder *m_pLast;
 
-	CSnapshotStorage() { Init(); };
-	~CSnapshotStorage() { PurgeAll(); };
+private:
+	enum
+	{
+		MIN_ARENA_SIZE = 64 * 1024,
+		// a power of two, more than the ticks of the snapshots kept
+		NUM_TICK_SLOTS = 256,
+	};
+
+	class CArena
+	{
+	public:
+		char *m_pData;
+		int m_Size;
+		int m_NumHolders;
+	};
+
+	// oldest first, the holders are added to the last one
+	std::vector<CArena> m_vArenas;
+	int m_WritePos;
+	// the size of the next arena, kept after PurgeAll()
+	int m_ArenaSize;
+
+	// the holders by their tick modulo NUM_TICK_SLOTS, the ones that share
+	// a slot with another are only found in the list
+	CHolder *m_apTickSlots[NUM_TICK_SLOTS];
+	int m_NumUnslotted;
+
+	void *Allocate(int Size);
+	void Free(CHolder *pHolder);
+
+public:
+	CSnapshotStorage();
+	~CSnapshotStorage();
+	CSnapshotStorage(const CSnapshotStorage &) = delete;
+	CSnapshotStorage &operator=(const CSnapshotStorage &) = delete;
 	void Init();
 	void PurgeAll();
 	void PurgeUntil(int Tick);
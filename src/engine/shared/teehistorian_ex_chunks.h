@@ -12,3 +12,15 @@ UUID(TEEHISTORIAN_SAVE_SUCCESS, "teehistorian-save-success@ddnet.tw")
 UUID(TEEHISTORIAN_SAVE_FAILURE, "teehistorian-save-failure@ddnet.tw")
 UUID(TEEHISTORIAN_LOAD_SUCCESS, "teehistorian-load-success@ddnet.tw")
 UUID(TEEHISTORIAN_LOAD_FAILURE, "teehistorian-load-failure@ddnet.tw")
+UUID(TEEHISTORIAN_B2_WORLD_CREATE, "teehistorian-box2d-world-create@ddnet.tw")
+UUID(TEEHISTORIAN_B2_WORLD_DESTROY, "teehistorian-box2d-world-destroy@ddnet.tw")
+UUID(TEEHISTORIAN_B2_BOXES, "teehistorian-box2d-boxes@ddnet.tw")
+UUID(TEEHISTORIAN_B2_BOX_DESTROY, "teehistorian-box2d-box-destroy@ddnet.tw")
+UUID(TEEHISTORIAN_B2_TEE_CREATE, "teehistorian-box2d-tee-create@ddnet.tw")
+UUID(TEEHISTORIAN_B2_TEE_DESTROY, "teehistorian-box2d-tee-destroy@ddnet.tw")
+UUID(TEEHISTORIAN_B2_TEE_HAMMER, "teehistorian-box2d-tee-hammer@ddnet.tw")
+UUID(TEEHISTORIAN_B2_IMPULSE, "teehistorian-box2d-impulse@ddnet.tw")
+UUID(TEEHISTORIAN_B2_EXPLOSION, "teehistorian-box2d-explosion@ddnet.tw")
+UUID(TEEHISTORIAN_B2_SLEEP, "teehistorian-box2d-sleep@ddnet.tw")
+UUID(TEEHISTORIAN_B2_STEP, "teehistorian-box2d-step@ddnet.tw")
+UUID(TEEHISTORIAN_B2_CHECKSUM, "teehistorian-box2d-checksum@ddnet.tw")
@@ -0,0 +1,24 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_BOX2D_KEYFRAME_H
+#define GAME_BOX2D_KEYFRAME_H
+
+#include <base/math.h>
+#include <base/vmath.h>
+
+#include <game/generated/protocol.h>
+
+// game units per box2d meter, the same on the server and the client
+static const float B2_SCALE = 30.0f;
+
+// where a Box2DBody keyframe ends up after Ticks ticks when nothing is in
+// its way. Gravity is in units per tick squared, box2d applies it to the
+// velocity before moving the body
+inline void ExtrapolateBox2DBody(const CNetObj_Box2DBody *pKeyframe, int Ticks, vec2 Gravity, vec2 *pPos, float *pAngle)
+{
+	vec2 Vel = vec2(pKeyframe->m_VelX, pKeyframe->m_VelY) / 256.0f;
+	*pPos = vec2(pKeyframe->m_X, pKeyframe->m_Y) + Vel * (float)Ticks + Gravity * (Ticks * (Ticks + 1) / 2.0f);
+	*pAngle = (pKeyframe->m_Angle + pKeyframe->m_AngularVel * (float)Ticks) / 65536.0f * 2 * pi;
+}
+
+#endif
@@ -0,0 +1,259 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_map.h"
+
+#include <base/system.h>
+
+#include <box2d/box2d.h>
+
+#include <game/box2d_keyframe.h>
+#include <game/collision.h>
+#include <game/gamecore.h>
+#include <game/layers.h>
+#include <game/mapitems.h>
+
+// box2d units per tile
+static const float TILE_SCALE = 32.0f / B2_SCALE;
+
+enum
+{
+	DIR_RIGHT = 0,
+	DIR_DOWN,
+	DIR_LEFT,
+	DIR_UP,
+	NUM_DIRS
+};
+
+static const ivec2 s_aDirs[NUM_DIRS] = {ivec2(1, 0), ivec2(0, 1), ivec2(-1, 0), ivec2(0, -1)};
+
+static bool IsSolidTile(int Index)
+{
+	return Index == TILE_SOLID || Index == TILE_NOHOOK;
+}
+
+void GetSolidTiles(const CCollision *pCollision, std::vector<unsigned char> &vSolid)
+{
+	int Num = pCollision->GetWidth() * pCollision->GetHeight();
+	vSolid.resize(Num);
+	for(int i = 0; i < Num; i++)
+		vSolid[i] = IsSolidTile(pCollision->GetTileIndex(i)) || IsSolidTile(pCollision->GetFTileIndex(i));
+}
+
+void FindTileOutlines(const unsigned char *pSolid, int Width, int Height, std::vector<CTileOutline> &vOutlines)
+{
+	// every solid tile contributes one directed edge per side that borders
+	// a non-solid tile, stored as a direction mask on the edge's start corner
+	int Pitch = Width + 1;
+	std::vector<unsigned char> vEdges((size_t)Pitch * (Height + 1), 0);
+	for(int y = 0; y < Height; y++)
+	{
+		for(int x = 0; x < Width; x++)
+		{
+			if(!pSolid[y * Width + x])
+				continue;
+			if(y == 0 || !pSolid[(y - 1) * Width + x])
+				vEdges[y * Pitch + x] |= 1 << DIR_RIGHT;
+			if(x == Width - 1 || !pSolid[y * Width + x + 1])
+				vEdges[y * Pitch + x + 1] |= 1 << DIR_DOWN;
+			if(y == Height - 1 || !pSolid[(y + 1) * Width + x])
+				vEdges[(y + 1) * Pitch + x + 1] |= 1 << DIR_LEFT;
+			if(x == 0 || !pSolid[y * Width + x - 1])
+				vEdges[(y + 1) * Pitch + x] |= 1 << DIR_UP;
+		}
+	}
+
+	for(int Start = 0; Start < (int)vEdges.size(); Start++)
+	{
+		while(vEdges[Start])
+		{
+			int FirstDir = 0;
+			while(!(vEdges[Start] & (1 << FirstDir)))
+				FirstDir++;
+
+			CTileOutline Outline;
+			ivec2 Pos(Start % Pitch, Start / Pitch);
+			int Cur = Start;
+			int Dir = FirstDir;
+			Outline.push_back(Pos);
+			while(true)
+			{
+				vEdges[Cur] &= ~(1 << Dir);
+				Pos += s_aDirs[Dir];
+				Cur = Pos.y * Pitch + Pos.x;
+
+				// where two solid tiles only touch diagonally, always turn
+				// right so that they end up in separate outlines. arriving
+				// back at the start, the same rule leads into the first edge
+				int NextDir = -1;
+				for(int Turn : {1, 0, 3})
+				{
+					int Candidate = (Dir + Turn) % NUM_DIRS;
+					if((Cur == Start && Candidate == FirstDir) || (vEdges[Cur] & (1 << Candidate)))
+					{
+						NextDir = Candidate;
+						break;
+					}
+				}
+				dbg_assert(NextDir != -1, "tile outline is not closed");
+
+				if(Cur == Start && NextDir == FirstDir)
+				{
+					// the start is only a corner if the outline turns there
+					if(Dir == FirstDir)
+						Outline.erase(Outline.begin());
+					break;
+				}
+				if(NextDir != Dir)
+					Outline.push_back(Pos);
+				Dir = NextDir;
+			}
+			vOutlines.push_back(Outline);
+		}
+	}
+}
+
+b2Body *CreateMapBody(b2World *pWorld, const std::vector<CTileOutline> &vOutlines)
+{
+	b2BodyDef BodyDef;
+	BodyDef.type = b2_staticBody;
+	b2Body *pBody = pWorld->CreateBody(&BodyDef);
+
+	std::vector<b2Vec2> vVertices;
+	for(const CTileOutline &Outline : vOutlines)
+	{
+		vVertices.clear();
+		for(const ivec2 &Corner : Outline)
+			vVertices.push_back(b2Vec2(Corner.x * TILE_SCALE, Corner.y * TILE_SCALE));
+
+		b2ChainShape Shape;
+		Shape.CreateLoop(vVertices.data(), vVertices.size());
+		b2FixtureDef FixtureDef;
+		FixtureDef.shape = &Shape;
+		pBody->CreateFixture(&FixtureDef);
+	}
+	return pBody;
+}
+
+bool GetQuadPolygon(const CQuad *pQuad, vec2 Offset, CQuadPolygon *pPolygon)
+{
+	// the points are top left, top right, bottom left, bottom right
+	static const int s_aOrder[4] = {0, 1, 3, 2};
+	for(int i = 0; i < 4; i++)
+	{
+		const CPoint &Point = pQuad->m_aPoints[s_aOrder[i]];
+		// groups are offset the other way, like the client renders them
+		pPolygon->m_aPoints[i] = vec2(fx2f(Point.x), fx2f(Point.y)) - Offset;
+	}
+
+	// b2PolygonShape::Set() welds points closer than the linear slop and
+	// asserts on what is left of a polygon that is too thin, so those are
+	// rejected here
+	const float MinDistance = b2_linearSlop * B2_SCALE;
+	float Area = 0.0f;
+	float MaxEdge = 0.0f;
+	for(int i = 0; i < 4; i++)
+	{
+		vec2 a = pPolygon->m_aPoints[i];
+		vec2 b = pPolygon->m_aPoints[(i + 1) % 4];
+		Area += a.x * b.y - b.x * a.y;
+		MaxEdge = maximum(MaxEdge, distance(a, b));
+		for(int j = i + 1; j < 4; j++)
+		{
+			if(distance(a, pPolygon->m_aPoints[j]) < MinDistance)
+				return false;
+		}
+	}
+	Area = absolute(Area / 2);
+	// the thickness across the longest edge
+	return Area >= 1.0f && Area / MaxEdge >= MinDistance;
+}
+
+int GetPhysicsQuads(const CLayers *pLayers, std::vector<CQuadPolygon> &vPolygons)
+{
+	int NumSkipped = 0;
+	for(int g = 0; g < pLayers->NumGroups(); g++)
+	{
+		const CMapItemGroup *pGroup = pLayers->GetGroup(g);
+		char aName[sizeof(pGroup->m_aName)] = "";
+		if(pGroup->m_Version >= 3)
+			IntsToStr(pGroup->m_aName, sizeof(pGroup->m_aName) / sizeof(int), aName);
+		if(str_comp(aName, B2_PHYSICS_GROUP) != 0)
+			continue;
+
+		// a group with parallax moves with the view, it has no fixed place
+		// in the world to collide at
+		if(pGroup->m_ParallaxX != 100 || pGroup->m_ParallaxY != 100)
+		{
+			for(int l = 0; l < pGroup->m_NumLayers; l++)
+			{
+				const CMapItemLayer *pLayer = pLayers->GetLayer(pGroup->m_StartLayer + l);
+				if(pLayer->m_Type == LAYERTYPE_QUADS)
+					NumSkipped += reinterpret_cast<const CMapItemLayerQuads *>(pLayer)->m_NumQuads;
+			}
+			continue;
+		}
+
+		vec2 Offset(pGroup->m_OffsetX, pGroup->m_OffsetY);
+		for(int l = 0; l < pGroup->m_NumLayers; l++)
+		{
+			const CMapItemLayer *pLayer = pLayers->GetLayer(pGroup->m_StartLayer + l);
+			if(pLayer->m_Type != LAYERTYPE_QUADS)
+				continue;
+			const CMapItemLayerQuads *pQuadLayer = reinterpret_cast<const CMapItemLayerQuads *>(pLayer);
+			const CQuad *pQuads = static_cast<const CQuad *>(pLayers->Map()->GetData(pQuadLayer->m_Data));
+			for(int i = 0; i < pQuadLayer->m_NumQuads; i++)
+			{
+				CQuadPolygon Polygon;
+				// the server doesn't animate quads
+				if(pQuads[i].m_PosEnv >= 0 || !GetQuadPolygon(&pQuads[i], Offset, &Polygon))
+					NumSkipped++;
+				else
+					vPolygons.push_back(Polygon);
+			}
+		}
+	}
+	return NumSkipped;
+}
+
+b2Body *CreateQuadsBody(b2World *pWorld, const std::vector<CQuadPolygon> &vPolygons)
+{
+	b2BodyDef BodyDef;
+	BodyDef.type = b2_staticBody;
+	b2Body *pBody = pWorld->CreateBody(&BodyDef);
+
+	for(const CQuadPolygon &Polygon : vPolygons)
+	{
+		b2Vec2 aVertices[4];
+		for(int i = 0; i < 4; i++)
+			aVertices[i] = b2Vec2(Polygon.m_aPoints[i].x / B2_SCALE, Polygon.m_aPoints[i].y / B2_SCALE);
+		// concave quads become their convex hull
+		b2PolygonShape Shape;
+		Shape.Set(aVertices, 4);
+		b2FixtureDef FixtureDef;
+		FixtureDef.shape = &Shape;
+		pBody->CreateFixture(&FixtureDef);
+	}
+	return pBody;
+}
+
+b2Body *CreateMapBodyPerTile(b2World *pWorld, const unsigned char *pSolid, int Width, int Height)
+{
+	b2BodyDef BodyDef;
+	BodyDef.type = b2_staticBody;
+	b2Body *pBody = pWorld->CreateBody(&BodyDef);
+
+	for(int y = 0; y < Height; y++)
+	{
+		for(int x = 0; x < Width; x++)
+		{
+			if(!pSolid[y * Width + x])
+				continue;
+			b2PolygonShape Shape;
+			Shape.SetAsBox(TILE_SCALE / 2, TILE_SCALE / 2, b2Vec2((x + 0.5f) * TILE_SCALE, (y + 0.5f) * TILE_SCALE), 0.0f);
+			b2FixtureDef FixtureDef;
+			FixtureDef.shape = &Shape;
+			pBody->CreateFixture(&FixtureDef);
+		}
+	}
+	return pBody;
+}
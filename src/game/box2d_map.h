@@ -0,0 +1,56 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_BOX2D_MAP_H
+#define GAME_BOX2D_MAP_H
+
+#include <base/vmath.h>
+
+#include <vector>
+
+class CCollision;
+class CLayers;
+class b2Body;
+class b2World;
+struct CQuad;
+
+// quads in groups with this name are box2d geometry
+static const char *const B2_PHYSICS_GROUP = "Box2D";
+
+// closed polygon around a connected area of solid tiles, in tile corner
+// coordinates. outer boundaries wind clockwise on screen, holes
+// counter-clockwise, so the edge normals always point out of the solid.
+typedef std::vector<ivec2> CTileOutline;
+
+// marks every tile that is solid (or unhookable) in the game or front layer
+void GetSolidTiles(const CCollision *pCollision, std::vector<unsigned char> &vSolid);
+
+// traces the boundaries of all solid areas in a Width * Height tile mask,
+// collinear tile edges are merged into a single outline segment
+void FindTileOutlines(const unsigned char *pSolid, int Width, int Height, std::vector<CTileOutline> &vOutlines);
+
+// creates one static body with a chain loop per outline
+b2Body *CreateMapBody(b2World *pWorld, const std::vector<CTileOutline> &vOutlines);
+
+// a quad of the physics group in game units, in the order of its outline
+struct CQuadPolygon
+{
+	vec2 m_aPoints[4];
+};
+
+// returns false if the quad is too thin to collide with or has points box2d
+// would weld together. Offset is the group's, subtracted like the client does
+bool GetQuadPolygon(const CQuad *pQuad, vec2 Offset, CQuadPolygon *pPolygon);
+
+// collects the quads of all quad layers in the physics groups of the map.
+// returns the number of quads skipped because they move with an envelope,
+// are in a group with parallax or have no area
+int GetPhysicsQuads(const CLayers *pLayers, std::vector<CQuadPolygon> &vPolygons);
+
+// creates one static body with a polygon fixture per quad
+b2Body *CreateQuadsBody(b2World *pWorld, const std::vector<CQuadPolygon> &vPolygons);
+
+// creates one static body with a box fixture per solid tile, only used to
+// compare against the merged outlines
+b2Body *CreateMapBodyPerTile(b2World *pWorld, const unsigned char *pSolid, int Width, int Height);
+
+#endif
@@ -297,6 +297,32 @@ void CItems::RenderLaser(const struct CNetObj_Laser *pCurrent, bool IsPredicted)
 	}
 }
 
+void CItems::RenderBox2DBody(vec2 Pos, float Angle, const CNetObj_Box2DShape *pShape)
+{
+	vec2 HalfSize(pShape->m_Width / 2.0f, pShape->m_Height / 2.0f);
+	vec2 aCorners[4] = {
+		vec2(-HalfSize.x, -HalfSize.y),
+		vec2(HalfSize.x, -HalfSize.y),
+		vec2(HalfSize.x, HalfSize.y),
+		vec2(-HalfSize.x, HalfSize.y)};
+	float s = sinf(Angle);
+	float c = cosf(Angle);
+	for(auto &Corner : aCorners)
+		Corner = Pos + vec2(Corner.x * c - Corner.y * s, Corner.x * s + Corner.y * c);
+
+	// drawn the same way as the lasers older servers send for every edge
+	for(int i = 0; i < 4; i++)
+	{
+		CNetObj_Laser Edge;
+		Edge.m_FromX = round_to_int(aCorners[i].x);
+		Edge.m_FromY = round_to_int(aCorners[i].y);
+		Edge.m_X = round_to_int(aCorners[(i + 1) % 4].x);
+		Edge.m_Y = round_to_int(aCorners[(i + 1) % 4].y);
+		Edge.m_StartTick = Client()->GameTick(g_Config.m_ClDummy);
+		RenderLaser(&Edge);
+	}
+}
+
 void CItems::OnRender()
 {
 	if(Client()->State() < IClient::STATE_ONLINE)
@@ -391,6 +417,17 @@ void CItems::OnRender()
 			}
 			RenderLaser((const CNetObj_Laser *)pData);
 		}
+		else if(Item.m_Type == NETOBJTYPE_BOX2DBODY)
+		{
+			// the item is only a keyframe, the body is where the box2d
+			// prediction extrapolated it to
+			const CNetObj_Box2DBody *pBody = (const CNetObj_Box2DBody *)pData;
+			const void *pShape = Client()->SnapFindItem(IClient::SNAP_CURRENT, NETOBJTYPE_BOX2DSHAPE, pBody->m_Shape);
+			vec2 Pos;
+			float Angle;
+			if(pShape && GameClient()->m_Box2DWorld.GetTransform(Item.m_ID, Client()->IntraGameTick(g_Config.m_ClDummy), &Pos, &Angle))
+				RenderBox2DBody(Pos, Angle, (const CNetObj_Box2DShape *)pShape);
+		}
 	}
 
 	// render flag
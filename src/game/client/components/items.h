@@ -20,6 +20,7 @@ class CItems : public CComponent
 	void RenderPickup(const CNetObj_Pickup *pPrev, const CNetObj_Pickup *pCurrent, bool IsPredicted = false);
 	void RenderFlag(const CNetObj_Flag *pPrev, const CNetObj_Flag *pCurrent, const CNetObj_GameData *pPrevGameData, const CNetObj_GameData *pCurGameData);
 	void RenderLaser(const struct CNetObj_Laser *pCurrent, bool IsPredicted = false);
+	void RenderBox2DBody(vec2 Pos, float Angle, const CNetObj_Box2DShape *pShape);
 
 	int m_ItemsQuadContainerIndex;
 
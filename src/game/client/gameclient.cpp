@@ -418,6 +418,7 @@ void CGameClient::OnConnected()
 {
 	m_Layers.Init(Kernel());
 	m_Collision.Init(Layers());
+	m_Box2DWorld.Init(Layers(), Collision());
 
 	RenderTools()->RenderTilemapGenerateSkip(Layers());
 
@@ -503,6 +504,8 @@ void CGameClient::OnReset()
 	m_LastDummyConnected = false;
 
 	m_ReceivedDDNetPlayer = false;
+
+	m_Box2DWorld.Clear();
 }
 
 void CGameClient::UpdatePositions()
@@ -1570,6 +1573,7 @@ void CGameClient::OnNewSnapshot()
 		CMsgPacker Msg(NETMSGTYPE_CL_ISDDNETLEGACY, false);
 		Msg.AddInt(CLIENT_VERSIONNR);
 		Client()->SendMsgY(&Msg, MSGFLAG_VITAL, 0);
+		SendBox2DSupport(0);
 		m_DDRaceMsgSent[0] = true;
 	}
 
@@ -1578,6 +1582,7 @@ void CGameClient::OnNewSnapshot()
 		CMsgPacker Msg(NETMSGTYPE_CL_ISDDNETLEGACY, false);
 		Msg.AddInt(CLIENT_VERSIONNR);
 		Client()->SendMsgY(&Msg, MSGFLAG_VITAL, 1);
+		SendBox2DSupport(1);
 		m_DDRaceMsgSent[1] = true;
 	}
 
@@ -1640,6 +1645,8 @@ void CGameClient::OnNewSnapshot()
 	PrevLocalID = m_Snap.m_LocalClientID;
 	m_IsDummySwapping = 0;
 
+	m_Box2DWorld.OnNewSnapshot(Client(), Client()->GameTick(g_Config.m_ClDummy));
+
 	// update prediction data
 	if(Client()->State() != IClient::STATE_DEMOPLAYBACK)
 		UpdatePrediction();
@@ -1986,6 +1993,14 @@ void CGameClient::CClientData::Reset()
 	UpdateRenderInfo(false);
 }
 
+void CGameClient::SendBox2DSupport(int Dummy)
+{
+	CNetMsg_Cl_Box2DSupport Msg;
+	CMsgPacker Packer(Msg.MsgID(), false);
+	Msg.Pack(&Packer);
+	Client()->SendMsgY(&Packer, MSGFLAG_VITAL, Dummy);
+}
+
 void CGameClient::SendSwitchTeam(int Team)
 {
 	CNetMsg_Cl_SetTeam Msg;
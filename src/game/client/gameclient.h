@@ -17,6 +17,7 @@
 
 #include <game/client/prediction/entities/character.h>
 #include <game/client/prediction/entities/laser.h>
+#include <game/client/prediction/box2dworld.h>
 #include <game/client/prediction/entities/pickup.h>
 #include <game/client/prediction/gameworld.h>
 
@@ -479,6 +480,7 @@ public:
 	void SendInfo(bool Start);
 	virtual void SendDummyInfo(bool Start);
 	void SendKill(int ClientID);
+	void SendBox2DSupport(int Dummy);
 
 	// DDRace
 
@@ -507,6 +509,7 @@ public:
 	CGameWorld m_GameWorld;
 	CGameWorld m_PredictedWorld;
 	CGameWorld m_PrevPredictedWorld;
+	CBox2DPredictionWorld m_Box2DWorld;
 
 	void DummyResetInput();
 	void Echo(const char *pString);
@@ -0,0 +1,212 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2dworld.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <box2d/box2d.h>
+
+#include <engine/client.h>
+#include <engine/shared/protocol.h>
+
+#include <game/box2d_keyframe.h>
+#include <game/box2d_map.h>
+#include <game/collision.h>
+
+#include <cmath>
+
+CBox2DPredictionWorld::CBox2DPredictionWorld()
+{
+	m_Tick = -1;
+	m_TickTime = 1.0f / SERVER_TICK_SPEED;
+}
+
+CBox2DPredictionWorld::~CBox2DPredictionWorld()
+{
+	Clear();
+}
+
+void CBox2DPredictionWorld::Init(const CLayers *pLayers, const CCollision *pCollision)
+{
+	Clear();
+	m_pWorld.reset(new b2World(b2Vec2(0.0f, 0.0f)));
+
+	std::vector<unsigned char> vSolid;
+	std::vector<CTileOutline> vOutlines;
+	GetSolidTiles(pCollision, vSolid);
+	FindTileOutlines(vSolid.data(), pCollision->GetWidth(), pCollision->GetHeight(), vOutlines);
+	if(!vOutlines.empty())
+		CreateMapBody(m_pWorld.get(), vOutlines);
+
+	std::vector<CQuadPolygon> vQuads;
+	GetPhysicsQuads(pLayers, vQuads);
+	if(!vQuads.empty())
+		CreateQuadsBody(m_pWorld.get(), vQuads);
+}
+
+void CBox2DPredictionWorld::Clear()
+{
+	if(m_pWorld)
+	{
+		for(auto &Body : m_Bodies)
+			m_pWorld->DestroyBody(Body.second.m_pBody);
+	}
+	m_Bodies.clear();
+	m_Tick = -1;
+}
+
+b2Body *CBox2DPredictionWorld::CreateBody(const CNetObj_Box2DBody *pKeyframe, ivec2 Size)
+{
+	b2BodyDef BodyDef;
+	if(pKeyframe->m_Flags & BOX2DBODYFLAG_STATIC)
+		BodyDef.type = b2_staticBody;
+	else if(pKeyframe->m_Flags & BOX2DBODYFLAG_KINEMATIC)
+		BodyDef.type = b2_kinematicBody;
+	else
+		BodyDef.type = b2_dynamicBody;
+	b2Body *pBody = m_pWorld->CreateBody(&BodyDef);
+
+	// the server doesn't tell the density, so all boxes weigh the same
+	b2PolygonShape Shape;
+	Shape.SetAsBox(Size.x / 2.0f / B2_SCALE, Size.y / 2.0f / B2_SCALE);
+	b2FixtureDef FixtureDef;
+	FixtureDef.density = 1.0f;
+	FixtureDef.shape = &Shape;
+	// the boxes of other teams are in other worlds on the server, they
+	// only collide with the map here
+	if(pKeyframe->m_Flags & BOX2DBODYFLAG_OTHERTEAM)
+	{
+		FixtureDef.filter.categoryBits = COLLISION_OTHERTEAM;
+		FixtureDef.filter.maskBits = COLLISION_MAP;
+	}
+	else
+		FixtureDef.filter.categoryBits = COLLISION_TEAM;
+	pBody->CreateFixture(&FixtureDef);
+	return pBody;
+}
+
+void CBox2DPredictionWorld::ApplyKeyframe(CBody *pBody)
+{
+	const CNetObj_Box2DBody *pKeyframe = &pBody->m_Keyframe;
+	bool Asleep = pKeyframe->m_Flags & (BOX2DBODYFLAG_STATIC | BOX2DBODYFLAG_ASLEEP);
+
+	// keyframes of bodies that just came into view can be old
+	int Ticks = maximum(m_Tick - pKeyframe->m_Tick, 0);
+	bool Falls = !Asleep && !(pKeyframe->m_Flags & BOX2DBODYFLAG_KINEMATIC);
+	b2Vec2 Gravity = Falls ? m_pWorld->GetGravity() : b2Vec2(0.0f, 0.0f);
+	vec2 TickGravity = vec2(Gravity.x, Gravity.y) * (B2_SCALE * m_TickTime * m_TickTime);
+	vec2 Pos;
+	float Angle;
+	ExtrapolateBox2DBody(pKeyframe, Ticks, TickGravity, &Pos, &Angle);
+
+	b2Body *pB2Body = pBody->m_pBody;
+	pB2Body->SetTransform(b2Vec2(Pos.x / B2_SCALE, Pos.y / B2_SCALE), Angle);
+	if(pB2Body->GetType() == b2_staticBody)
+		return;
+	vec2 Vel = vec2(pKeyframe->m_VelX, pKeyframe->m_VelY) / 256.0f + TickGravity * (float)Ticks;
+	pB2Body->SetLinearVelocity(b2Vec2(Vel.x / (B2_SCALE * m_TickTime), Vel.y / (B2_SCALE * m_TickTime)));
+	pB2Body->SetAngularVelocity(pKeyframe->m_AngularVel / 65536.0f * 2 * pi / m_TickTime);
+	pB2Body->SetAwake(!Asleep);
+}
+
+void CBox2DPredictionWorld::OnNewSnapshot(IClient *pClient, int Tick)
+{
+	if(!m_pWorld)
+		return;
+
+	const CNetObj_Box2DWorld *pWorldInfo = (const CNetObj_Box2DWorld *)pClient->SnapFindItem(IClient::SNAP_CURRENT, NETOBJTYPE_BOX2DWORLD, 0);
+	// no box2d server, or the demo player jumped back
+	if(!pWorldInfo || Tick < m_Tick)
+	{
+		Clear();
+		if(!pWorldInfo)
+			return;
+	}
+	m_TickTime = maximum(pWorldInfo->m_TickTime, 1) / 1000000.0f;
+	m_pWorld->SetGravity(b2Vec2(pWorldInfo->m_GravityX / 1000.0f, pWorldInfo->m_GravityY / 1000.0f));
+
+	for(auto &Body : m_Bodies)
+	{
+		Body.second.m_PrevPos = Body.second.m_Pos;
+		Body.second.m_PrevAngle = Body.second.m_Angle;
+		Body.second.m_Seen = false;
+	}
+	int Ticks = m_Tick < 0 ? 0 : Tick - m_Tick;
+	if(Ticks <= MAX_CATCHUP_TICKS)
+	{
+		for(int i = 0; i < Ticks; i++)
+			m_pWorld->Step(m_TickTime, 8, 3);
+	}
+	bool Skipped = Ticks > MAX_CATCHUP_TICKS;
+	m_Tick = Tick;
+
+	int Num = pClient->SnapNumItems(IClient::SNAP_CURRENT);
+	for(int i = 0; i < Num; i++)
+	{
+		IClient::CSnapItem Item;
+		const void *pData = pClient->SnapGetItem(IClient::SNAP_CURRENT, i, &Item);
+		if(Item.m_Type != NETOBJTYPE_BOX2DBODY)
+			continue;
+		const CNetObj_Box2DBody *pKeyframe = (const CNetObj_Box2DBody *)pData;
+		const CNetObj_Box2DShape *pShape = (const CNetObj_Box2DShape *)pClient->SnapFindItem(IClient::SNAP_CURRENT, NETOBJTYPE_BOX2DSHAPE, pKeyframe->m_Shape);
+		if(!pShape)
+			continue;
+		ivec2 Size(maximum(pShape->m_Width, 1), maximum(pShape->m_Height, 1));
+
+		auto It = m_Bodies.find(Item.m_ID);
+		if(It != m_Bodies.end() && (It->second.m_Size != Size || ((It->second.m_Keyframe.m_Flags ^ pKeyframe->m_Flags) & (BOX2DBODYFLAG_STATIC | BOX2DBODYFLAG_KINEMATIC | BOX2DBODYFLAG_OTHERTEAM))))
+		{
+			// the server reused the ID for another box
+			m_pWorld->DestroyBody(It->second.m_pBody);
+			m_Bodies.erase(It);
+			It = m_Bodies.end();
+		}
+
+		bool New = It == m_Bodies.end();
+		CBody &Body = m_Bodies[Item.m_ID];
+		if(New)
+		{
+			Body.m_pBody = CreateBody(pKeyframe, Size);
+			Body.m_Size = Size;
+		}
+		if(New || Skipped || mem_comp(&Body.m_Keyframe, pKeyframe, sizeof(*pKeyframe)) != 0)
+		{
+			Body.m_Keyframe = *pKeyframe;
+			ApplyKeyframe(&Body);
+		}
+		Body.m_Seen = true;
+
+		Body.m_Pos = vec2(Body.m_pBody->GetPosition().x, Body.m_pBody->GetPosition().y) * B2_SCALE;
+		Body.m_Angle = Body.m_pBody->GetAngle();
+		if(New)
+		{
+			Body.m_PrevPos = Body.m_Pos;
+			Body.m_PrevAngle = Body.m_Angle;
+		}
+	}
+
+	for(auto It = m_Bodies.begin(); It != m_Bodies.end();)
+	{
+		if(It->second.m_Seen)
+		{
+			++It;
+			continue;
+		}
+		m_pWorld->DestroyBody(It->second.m_pBody);
+		It = m_Bodies.erase(It);
+	}
+}
+
+bool CBox2DPredictionWorld::GetTransform(int ID, float IntraTick, vec2 *pPos, float *pAngle) const
+{
+	auto It = m_Bodies.find(ID);
+	if(It == m_Bodies.end())
+		return false;
+	const CBody &Body = It->second;
+	*pPos = mix(Body.m_PrevPos, Body.m_Pos, IntraTick);
+	// keyframes wrap the angle around at a full turn, turn the short way
+	float AngleDiff = remainderf(Body.m_Angle - Body.m_PrevAngle, 2 * pi);
+	*pAngle = Body.m_PrevAngle + AngleDiff * IntraTick;
+	return true;
+}
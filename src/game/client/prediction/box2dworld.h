@@ -0,0 +1,75 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_CLIENT_PREDICTION_BOX2DWORLD_H
+#define GAME_CLIENT_PREDICTION_BOX2DWORLD_H
+
+#include <base/vmath.h>
+
+#include <game/generated/protocol.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+class b2Body;
+class b2World;
+class CCollision;
+class CLayers;
+class IClient;
+
+/*
+	Extrapolates the Box2DBody items of a ddnet-box2d server in a local
+	box2d world with the colliders of the map. The server only sends a new
+	keyframe of a body once this extrapolation is off by too much, and
+	none while it sleeps, the local world fills in the ticks in between.
+*/
+class CBox2DPredictionWorld
+{
+	enum
+	{
+		// a longer gap between two snapshots isn't worth stepping through,
+		// the bodies are moved to their extrapolated keyframes instead
+		MAX_CATCHUP_TICKS = 10,
+
+		// the fixture categories, the map keeps box2d's default one
+		COLLISION_MAP = 0x0001,
+		COLLISION_TEAM = 0x0002,
+		COLLISION_OTHERTEAM = 0x0004,
+	};
+
+	struct CBody
+	{
+		b2Body *m_pBody;
+		CNetObj_Box2DBody m_Keyframe;
+		ivec2 m_Size;
+		// before and after the last tick, for rendering in between
+		vec2 m_PrevPos;
+		float m_PrevAngle;
+		vec2 m_Pos;
+		float m_Angle;
+		bool m_Seen;
+	};
+
+	std::unique_ptr<b2World> m_pWorld;
+	std::map<int, CBody> m_Bodies; // by snap item ID
+	int m_Tick;
+	float m_TickTime;
+
+	b2Body *CreateBody(const CNetObj_Box2DBody *pKeyframe, ivec2 Size);
+	void ApplyKeyframe(CBody *pBody);
+
+public:
+	CBox2DPredictionWorld();
+	~CBox2DPredictionWorld();
+
+	// builds the colliders of a newly loaded map
+	void Init(const CLayers *pLayers, const CCollision *pCollision);
+	void Clear();
+
+	// advances the world to the tick of the current snapshot and takes the
+	// new keyframes from it
+	void OnNewSnapshot(IClient *pClient, int Tick);
+	bool GetTransform(int ID, float IntraTick, vec2 *pPos, float *pAngle) const;
+};
+
+#endif
@@ -0,0 +1,164 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_contacts.h"
+
+#include <game/box2d_keyframe.h>
+
+#include <algorithm>
+#include <functional>
+
+static bool IsIgnored(b2Contact *pContact)
+{
+	// explosion particles are in a negative group, see CBox2DExplosions
+	b2Fixture *pFixtureA = pContact->GetFixtureA();
+	b2Fixture *pFixtureB = pContact->GetFixtureB();
+	return pFixtureA->IsSensor() || pFixtureB->IsSensor() ||
+	       pFixtureA->GetFilterData().groupIndex < 0 || pFixtureB->GetFilterData().groupIndex < 0;
+}
+
+static bool PairLess(const CBox2DContactEvent &a, const CBox2DContactEvent &b)
+{
+	std::less<const b2Body *> Less;
+	if(a.m_pBodyA != b.m_pBodyA)
+		return Less(a.m_pBodyA, b.m_pBodyA);
+	return Less(a.m_pBodyB, b.m_pBodyB);
+}
+
+CBox2DContactListener::CBox2DContactListener()
+{
+	m_NumEvents = 0;
+	m_NumDropped = 0;
+	m_MinImpactSpeed = 0.0f;
+}
+
+void CBox2DContactListener::BeginContact(b2Contact *pContact)
+{
+	if(!IsIgnored(pContact))
+		Add(CBox2DContactEvent::BEGIN, pContact->GetFixtureA()->GetBody(), pContact->GetFixtureB()->GetBody());
+}
+
+void CBox2DContactListener::EndContact(b2Contact *pContact)
+{
+	if(!IsIgnored(pContact))
+		Add(CBox2DContactEvent::END, pContact->GetFixtureA()->GetBody(), pContact->GetFixtureB()->GetBody());
+}
+
+void CBox2DContactListener::PreSolve(b2Contact *pContact, const b2Manifold *pOldManifold)
+{
+	if(m_MinImpactSpeed <= 0.0f || IsIgnored(pContact))
+		return;
+
+	b2PointState aOldStates[b2_maxManifoldPoints];
+	b2PointState aStates[b2_maxManifoldPoints];
+	b2GetPointStates(aOldStates, aStates, pOldManifold, pContact->GetManifold());
+	b2WorldManifold WorldManifold;
+	pContact->GetWorldManifold(&WorldManifold);
+
+	b2Body *pBodyA = pContact->GetFixtureA()->GetBody();
+	b2Body *pBodyB = pContact->GetFixtureB()->GetBody();
+	float MaxSpeed = 0.0f;
+	int Point = -1;
+	b2Vec2 VelA(0.0f, 0.0f), VelB(0.0f, 0.0f);
+	for(int i = 0; i < pContact->GetManifold()->pointCount; i++)
+	{
+		// points that were already touching last step don't hit anything
+		if(aStates[i] != b2_addState)
+			continue;
+		b2Vec2 PointVelA = pBodyA->GetLinearVelocityFromWorldPoint(WorldManifold.points[i]);
+		b2Vec2 PointVelB = pBodyB->GetLinearVelocityFromWorldPoint(WorldManifold.points[i]);
+		// the normal points from A to B
+		float Speed = b2Dot(PointVelA - PointVelB, WorldManifold.normal) * B2_SCALE;
+		if(Speed > MaxSpeed)
+		{
+			MaxSpeed = Speed;
+			Point = i;
+			VelA = PointVelA;
+			VelB = PointVelB;
+		}
+	}
+
+	if(Point != -1 && MaxSpeed >= m_MinImpactSpeed)
+	{
+		b2Vec2 Pos = WorldManifold.points[Point];
+		b2Vec2 Normal = WorldManifold.normal;
+		Add(CBox2DContactEvent::IMPACT, pBodyA, pBodyB, vec2(Pos.x, Pos.y) * B2_SCALE, vec2(Normal.x, Normal.y),
+			vec2(VelA.x, VelA.y) * B2_SCALE, vec2(VelB.x, VelB.y) * B2_SCALE);
+	}
+}
+
+void CBox2DContactListener::Add(int Type, b2Body *pBodyA, b2Body *pBodyB, vec2 Pos, vec2 Normal, vec2 VelA, vec2 VelB)
+{
+	if(m_NumEvents == MAX_EVENTS)
+	{
+		m_NumDropped++;
+		return;
+	}
+	if(std::less<const b2Body *>()(pBodyB, pBodyA))
+	{
+		std::swap(pBodyA, pBodyB);
+		std::swap(VelA, VelB);
+		Normal = -Normal;
+	}
+
+	CBox2DContactEvent &Event = m_aEvents[m_NumEvents++];
+	Event.m_Type = Type;
+	Event.m_pBodyA = pBodyA;
+	Event.m_pBodyB = pBodyB;
+	Event.m_Pos = Pos;
+	Event.m_Normal = Normal;
+	Event.m_VelA = VelA;
+	Event.m_VelB = VelB;
+	Event.m_Speed = dot(VelA - VelB, Normal);
+}
+
+void CBox2DContactListener::Finish()
+{
+	// the order within a pair is kept, it's the order the events happened
+	std::stable_sort(m_aEvents, m_aEvents + m_NumEvents, PairLess);
+
+	int NumMerged = 0;
+	for(int First = 0; First < m_NumEvents;)
+	{
+		int NumBegins = 0;
+		int Impact = -1;
+		int Last = First;
+		for(; Last < m_NumEvents && !PairLess(m_aEvents[First], m_aEvents[Last]); Last++)
+		{
+			const CBox2DContactEvent &Event = m_aEvents[Last];
+			if(Event.m_Type == CBox2DContactEvent::BEGIN)
+				NumBegins++;
+			else if(Event.m_Type == CBox2DContactEvent::END)
+				NumBegins--;
+			else if(Impact == -1 || Event.m_Speed > m_aEvents[Impact].m_Speed)
+				Impact = Last;
+		}
+
+		// a touch only ever begins or ends once more than it did the other.
+		// the merged events overwrite the pair's own, so copy them first
+		CBox2DContactEvent Touch = m_aEvents[First];
+		Touch.m_Type = NumBegins > 0 ? CBox2DContactEvent::BEGIN : CBox2DContactEvent::END;
+		Touch.m_Pos = vec2(0, 0);
+		Touch.m_Normal = vec2(0, 0);
+		Touch.m_VelA = vec2(0, 0);
+		Touch.m_VelB = vec2(0, 0);
+		Touch.m_Speed = 0.0f;
+		CBox2DContactEvent Strongest = m_aEvents[Impact == -1 ? First : Impact];
+		if(NumBegins)
+			m_aEvents[NumMerged++] = Touch;
+		if(Impact != -1)
+			m_aEvents[NumMerged++] = Strongest;
+		First = Last;
+	}
+	m_NumEvents = NumMerged;
+}
+
+void CBox2DContactListener::RemoveBody(const b2Body *pBody)
+{
+	int NumKept = 0;
+	for(int i = 0; i < m_NumEvents; i++)
+	{
+		if(m_aEvents[i].m_pBodyA != pBody && m_aEvents[i].m_pBodyB != pBody)
+			m_aEvents[NumKept++] = m_aEvents[i];
+	}
+	m_NumEvents = NumKept;
+}
@@ -0,0 +1,84 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_CONTACTS_H
+#define GAME_SERVER_BOX2D_CONTACTS_H
+
+#include <base/vmath.h>
+
+#include <box2d/box2d.h>
+
+struct CBox2DContactEvent
+{
+	enum
+	{
+		BEGIN = 0,
+		END,
+		IMPACT,
+	};
+
+	int m_Type;
+	// ordered by address, so every pair has one key
+	b2Body *m_pBodyA;
+	b2Body *m_pBodyB;
+	// impacts only, in game units
+	vec2 m_Pos;
+	vec2 m_Normal; // from A to B
+	vec2 m_VelA; // per second, of the bodies at the point
+	vec2 m_VelB;
+	float m_Speed; // per second, along the normal
+};
+
+/*
+	Records the contacts of a world while it steps, possibly on a job
+	thread, for the game to handle them all at once after Sync(). Besides
+	touches beginning and ending, there's an impact whenever a new contact
+	point appears with at least the minimum approach speed, so bodies
+	resting on each other don't cause any events. Contacts of explosion
+	particles and sensors are ignored.
+
+	Finish() merges the events of a tick per pair of bodies: a begin or an
+	end only if the pair started or stopped touching over the whole tick,
+	and only the strongest impact.
+*/
+class CBox2DContactListener : public b2ContactListener
+{
+public:
+	enum
+	{
+		MAX_EVENTS = 1024,
+	};
+
+private:
+	CBox2DContactEvent m_aEvents[MAX_EVENTS];
+	int m_NumEvents;
+	int m_NumDropped;
+	float m_MinImpactSpeed;
+
+public:
+	CBox2DContactListener();
+
+	void BeginContact(b2Contact *pContact) override;
+	void EndContact(b2Contact *pContact) override;
+	void PreSolve(b2Contact *pContact, const b2Manifold *pOldManifold) override;
+
+	// in game units per second, 0 records no impacts at all
+	void SetMinImpactSpeed(float Speed) { m_MinImpactSpeed = Speed; }
+
+	// events beyond MAX_EVENTS per tick are dropped
+	void Add(int Type, b2Body *pBodyA, b2Body *pBodyB, vec2 Pos = vec2(0, 0), vec2 Normal = vec2(0, 0), vec2 VelA = vec2(0, 0), vec2 VelB = vec2(0, 0));
+	void Finish();
+	// drops the events of a body that is destroyed before they're handled
+	void RemoveBody(const b2Body *pBody);
+	void Clear()
+	{
+		m_NumEvents = 0;
+		m_NumDropped = 0;
+	}
+
+	int NumEvents() const { return m_NumEvents; }
+	const CBox2DContactEvent &Event(int Index) const { return m_aEvents[Index]; }
+	// since the last Clear()
+	int NumDropped() const { return m_NumDropped; }
+};
+
+#endif
@@ -0,0 +1,154 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_explosion.h"
+
+#include <base/system.h>
+
+#include <cmath>
+
+// the particles are very tiny circles that hit objects at high speeds
+static const float PARTICLE_RADIUS = 0.05f;
+static const float PARTICLE_DENSITY = 60.0f / CBox2DExplosions::NUM_RAYS;
+static const float PARTICLE_RESTITUTION = 0.99f;
+static const float PARTICLE_DAMPING = 10.0f;
+// particles slower than this are returned to the pool
+static const float PARTICLE_MIN_SPEED = 5.0f;
+
+static b2Vec2 RayDir(int i)
+{
+	float Angle = i / (float)CBox2DExplosions::NUM_RAYS * 2 * b2_pi;
+	return b2Vec2(sinf(Angle), cosf(Angle));
+}
+
+class CExplosionRay : public b2RayCastCallback
+{
+public:
+	b2Fixture *m_pFixture;
+	b2Vec2 m_Point;
+	float m_Fraction;
+
+	CExplosionRay() :
+		m_pFixture(0), m_Fraction(1.0f) {}
+
+	float ReportFixture(b2Fixture *pFixture, const b2Vec2 &Point, const b2Vec2 &Normal, float Fraction)
+	{
+		// other explosions' particles don't block the ray
+		if(pFixture->GetFilterData().groupIndex < 0 || pFixture->IsSensor())
+			return -1;
+		m_pFixture = pFixture;
+		m_Point = Point;
+		m_Fraction = Fraction;
+		return Fraction;
+	}
+};
+
+CBox2DExplosions::CBox2DExplosions(b2World *pWorld)
+{
+	m_pWorld = pWorld;
+	m_NextParticle = 0;
+	m_NumActive = 0;
+	m_vpParticles.reserve(MAX_PARTICLES);
+	m_vpFree.reserve(MAX_PARTICLES);
+}
+
+void CBox2DExplosions::Create(const b2Vec2 &Pos, float Strength, int Mode)
+{
+	float Speed = Strength * 30.0f;
+	if(Mode == MODE_PARTICLES)
+		CreateParticles(Pos, Speed);
+	else
+		CreateRays(Pos, Speed);
+}
+
+void CBox2DExplosions::CreateRays(const b2Vec2 &Pos, float Speed)
+{
+	// a damped particle slows down linearly over the distance it travels,
+	// so it would have come to a halt after Speed / Damping units
+	float Length = Speed / PARTICLE_DAMPING;
+	float ParticleMass = PARTICLE_DENSITY * b2_pi * PARTICLE_RADIUS * PARTICLE_RADIUS;
+
+	for(int i = 0; i < NUM_RAYS; i++)
+	{
+		b2Vec2 Dir = RayDir(i);
+		CExplosionRay Ray;
+		m_pWorld->RayCast(&Ray, Pos, Pos + Length * Dir);
+		if(!Ray.m_pFixture)
+			continue;
+
+		b2Body *pBody = Ray.m_pFixture->GetBody();
+		if(pBody->GetType() != b2_dynamicBody)
+			continue;
+
+		// the momentum the particle would have transferred when bouncing off
+		float HitSpeed = Speed * (1.0f - Ray.m_Fraction);
+		float Impulse = ParticleMass * HitSpeed * (1.0f + PARTICLE_RESTITUTION);
+		pBody->ApplyLinearImpulse(Impulse * Dir, Ray.m_Point, true);
+	}
+}
+
+void CBox2DExplosions::CreateParticles(const b2Vec2 &Pos, float Speed)
+{
+	for(int i = 0; i < NUM_RAYS; i++)
+	{
+		b2Body *pBody;
+		if(!m_vpFree.empty())
+		{
+			pBody = m_vpFree.back();
+			m_vpFree.pop_back();
+		}
+		else if((int)m_vpParticles.size() < MAX_PARTICLES)
+		{
+			b2BodyDef BodyDef;
+			BodyDef.type = b2_dynamicBody;
+			BodyDef.fixedRotation = true; // don't rotate
+			BodyDef.bullet = true; // avoid tunneling at high speed
+			BodyDef.linearDamping = PARTICLE_DAMPING; // slow down
+			BodyDef.gravityScale = 0; // don't be affected by gravity
+			BodyDef.enabled = false;
+			pBody = m_pWorld->CreateBody(&BodyDef);
+
+			b2CircleShape Circle;
+			Circle.m_radius = PARTICLE_RADIUS;
+
+			b2FixtureDef FixtureDef;
+			FixtureDef.shape = &Circle;
+			FixtureDef.density = PARTICLE_DENSITY;
+			FixtureDef.friction = 0;
+			FixtureDef.restitution = PARTICLE_RESTITUTION;
+			FixtureDef.filter.groupIndex = -1;
+			pBody->CreateFixture(&FixtureDef);
+
+			m_vpParticles.push_back(pBody);
+		}
+		else
+		{
+			// every particle is in flight, reuse them in the order they were created
+			pBody = m_vpParticles[m_NextParticle];
+			m_NextParticle = (m_NextParticle + 1) % MAX_PARTICLES;
+		}
+
+		if(!pBody->IsEnabled())
+		{
+			pBody->SetEnabled(true);
+			m_NumActive++;
+		}
+		pBody->SetTransform(Pos, 0);
+		pBody->SetLinearVelocity(Speed * RayDir(i));
+	}
+}
+
+void CBox2DExplosions::Tick()
+{
+	if(!m_NumActive)
+		return;
+
+	for(b2Body *pBody : m_vpParticles)
+	{
+		if(pBody->IsEnabled() && pBody->GetLinearVelocity().LengthSquared() < PARTICLE_MIN_SPEED * PARTICLE_MIN_SPEED)
+		{
+			pBody->SetEnabled(false);
+			m_vpFree.push_back(pBody);
+			m_NumActive--;
+		}
+	}
+}
@@ -0,0 +1,52 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_EXPLOSION_H
+#define GAME_SERVER_BOX2D_EXPLOSION_H
+
+#include <box2d/box2d.h>
+
+#include <vector>
+
+/*
+	Pushes box2d bodies away from explosions. Either by casting rays and
+	applying the impulse the particles would have transferred on impact
+	(MODE_RAYS), or by shooting tiny bullet bodies that are taken from a
+	pool and disabled again once they have slowed down (MODE_PARTICLES).
+	Neither allocates once the pool has been filled.
+*/
+class CBox2DExplosions
+{
+public:
+	enum
+	{
+		MODE_RAYS = 0,
+		MODE_PARTICLES,
+
+		NUM_RAYS = 32,
+		MAX_PARTICLES = NUM_RAYS * 32,
+	};
+
+private:
+	b2World *m_pWorld;
+
+	// the bodies are owned by the world and never destroyed by the pool
+	std::vector<b2Body *> m_vpParticles;
+	std::vector<b2Body *> m_vpFree;
+	int m_NextParticle;
+	int m_NumActive;
+
+	void CreateRays(const b2Vec2 &Pos, float Speed);
+	void CreateParticles(const b2Vec2 &Pos, float Speed);
+
+public:
+	CBox2DExplosions(b2World *pWorld);
+
+	// Pos in box2d units, Strength is the explosion strength tuning
+	void Create(const b2Vec2 &Pos, float Strength, int Mode);
+	// returns the particles that have slowed down to the pool
+	void Tick();
+
+	int NumActiveParticles() const { return m_NumActive; }
+};
+
+#endif
@@ -0,0 +1,52 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_governor.h"
+
+// level 0 is what box2d recommends
+static const int s_aVelocityIterations[CBox2DGovernor::MAX_LEVEL + 1] = {8, 6, 4, 3, 2, 2};
+static const int s_aPositionIterations[CBox2DGovernor::MAX_LEVEL + 1] = {3, 3, 2, 2, 1, 1};
+
+CBox2DGovernor::CBox2DGovernor()
+{
+	m_Level = 0;
+	m_TicksBelow = 0;
+}
+
+bool CBox2DGovernor::Update(float StepTime, float Budget)
+{
+	int OldLevel = m_Level;
+	if(Budget <= 0.0f)
+	{
+		m_Level = 0;
+		m_TicksBelow = 0;
+	}
+	else if(StepTime > Budget)
+	{
+		if(m_Level < MAX_LEVEL)
+			m_Level++;
+		m_TicksBelow = 0;
+	}
+	else if(StepTime < Budget / 2 && m_Level > 0)
+	{
+		if(++m_TicksBelow >= RECOVER_TICKS)
+		{
+			m_Level--;
+			m_TicksBelow = 0;
+		}
+	}
+	else
+	{
+		m_TicksBelow = 0;
+	}
+	return m_Level != OldLevel;
+}
+
+int CBox2DGovernor::VelocityIterations() const
+{
+	return s_aVelocityIterations[m_Level];
+}
+
+int CBox2DGovernor::PositionIterations() const
+{
+	return s_aPositionIterations[m_Level];
+}
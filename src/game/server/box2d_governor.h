@@ -0,0 +1,38 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_GOVERNOR_H
+#define GAME_SERVER_BOX2D_GOVERNOR_H
+
+/*
+	Trades box2d quality for tick stability. While the steps take longer
+	than the budget, every tick lowers the solver iterations by one level,
+	down to a last level that also puts the bodies far away from any tee
+	to sleep. After a second well below the budget, it goes back up one
+	level at a time.
+*/
+class CBox2DGovernor
+{
+	int m_Level;
+	int m_TicksBelow;
+
+public:
+	enum
+	{
+		MAX_LEVEL = 5,
+		// ticks below half the budget before going up a level
+		RECOVER_TICKS = 50,
+	};
+
+	CBox2DGovernor();
+
+	// StepTime and Budget in milliseconds, a Budget of 0 turns it off.
+	// returns true if the level changed
+	bool Update(float StepTime, float Budget);
+
+	int Level() const { return m_Level; }
+	int VelocityIterations() const;
+	int PositionIterations() const;
+	bool SleepFarBodies() const { return m_Level == MAX_LEVEL; }
+};
+
+#endif
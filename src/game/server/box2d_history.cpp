@@ -0,0 +1,134 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_history.h"
+
+#include <base/hash_ctxt.h>
+
+#include <box2d/box2d.h>
+
+#include <engine/shared/compression.h>
+#include <engine/shared/packer.h>
+
+static void AddInt(std::vector<unsigned char> &vData, int i)
+{
+	unsigned char aBuf[8];
+	unsigned char *pEnd = CVariableInt::Pack(aBuf, i);
+	vData.insert(vData.end(), aBuf, pEnd);
+}
+
+static void AddFloat(std::vector<unsigned char> &vData, float Value)
+{
+	AddInt(vData, Box2DFloatBits(Value));
+}
+
+void PackBox2DHistoryState(const CBox2DWorldState &State, std::vector<unsigned char> &vData)
+{
+	AddInt(vData, State.m_vBodies.size());
+	AddInt(vData, State.m_vJoints.size());
+
+	for(const CBox2DBodyState &Body : State.m_vBodies)
+	{
+		AddInt(vData, Body.m_Type);
+		AddFloat(vData, Body.m_Pos.x);
+		AddFloat(vData, Body.m_Pos.y);
+		AddFloat(vData, Body.m_Angle);
+		AddFloat(vData, Body.m_Vel.x);
+		AddFloat(vData, Body.m_Vel.y);
+		AddFloat(vData, Body.m_AngularVel);
+		AddInt(vData, Body.m_Size.x);
+		AddInt(vData, Body.m_Size.y);
+		AddFloat(vData, Body.m_Density);
+		AddFloat(vData, Body.m_Friction);
+	}
+
+	for(const CBox2DJointState &Joint : State.m_vJoints)
+	{
+		AddInt(vData, Joint.m_Type);
+		AddInt(vData, Joint.m_BodyA);
+		AddInt(vData, Joint.m_BodyB);
+		AddInt(vData, Joint.m_CollideConnected);
+		AddFloat(vData, Joint.m_AnchorA.x);
+		AddFloat(vData, Joint.m_AnchorA.y);
+		AddFloat(vData, Joint.m_AnchorB.x);
+		AddFloat(vData, Joint.m_AnchorB.y);
+		AddFloat(vData, Joint.m_ReferenceAngle);
+		AddFloat(vData, Joint.m_Length);
+	}
+}
+
+bool UnpackBox2DHistoryState(CBox2DWorldState *pState, const unsigned char *pData, int Size)
+{
+	pState->Clear();
+
+	CUnpacker Unpacker;
+	Unpacker.Reset(pData, Size);
+	int NumBodies = Unpacker.GetInt();
+	int NumJoints = Unpacker.GetInt();
+	// every body and every joint takes at least 10 bytes
+	if(Unpacker.Error() || NumBodies < 0 || NumJoints < 0 || NumBodies > Size / 10 || NumJoints > Size / 10)
+		return false;
+
+	bool Valid = true;
+	auto GetFloat = [&]() { return Box2DBitsFloat(Unpacker.GetInt()); };
+	pState->m_vBodies.resize(NumBodies);
+	for(CBox2DBodyState &Body : pState->m_vBodies)
+	{
+		Body.m_Type = Unpacker.GetInt();
+		Body.m_Pos.x = GetFloat();
+		Body.m_Pos.y = GetFloat();
+		Body.m_Angle = GetFloat();
+		Body.m_Vel.x = GetFloat();
+		Body.m_Vel.y = GetFloat();
+		Body.m_AngularVel = GetFloat();
+		Body.m_Size.x = Unpacker.GetInt();
+		Body.m_Size.y = Unpacker.GetInt();
+		Body.m_Density = GetFloat();
+		Body.m_Friction = GetFloat();
+		Valid = Valid && Body.m_Type >= b2_staticBody && Body.m_Type <= b2_dynamicBody && Body.m_Size.x > 0 && Body.m_Size.y > 0;
+	}
+
+	pState->m_vJoints.resize(NumJoints);
+	for(CBox2DJointState &Joint : pState->m_vJoints)
+	{
+		Joint.m_Type = Unpacker.GetInt();
+		Joint.m_BodyA = Unpacker.GetInt();
+		Joint.m_BodyB = Unpacker.GetInt();
+		Joint.m_CollideConnected = Unpacker.GetInt();
+		Joint.m_AnchorA.x = GetFloat();
+		Joint.m_AnchorA.y = GetFloat();
+		Joint.m_AnchorB.x = GetFloat();
+		Joint.m_AnchorB.y = GetFloat();
+		Joint.m_ReferenceAngle = GetFloat();
+		Joint.m_Length = GetFloat();
+		Valid = Valid && Joint.m_BodyA >= 0 && Joint.m_BodyA < NumBodies && Joint.m_BodyB >= 0 && Joint.m_BodyB < NumBodies;
+	}
+
+	// CUnpacker reports reading past the end as an error
+	if(!Valid || Unpacker.Error() || Unpacker.GetRaw(0) != pData + Size)
+	{
+		pState->Clear();
+		return false;
+	}
+	return true;
+}
+
+unsigned Box2DWorldChecksum(const b2World *pWorld)
+{
+	SHA256_CTX Ctx;
+	sha256_init(&Ctx);
+	for(const b2Body *pBody = pWorld->GetBodyList(); pBody; pBody = pBody->GetNext())
+	{
+		float aValues[] = {
+			pBody->GetPosition().x,
+			pBody->GetPosition().y,
+			pBody->GetAngle(),
+			pBody->GetLinearVelocity().x,
+			pBody->GetLinearVelocity().y,
+			pBody->GetAngularVelocity(),
+			pBody->IsAwake() ? 1.0f : 0.0f,
+		};
+		sha256_update(&Ctx, aValues, sizeof(aValues));
+	}
+	SHA256_DIGEST Digest = sha256_finish(&Ctx);
+	return ((unsigned)Digest.data[0] << 24) | (Digest.data[1] << 16) | (Digest.data[2] << 8) | Digest.data[3];
+}
@@ -0,0 +1,41 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_HISTORY_H
+#define GAME_SERVER_BOX2D_HISTORY_H
+
+#include <base/system.h>
+
+#include "box2d_save.h"
+
+#include <vector>
+
+class b2World;
+
+// the box2d chunks of the teehistorian store floats bit for bit, a replay
+// only stays in sync if it gets exactly what the server had
+inline int Box2DFloatBits(float Value)
+{
+	int Bits;
+	mem_copy(&Bits, &Value, sizeof(Bits));
+	return Bits;
+}
+
+inline float Box2DBitsFloat(int Bits)
+{
+	float Value;
+	mem_copy(&Value, &Bits, sizeof(Value));
+	return Value;
+}
+
+// like CBox2DWorldState::Pack(), but without rounding anything, so a
+// replay creates the very same bodies
+void PackBox2DHistoryState(const CBox2DWorldState &State, std::vector<unsigned char> &vData);
+// returns false and leaves the state empty if the data is invalid
+bool UnpackBox2DHistoryState(CBox2DWorldState *pState, const unsigned char *pData, int Size);
+
+// a hash of the position, angle, velocity and sleep state of every body
+// of the world, in the world's order. it's only comparable between builds
+// that simulate the same way, i.e. the same binary
+unsigned Box2DWorldChecksum(const b2World *pWorld);
+
+#endif
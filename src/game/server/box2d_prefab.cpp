@@ -0,0 +1,191 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_prefab.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <box2d/box2d.h>
+
+#include <engine/shared/json.h>
+
+static bool GetVec(const json_value &Value, vec2 *pVec)
+{
+	if(Value.type != json_array || json_array_length(&Value) != 2)
+		return false;
+	float aCoords[2];
+	for(int i = 0; i < 2; i++)
+	{
+		const json_value &Coord = Value[i];
+		if(Coord.type == json_integer)
+			aCoords[i] = Coord.u.integer;
+		else if(Coord.type == json_double)
+			aCoords[i] = Coord.u.dbl;
+		else
+			return false;
+	}
+	*pVec = vec2(aCoords[0], aCoords[1]);
+	return true;
+}
+
+static bool GetFloat(const json_value &Value, float Default, float *pFloat)
+{
+	if(Value.type == json_none)
+		*pFloat = Default;
+	else if(Value.type == json_integer)
+		*pFloat = Value.u.integer;
+	else if(Value.type == json_double)
+		*pFloat = Value.u.dbl;
+	else
+		return false;
+	return true;
+}
+
+CBox2DPrefab::CBox2DPrefab()
+{
+	m_Min = vec2(0, 0);
+	m_Max = vec2(0, 0);
+}
+
+bool CBox2DPrefab::FromJson(const char *pJson, int Length, char *pError, int ErrorSize)
+{
+	m_State.Clear();
+	m_Min = vec2(0, 0);
+	m_Max = vec2(0, 0);
+
+	json_settings Settings = {};
+	char aJsonError[json_error_max];
+	json_value *pRoot = json_parse_ex(&Settings, pJson, Length, aJsonError);
+	if(!pRoot)
+	{
+		str_copy(pError, aJsonError, ErrorSize);
+		return false;
+	}
+
+	bool Error = false;
+	const json_value &Boxes = (*pRoot)["boxes"];
+	if(Boxes.type != json_array || !json_array_length(&Boxes))
+	{
+		str_copy(pError, "no boxes", ErrorSize);
+		Error = true;
+	}
+	else if(json_array_length(&Boxes) > MAX_BOXES)
+	{
+		str_format(pError, ErrorSize, "more than %d boxes", (int)MAX_BOXES);
+		Error = true;
+	}
+	for(int i = 0; !Error && i < json_array_length(&Boxes); i++)
+	{
+		const json_value &Box = Boxes[i];
+		CBox2DBodyState Body = {};
+		vec2 Size;
+		float Angle;
+		const json_value &Static = Box["static"];
+		Error = !GetVec(Box["pos"], &Body.m_Pos) || !GetVec(Box["size"], &Size) || Size.x < 1 || Size.y < 1 ||
+			!GetFloat(Box["angle"], 0.0f, &Angle) || !GetFloat(Box["density"], 1.0f, &Body.m_Density) ||
+			!GetFloat(Box["friction"], 0.2f, &Body.m_Friction) || (Static.type != json_none && Static.type != json_boolean);
+		if(Error)
+		{
+			str_format(pError, ErrorSize, "invalid box %d", i);
+			break;
+		}
+		Body.m_Type = Static.type == json_boolean && json_boolean_get(&Static) ? b2_staticBody : b2_dynamicBody;
+		Body.m_Angle = Angle / 180.0f * pi;
+		Body.m_Size = ivec2(round_to_int(Size.x), round_to_int(Size.y));
+		m_State.m_vBodies.push_back(Body);
+
+		vec2 Min = Body.m_Pos - Size / 2;
+		vec2 Max = Body.m_Pos + Size / 2;
+		m_Min = i == 0 ? Min : vec2(minimum(m_Min.x, Min.x), minimum(m_Min.y, Min.y));
+		m_Max = i == 0 ? Max : vec2(maximum(m_Max.x, Max.x), maximum(m_Max.y, Max.y));
+	}
+
+	const json_value &Joints = (*pRoot)["joints"];
+	if(!Error && Joints.type != json_none && Joints.type != json_array)
+	{
+		str_copy(pError, "invalid joints", ErrorSize);
+		Error = true;
+	}
+	int NumBodies = m_State.m_vBodies.size();
+	for(int i = 0; !Error && Joints.type == json_array && i < json_array_length(&Joints); i++)
+	{
+		const json_value &JointValue = Joints[i];
+		const json_value &Type = JointValue["type"];
+		const json_value &BodyA = JointValue["a"];
+		const json_value &BodyB = JointValue["b"];
+		const json_value &Collide = JointValue["collide"];
+		CBox2DJointState Joint = {};
+		float ReferenceAngle;
+		Error = Type.type != json_string || BodyA.type != json_integer || BodyB.type != json_integer ||
+			json_int_get(&BodyA) < 0 || json_int_get(&BodyA) >= NumBodies || json_int_get(&BodyB) < 0 || json_int_get(&BodyB) >= NumBodies ||
+			(Collide.type != json_none && Collide.type != json_boolean) || !GetFloat(JointValue["reference_angle"], 0.0f, &ReferenceAngle);
+		if(!Error)
+		{
+			if(str_comp(json_string_get(&Type), "distance") == 0)
+				Joint.m_Type = e_distanceJoint;
+			else if(str_comp(json_string_get(&Type), "revolute") == 0)
+				Joint.m_Type = e_revoluteJoint;
+			else if(str_comp(json_string_get(&Type), "weld") == 0)
+				Joint.m_Type = e_weldJoint;
+			else
+				Error = true;
+		}
+		Joint.m_AnchorA = vec2(0, 0);
+		Joint.m_AnchorB = vec2(0, 0);
+		if(!Error && JointValue["anchor_a"].type != json_none)
+			Error = !GetVec(JointValue["anchor_a"], &Joint.m_AnchorA);
+		if(!Error && JointValue["anchor_b"].type != json_none)
+			Error = !GetVec(JointValue["anchor_b"], &Joint.m_AnchorB);
+		if(Error)
+		{
+			str_format(pError, ErrorSize, "invalid joint %d", i);
+			break;
+		}
+		Joint.m_BodyA = json_int_get(&BodyA);
+		Joint.m_BodyB = json_int_get(&BodyB);
+		Joint.m_CollideConnected = Collide.type == json_boolean && json_boolean_get(&Collide);
+		Joint.m_ReferenceAngle = ReferenceAngle / 180.0f * pi;
+
+		// the anchors in the world, with the boxes at their prefab angles
+		const CBox2DBodyState &A = m_State.m_vBodies[Joint.m_BodyA];
+		const CBox2DBodyState &B = m_State.m_vBodies[Joint.m_BodyB];
+		vec2 AnchorA = A.m_Pos + rotate(Joint.m_AnchorA, A.m_Angle / pi * 180.0f);
+		vec2 AnchorB = B.m_Pos + rotate(Joint.m_AnchorB, B.m_Angle / pi * 180.0f);
+		if(!GetFloat(JointValue["length"], distance(AnchorA, AnchorB), &Joint.m_Length))
+		{
+			str_format(pError, ErrorSize, "invalid joint %d", i);
+			Error = true;
+			break;
+		}
+		m_State.m_vJoints.push_back(Joint);
+	}
+
+	json_value_free(pRoot);
+	if(Error)
+		m_State.Clear();
+	return !Error;
+}
+
+void CBox2DPrefab::Instantiate(CBox2DWorldState *pState, vec2 Pos, int Columns, int Rows, float Spacing) const
+{
+	vec2 Step = Size() + vec2(Spacing, Spacing);
+	for(int y = 0; y < Rows; y++)
+	{
+		for(int x = 0; x < Columns; x++)
+		{
+			vec2 Offset = Pos + vec2(x * Step.x, -y * Step.y);
+			int FirstBody = pState->m_vBodies.size();
+			for(const CBox2DBodyState &Body : m_State.m_vBodies)
+			{
+				pState->m_vBodies.push_back(Body);
+				pState->m_vBodies.back().m_Pos += Offset;
+			}
+			for(const CBox2DJointState &Joint : m_State.m_vJoints)
+			{
+				pState->m_vJoints.push_back(Joint);
+				pState->m_vJoints.back().m_BodyA += FirstBody;
+				pState->m_vJoints.back().m_BodyB += FirstBody;
+			}
+		}
+	}
+}
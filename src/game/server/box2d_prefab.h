@@ -0,0 +1,55 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_PREFAB_H
+#define GAME_SERVER_BOX2D_PREFAB_H
+
+#include <base/vmath.h>
+
+#include "box2d_save.h"
+
+/*
+	A template of boxes and the joints between them, read from a json file:
+
+	{
+		"boxes": [
+			{"pos": [0, 0], "size": [32, 64], "angle": 0, "density": 1, "friction": 0.2, "static": false}
+		],
+		"joints": [
+			{"type": "revolute", "a": 0, "b": 1, "anchor_a": [0, -32], "anchor_b": [0, 32], "collide": false}
+		]
+	}
+
+	Positions and anchors are in game units, relative to the prefab and the
+	boxes, angles in degrees. Only "pos" and "size" of a box and "type", "a"
+	and "b" of a joint are required. Joints are "distance" (with an optional
+	"length", by default the distance of the anchors), "revolute" or "weld".
+*/
+class CBox2DPrefab
+{
+	CBox2DWorldState m_State;
+	vec2 m_Min;
+	vec2 m_Max;
+
+public:
+	enum
+	{
+		// the most boxes of a prefab and of all copies one b2_prefab
+		// creates, even without b2_max_boxes
+		MAX_BOXES = 1000,
+	};
+
+	CBox2DPrefab();
+
+	// returns false and writes the reason to pError if the file is invalid
+	bool FromJson(const char *pJson, int Length, char *pError, int ErrorSize);
+
+	const CBox2DWorldState &State() const { return m_State; }
+	// the bounding box of the boxes, ignoring their angles
+	vec2 Size() const { return m_Max - m_Min; }
+
+	// appends Columns * Rows copies to pState, the first one at Pos, the
+	// others right of and above it with Spacing units between them
+	void Instantiate(CBox2DWorldState *pState, vec2 Pos, int Columns, int Rows, float Spacing) const;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_profile.h"
+
+#include <base/math.h>
+
+#include <algorithm>
+
+static const char *s_apNames[CBox2DProfileSample::NUM_VALUES] = {
+	"step",
+	"collide",
+	"solve",
+	"broadphase",
+	"solve_toi",
+	"game_tick",
+	"bodies",
+	"awake_bodies",
+	"contacts",
+};
+
+const char *CBox2DProfileSample::Name(int Value)
+{
+	return s_apNames[Value];
+}
+
+CBox2DProfile::CBox2DProfile(int Capacity) :
+	m_vSamples(Capacity)
+{
+	Clear();
+}
+
+void CBox2DProfile::Add(const CBox2DProfileSample &Sample)
+{
+	m_vSamples[m_Next] = Sample;
+	m_Next = (m_Next + 1) % m_vSamples.size();
+	m_NumSamples = minimum(m_NumSamples + 1, (int)m_vSamples.size());
+}
+
+void CBox2DProfile::Clear()
+{
+	m_Next = 0;
+	m_NumSamples = 0;
+}
+
+float CBox2DProfile::Percentile(int Value, float Fraction) const
+{
+	if(!m_NumSamples)
+		return 0.0f;
+
+	// the order of the ring buffer doesn't matter here
+	std::vector<float> vValues(m_NumSamples);
+	for(int i = 0; i < m_NumSamples; i++)
+		vValues[i] = m_vSamples[i].m_aValues[Value];
+	int Index = clamp(round_to_int(Fraction * (m_NumSamples - 1)), 0, m_NumSamples - 1);
+	std::nth_element(vValues.begin(), vValues.begin() + Index, vValues.end());
+	return vValues[Index];
+}
+
+void CBox2DProfile::WriteCsv(IOHANDLE File) const
+{
+	char aBuf[256];
+	str_copy(aBuf, "tick", sizeof(aBuf));
+	for(int i = 0; i < CBox2DProfileSample::NUM_VALUES; i++)
+	{
+		str_append(aBuf, ",", sizeof(aBuf));
+		str_append(aBuf, CBox2DProfileSample::Name(i), sizeof(aBuf));
+	}
+	io_write(File, aBuf, str_length(aBuf));
+	io_write_newline(File);
+
+	int First = (m_Next - m_NumSamples + m_vSamples.size()) % m_vSamples.size();
+	for(int n = 0; n < m_NumSamples; n++)
+	{
+		const CBox2DProfileSample &Sample = m_vSamples[(First + n) % m_vSamples.size()];
+		str_format(aBuf, sizeof(aBuf), "%d", Sample.m_Tick);
+		for(int i = 0; i < CBox2DProfileSample::NUM_VALUES; i++)
+		{
+			char aValue[32];
+			str_format(aValue, sizeof(aValue), ",%g", Sample.m_aValues[i]);
+			str_append(aBuf, aValue, sizeof(aBuf));
+		}
+		io_write(File, aBuf, str_length(aBuf));
+		io_write_newline(File);
+	}
+}
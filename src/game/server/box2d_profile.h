@@ -0,0 +1,54 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_PROFILE_H
+#define GAME_SERVER_BOX2D_PROFILE_H
+
+#include <base/system.h>
+
+#include <vector>
+
+// one tick of box2d cost, summed over all worlds. times are in milliseconds
+class CBox2DProfileSample
+{
+public:
+	enum
+	{
+		STEP = 0,
+		COLLIDE,
+		SOLVE,
+		BROADPHASE,
+		SOLVE_TOI,
+		GAME_TICK, // CGameContext::OnTick, to tell physics spikes from others
+		BODIES,
+		AWAKE_BODIES,
+		CONTACTS,
+		NUM_VALUES
+	};
+
+	int m_Tick;
+	float m_aValues[NUM_VALUES];
+
+	static const char *Name(int Value);
+};
+
+// the samples of the last ticks, for percentiles over a rolling window
+class CBox2DProfile
+{
+	std::vector<CBox2DProfileSample> m_vSamples;
+	int m_Next;
+	int m_NumSamples;
+
+public:
+	CBox2DProfile(int Capacity);
+
+	void Add(const CBox2DProfileSample &Sample);
+	void Clear();
+	int NumSamples() const { return m_NumSamples; }
+
+	// Fraction 0.5 is the median, 1 the maximum
+	float Percentile(int Value, float Fraction) const;
+	// oldest sample first, with a header line
+	void WriteCsv(IOHANDLE File) const;
+};
+
+#endif
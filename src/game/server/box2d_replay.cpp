@@ -0,0 +1,329 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_replay.h"
+#include "box2d_history.h"
+#include "teehistorian.h"
+
+#include <base/system.h>
+
+#include <engine/shared/packer.h>
+#include <engine/shared/teehistorian_ex.h>
+
+#include <game/generated/protocol.h>
+
+// the server's gravity, see CGameContext::B2World()
+static const b2Vec2 s_Gravity(0.f, 9.81f);
+
+CBox2DReplay::CBox2DReplay(const std::vector<CTileOutline> &vMapOutlines, const std::vector<CQuadPolygon> &vMapQuads) :
+	m_vMapOutlines(vMapOutlines), m_vMapQuads(vMapQuads)
+{
+	for(auto &pWorld : m_apWorlds)
+		pWorld = 0;
+	for(auto &Target : m_aTeeTargets)
+		Target = vec2(0.0f, 0.0f);
+	m_NumChunks = 0;
+	m_NumChecksums = 0;
+	m_DivergentTick = -1;
+	m_DivergentTeam = -1;
+	m_RecordedChecksum = 0;
+	m_ReplayedChecksum = 0;
+	m_aError[0] = 0;
+}
+
+CBox2DReplay::~CBox2DReplay()
+{
+	for(auto &pWorld : m_apWorlds)
+		delete pWorld;
+}
+
+CBox2DWorld *CBox2DReplay::World(int Team)
+{
+	return Team >= 0 && Team < MAX_CLIENTS + 1 ? m_apWorlds[Team] : 0;
+}
+
+b2Body *CBox2DReplay::Box(int Team, int ID)
+{
+	if(!World(Team))
+		return 0;
+	auto Box = m_aBoxes[Team].find(ID);
+	return Box != m_aBoxes[Team].end() ? Box->second : 0;
+}
+
+bool CBox2DReplay::Fail(const char *pError, int Tick)
+{
+	str_format(m_aError, sizeof(m_aError), "tick %d: %s", Tick, pError);
+	return false;
+}
+
+bool CBox2DReplay::OnChunk(CUuid Uuid, const unsigned char *pData, int Size, int Tick)
+{
+	int Type = g_UuidManager.LookupUuid(Uuid);
+	if(Type < TEEHISTORIAN_B2_WORLD_CREATE || Type > TEEHISTORIAN_B2_CHECKSUM)
+		return true;
+	m_NumChunks++;
+
+	CUnpacker Unpacker;
+	Unpacker.Reset(pData, Size);
+	auto GetFloat = [&]() { return Box2DBitsFloat(Unpacker.GetInt()); };
+
+	if(Type == TEEHISTORIAN_B2_WORLD_CREATE)
+	{
+		int Team = Unpacker.GetInt();
+		bool MapOutlines = Unpacker.GetInt();
+		bool MapQuads = Unpacker.GetInt();
+		if(Unpacker.Error() || Team < 0 || Team >= MAX_CLIENTS + 1 || m_apWorlds[Team])
+			return Fail("invalid world creation", Tick);
+		if((MapOutlines && m_vMapOutlines.empty()) || (MapQuads && m_vMapQuads.empty()))
+			return Fail("the world was created with parts of the map this map doesn't have", Tick);
+		m_apWorlds[Team] = new CBox2DWorld(s_Gravity);
+		if(MapOutlines)
+			CreateMapBody(m_apWorlds[Team], m_vMapOutlines);
+		if(MapQuads)
+			CreateQuadsBody(m_apWorlds[Team], m_vMapQuads);
+	}
+	else if(Type == TEEHISTORIAN_B2_WORLD_DESTROY)
+	{
+		int Team = Unpacker.GetInt();
+		CBox2DWorld *pWorld = World(Team);
+		if(Unpacker.Error() || !pWorld)
+			return Fail("invalid world destruction", Tick);
+		for(CBox2DTee &Tee : m_aTees)
+		{
+			if(Tee.World() == pWorld)
+				Tee.Destroy();
+		}
+		delete pWorld;
+		m_apWorlds[Team] = 0;
+		m_aBoxes[Team].clear();
+	}
+	else if(Type == TEEHISTORIAN_B2_BOXES)
+	{
+		int Team = Unpacker.GetInt();
+		int FirstID = Unpacker.GetInt();
+		CBox2DWorld *pWorld = World(Team);
+		const unsigned char *pState = Unpacker.GetRaw(0);
+		CBox2DWorldState State;
+		if(Unpacker.Error() || !pWorld || !UnpackBox2DHistoryState(&State, pState, pData + Size - pState))
+			return Fail("invalid boxes", Tick);
+		std::vector<b2Body *> vpBodies;
+		for(const CBox2DBodyState &Body : State.m_vBodies)
+		{
+			vpBodies.push_back(CreateBox2DBox(pWorld, Body, 0));
+			m_aBoxes[Team][FirstID++] = vpBodies.back();
+		}
+		CreateBox2DJoints(pWorld, State.m_vJoints, vpBodies);
+	}
+	else if(Type == TEEHISTORIAN_B2_BOX_DESTROY)
+	{
+		int Team = Unpacker.GetInt();
+		int ID = Unpacker.GetInt();
+		b2Body *pBody = Box(Team, ID);
+		if(Unpacker.Error() || !pBody)
+			return Fail("destroyed a box that doesn't exist", Tick);
+		m_apWorlds[Team]->DestroyBody(pBody);
+		m_aBoxes[Team].erase(ID);
+	}
+	else if(Type == TEEHISTORIAN_B2_TEE_CREATE)
+	{
+		int ClientID = Unpacker.GetInt();
+		int Team = Unpacker.GetInt();
+		float x = GetFloat();
+		float y = GetFloat();
+		CBox2DWorld *pWorld = World(Team);
+		if(Unpacker.Error() || !pWorld || ClientID < 0 || ClientID >= MAX_CLIENTS || m_aTees[ClientID].Exists())
+			return Fail("invalid tee creation", Tick);
+		m_aTees[ClientID].Create(pWorld, vec2(x, y));
+	}
+	else if(Type == TEEHISTORIAN_B2_TEE_DESTROY)
+	{
+		int ClientID = Unpacker.GetInt();
+		if(Unpacker.Error() || ClientID < 0 || ClientID >= MAX_CLIENTS)
+			return Fail("invalid tee destruction", Tick);
+		m_aTees[ClientID].Destroy();
+	}
+	else if(Type == TEEHISTORIAN_B2_TEE_HAMMER)
+	{
+		int ClientID = Unpacker.GetInt();
+		float DirX = GetFloat();
+		float DirY = GetFloat();
+		if(Unpacker.Error() || ClientID < 0 || ClientID >= MAX_CLIENTS || !m_aTees[ClientID].Exists())
+			return Fail("a tee without a body hammered", Tick);
+		m_aTees[ClientID].Hammer(vec2(DirX, DirY));
+	}
+	else if(Type == TEEHISTORIAN_B2_IMPULSE)
+	{
+		int Team = Unpacker.GetInt();
+		int ID = Unpacker.GetInt();
+		b2Vec2 Impulse;
+		Impulse.x = GetFloat();
+		Impulse.y = GetFloat();
+		b2Vec2 Point;
+		Point.x = GetFloat();
+		Point.y = GetFloat();
+		b2Body *pBody = Box(Team, ID);
+		if(Unpacker.Error() || !pBody)
+			return Fail("pushed a box that doesn't exist", Tick);
+		pBody->ApplyLinearImpulse(Impulse, Point, true);
+	}
+	else if(Type == TEEHISTORIAN_B2_EXPLOSION)
+	{
+		int Team = Unpacker.GetInt();
+		b2Vec2 Pos;
+		Pos.x = GetFloat();
+		Pos.y = GetFloat();
+		float Strength = GetFloat();
+		int Mode = Unpacker.GetInt();
+		CBox2DWorld *pWorld = World(Team);
+		if(Unpacker.Error() || !pWorld)
+			return Fail("invalid explosion", Tick);
+		pWorld->m_Explosions.Create(Pos, Strength, Mode);
+	}
+	else if(Type == TEEHISTORIAN_B2_SLEEP)
+	{
+		int Team = Unpacker.GetInt();
+		int ID = Unpacker.GetInt();
+		b2Body *pBody = Box(Team, ID);
+		if(Unpacker.Error() || !pBody)
+			return Fail("put a box to sleep that doesn't exist", Tick);
+		pBody->SetAwake(false);
+	}
+	else if(Type == TEEHISTORIAN_B2_STEP)
+	{
+		int Team = Unpacker.GetInt();
+		float DeltaTime = GetFloat();
+		float StepTime = GetFloat();
+		int MaxSubsteps = Unpacker.GetInt();
+		int VelocityIterations = Unpacker.GetInt();
+		int PositionIterations = Unpacker.GetInt();
+		CBox2DWorld *pWorld = World(Team);
+		if(Unpacker.Error() || !pWorld || !(StepTime > 0.0f) || MaxSubsteps < 1)
+			return Fail("invalid step", Tick);
+		// in the order CGameContext::TickB2Tees() moves them
+		float SteppedTime = pWorld->NumDueSubsteps(DeltaTime, StepTime, MaxSubsteps) * StepTime;
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(m_aTees[i].World() == pWorld)
+				m_aTees[i].Tick(m_aTeeTargets[i], SteppedTime, StepTime);
+		}
+		pWorld->m_Explosions.Tick();
+		pWorld->StartStep(DeltaTime, StepTime, MaxSubsteps, VelocityIterations, PositionIterations, 0);
+	}
+	else if(Type == TEEHISTORIAN_B2_CHECKSUM)
+	{
+		int Team = Unpacker.GetInt();
+		unsigned Checksum = Unpacker.GetInt();
+		CBox2DWorld *pWorld = World(Team);
+		if(Unpacker.Error() || !pWorld)
+			return Fail("checksum of a world that doesn't exist", Tick);
+		m_NumChecksums++;
+		unsigned Replayed = Box2DWorldChecksum(pWorld);
+		if(Replayed != Checksum)
+		{
+			m_DivergentTick = Tick;
+			m_DivergentTeam = Team;
+			m_RecordedChecksum = Checksum;
+			m_ReplayedChecksum = Replayed;
+			return Fail("the world diverged", Tick);
+		}
+	}
+	return true;
+}
+
+void CBox2DReplay::OnPlayer(int ClientID, int x, int y)
+{
+	m_aTeeTargets[ClientID] = vec2(x, y);
+}
+
+bool CBox2DReplay::Run(const unsigned char *pData, int Size)
+{
+	CUnpacker Unpacker;
+	Unpacker.Reset(pData, Size);
+	int Tick = 0;
+	int LastClientID = MAX_CLIENTS;
+	// the player records are differences to the last one
+	ivec2 aPlayerPos[MAX_CLIENTS];
+	for(auto &Pos : aPlayerPos)
+		Pos = ivec2(0, 0);
+	while(true)
+	{
+		int Chunk = Unpacker.GetInt();
+		if(Unpacker.Error())
+		{
+			dbg_msg("box2d_replay", "tick %d: the teehistorian ends without finishing", Tick);
+			return true;
+		}
+
+		if(Chunk >= 0 || Chunk == -TEEHISTORIAN_PLAYER_NEW || Chunk == -TEEHISTORIAN_PLAYER_OLD)
+		{
+			// player chunks come in ascending order, one that isn't
+			// starts the next tick
+			int ClientID = Chunk >= 0 ? Chunk : Unpacker.GetInt();
+			if(ClientID < 0 || ClientID >= MAX_CLIENTS)
+				return Fail("invalid player", Tick);
+			if(ClientID <= LastClientID)
+				Tick++;
+			LastClientID = ClientID;
+			if(Chunk != -TEEHISTORIAN_PLAYER_OLD)
+			{
+				ivec2 Pos(Unpacker.GetInt(), Unpacker.GetInt());
+				aPlayerPos[ClientID] = Chunk >= 0 ? aPlayerPos[ClientID] + Pos : Pos;
+				OnPlayer(ClientID, aPlayerPos[ClientID].x, aPlayerPos[ClientID].y);
+			}
+		}
+		else if(Chunk == -TEEHISTORIAN_FINISH)
+		{
+			return true;
+		}
+		else if(Chunk == -TEEHISTORIAN_TICK_SKIP)
+		{
+			Tick += Unpacker.GetInt() + 1;
+			LastClientID = -1;
+		}
+		else if(Chunk == -TEEHISTORIAN_INPUT_DIFF || Chunk == -TEEHISTORIAN_INPUT_NEW)
+		{
+			Unpacker.GetInt();
+			for(int i = 0; i < (int)(sizeof(CNetObj_PlayerInput) / sizeof(int)); i++)
+				Unpacker.GetInt();
+		}
+		else if(Chunk == -TEEHISTORIAN_MESSAGE)
+		{
+			Unpacker.GetInt();
+			Unpacker.GetRaw(Unpacker.GetInt());
+		}
+		else if(Chunk == -TEEHISTORIAN_JOIN)
+		{
+			Unpacker.GetInt();
+		}
+		else if(Chunk == -TEEHISTORIAN_DROP)
+		{
+			Unpacker.GetInt();
+			Unpacker.GetString(0);
+		}
+		else if(Chunk == -TEEHISTORIAN_CONSOLE_COMMAND)
+		{
+			Unpacker.GetInt();
+			Unpacker.GetInt();
+			Unpacker.GetString(0);
+			int NumArgs = Unpacker.GetInt();
+			for(int i = 0; i < NumArgs && !Unpacker.Error(); i++)
+				Unpacker.GetString(0);
+		}
+		else if(Chunk == -TEEHISTORIAN_EX)
+		{
+			const CUuid *pUuid = (const CUuid *)Unpacker.GetRaw(sizeof(CUuid));
+			int ExSize = Unpacker.GetInt();
+			const unsigned char *pExData = Unpacker.GetRaw(ExSize);
+			if(!Unpacker.Error() && !OnChunk(*pUuid, pExData, ExSize, Tick))
+				return false;
+		}
+		else
+		{
+			char aError[64];
+			str_format(aError, sizeof(aError), "unknown chunk %d", Chunk);
+			return Fail(aError, Tick);
+		}
+
+		if(Unpacker.Error())
+			return Fail("truncated chunk", Tick);
+	}
+}
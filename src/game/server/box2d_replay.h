@@ -0,0 +1,76 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_REPLAY_H
+#define GAME_SERVER_BOX2D_REPLAY_H
+
+#include <engine/shared/protocol.h>
+#include <engine/shared/uuid_manager.h>
+
+#include <game/box2d_map.h>
+
+#include "box2d_tee.h"
+#include "box2d_world.h"
+
+#include <unordered_map>
+#include <vector>
+
+/*
+	Runs the box2d worlds of a teehistorian recording again from its box2d
+	chunks, without the game around them, and compares them to the
+	recorded checksums. Every operation of the server on a world is
+	recorded in the order it happened, so the replay builds the same bodies
+	in the same order and steps them the same way. The tees follow the
+	recorded player positions. That only works on the build that recorded
+	it, box2d's floating point results depend on the compiler and the
+	platform.
+*/
+class CBox2DReplay
+{
+	const std::vector<CTileOutline> &m_vMapOutlines;
+	const std::vector<CQuadPolygon> &m_vMapQuads;
+
+	CBox2DWorld *m_apWorlds[MAX_CLIENTS + 1];
+	// the boxes of every world by their id
+	std::unordered_map<int, b2Body *> m_aBoxes[MAX_CLIENTS + 1];
+	CBox2DTee m_aTees[MAX_CLIENTS];
+	// where the characters were at the end of the last tick
+	vec2 m_aTeeTargets[MAX_CLIENTS];
+
+	int m_NumChunks;
+	int m_NumChecksums;
+	int m_DivergentTick;
+	int m_DivergentTeam;
+	unsigned m_RecordedChecksum;
+	unsigned m_ReplayedChecksum;
+	char m_aError[128];
+
+	CBox2DWorld *World(int Team);
+	b2Body *Box(int Team, int ID);
+	bool Fail(const char *pError, int Tick);
+
+public:
+	CBox2DReplay(const std::vector<CTileOutline> &vMapOutlines, const std::vector<CQuadPolygon> &vMapQuads);
+	~CBox2DReplay();
+
+	// walks the chunks of a teehistorian after its header and replays
+	// them. returns false like OnChunk() or if the chunks are invalid
+	bool Run(const unsigned char *pData, int Size);
+	// applies an ex chunk of the teehistorian that happened at Tick.
+	// returns false if the chunk is invalid, it doesn't fit the replayed
+	// worlds or a checksum differs, the replay can't go on after that
+	bool OnChunk(CUuid Uuid, const unsigned char *pData, int Size, int Tick);
+	// a player record, the tee of the client moves there in the next step
+	void OnPlayer(int ClientID, int x, int y);
+
+	int NumChunks() const { return m_NumChunks; }
+	int NumChecksums() const { return m_NumChecksums; }
+	// -1 while the checksums match
+	int DivergentTick() const { return m_DivergentTick; }
+	int DivergentTeam() const { return m_DivergentTeam; }
+	unsigned RecordedChecksum() const { return m_RecordedChecksum; }
+	unsigned ReplayedChecksum() const { return m_ReplayedChecksum; }
+	// what went wrong if OnChunk() failed on anything but a checksum
+	const char *Error() const { return m_aError; }
+};
+
+#endif
@@ -0,0 +1,204 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_save.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <box2d/box2d.h>
+
+#include <engine/shared/compression.h>
+
+#include <cmath>
+
+enum
+{
+	BOX2D_SAVE_VERSION_NO_FRICTION = 1,
+	BOX2D_SAVE_VERSION = 2,
+};
+
+// fixed point precision of the packed values
+static const float POS_PRECISION = 64.0f; // 1/64 game unit
+static const float ANGLE_PRECISION = 65536.0f / (2 * pi); // 1/65536 turn
+static const float MATERIAL_PRECISION = 1024.0f; // density and friction
+// what box2d uses when the friction isn't set
+static const float DEFAULT_FRICTION = 0.2f;
+
+static int ToFixed(float Value, float Precision)
+{
+	return round_to_int(Value * Precision);
+}
+
+static float FromFixed(int Value, float Precision)
+{
+	return Value / Precision;
+}
+
+class CStatePacker
+{
+	std::vector<unsigned char> &m_vData;
+
+public:
+	CStatePacker(std::vector<unsigned char> &vData) :
+		m_vData(vData) {}
+
+	void AddInt(int i)
+	{
+		unsigned char aBuf[8];
+		unsigned char *pEnd = CVariableInt::Pack(aBuf, i);
+		m_vData.insert(m_vData.end(), aBuf, pEnd);
+	}
+	void AddFloat(float Value, float Precision) { AddInt(ToFixed(Value, Precision)); }
+	void AddVec(vec2 Value, float Precision)
+	{
+		AddFloat(Value.x, Precision);
+		AddFloat(Value.y, Precision);
+	}
+};
+
+class CStateUnpacker
+{
+	// padded, so that reading a truncated int can't run past the end
+	std::vector<unsigned char> m_vData;
+	int m_Size;
+	const unsigned char *m_pCur;
+	bool m_Error;
+
+public:
+	CStateUnpacker(const unsigned char *pData, int Size) :
+		m_vData(pData, pData + Size), m_Size(Size), m_Error(false)
+	{
+		m_vData.resize(Size + 8, 0);
+		m_pCur = m_vData.data();
+	}
+
+	bool Error() const { return m_Error; }
+	bool AtEnd() const { return m_pCur == m_vData.data() + m_Size; }
+
+	int GetInt()
+	{
+		int i = 0;
+		if(m_Error)
+			return 0;
+		m_pCur = CVariableInt::Unpack(m_pCur, &i);
+		if(m_pCur > m_vData.data() + m_Size)
+		{
+			m_Error = true;
+			return 0;
+		}
+		return i;
+	}
+	int GetIntRange(int Min, int Max)
+	{
+		int i = GetInt();
+		if(i < Min || i > Max)
+		{
+			m_Error = true;
+			return Min;
+		}
+		return i;
+	}
+	float GetFloat(float Precision) { return FromFixed(GetInt(), Precision); }
+	vec2 GetVec(float Precision)
+	{
+		float x = GetFloat(Precision);
+		return vec2(x, GetFloat(Precision));
+	}
+};
+
+static bool IsSavedJoint(int Type)
+{
+	return Type == e_distanceJoint || Type == e_revoluteJoint || Type == e_weldJoint;
+}
+
+void CBox2DWorldState::Clear()
+{
+	m_vBodies.clear();
+	m_vJoints.clear();
+}
+
+void CBox2DWorldState::Pack(std::vector<unsigned char> &vData) const
+{
+	CStatePacker Packer(vData);
+	Packer.AddInt(BOX2D_SAVE_VERSION);
+	Packer.AddInt(m_vBodies.size());
+	Packer.AddInt(m_vJoints.size());
+
+	for(const CBox2DBodyState &Body : m_vBodies)
+	{
+		Packer.AddInt(Body.m_Type);
+		Packer.AddVec(Body.m_Pos, POS_PRECISION);
+		// only the orientation matters, not how often the body turned
+		Packer.AddFloat(fmodf(Body.m_Angle, 2 * pi), ANGLE_PRECISION);
+		Packer.AddVec(Body.m_Vel, POS_PRECISION);
+		Packer.AddFloat(Body.m_AngularVel, ANGLE_PRECISION);
+		Packer.AddInt(Body.m_Size.x);
+		Packer.AddInt(Body.m_Size.y);
+		Packer.AddFloat(Body.m_Density, MATERIAL_PRECISION);
+		Packer.AddFloat(Body.m_Friction, MATERIAL_PRECISION);
+	}
+
+	for(const CBox2DJointState &Joint : m_vJoints)
+	{
+		Packer.AddInt(Joint.m_Type);
+		Packer.AddInt(Joint.m_BodyA);
+		Packer.AddInt(Joint.m_BodyB);
+		Packer.AddInt(Joint.m_CollideConnected);
+		Packer.AddVec(Joint.m_AnchorA, POS_PRECISION);
+		Packer.AddVec(Joint.m_AnchorB, POS_PRECISION);
+		Packer.AddFloat(Joint.m_ReferenceAngle, ANGLE_PRECISION);
+		Packer.AddFloat(Joint.m_Length, POS_PRECISION);
+	}
+}
+
+bool CBox2DWorldState::Unpack(const unsigned char *pData, int Size)
+{
+	Clear();
+
+	CStateUnpacker Unpacker(pData, Size);
+	int Version = Unpacker.GetInt();
+	// every body and every joint takes at least 10 bytes
+	int NumBodies = Unpacker.GetIntRange(0, Size / 10);
+	int NumJoints = Unpacker.GetIntRange(0, Size / 10);
+	if(Unpacker.Error() || Version < BOX2D_SAVE_VERSION_NO_FRICTION || Version > BOX2D_SAVE_VERSION)
+		return false;
+
+	m_vBodies.resize(NumBodies);
+	for(CBox2DBodyState &Body : m_vBodies)
+	{
+		Body.m_Type = Unpacker.GetIntRange(b2_staticBody, b2_dynamicBody);
+		Body.m_Pos = Unpacker.GetVec(POS_PRECISION);
+		Body.m_Angle = Unpacker.GetFloat(ANGLE_PRECISION);
+		Body.m_Vel = Unpacker.GetVec(POS_PRECISION);
+		Body.m_AngularVel = Unpacker.GetFloat(ANGLE_PRECISION);
+		Body.m_Size.x = Unpacker.GetIntRange(1, 1 << 20);
+		Body.m_Size.y = Unpacker.GetIntRange(1, 1 << 20);
+		Body.m_Density = Unpacker.GetFloat(MATERIAL_PRECISION);
+		Body.m_Friction = Version > BOX2D_SAVE_VERSION_NO_FRICTION ? Unpacker.GetFloat(MATERIAL_PRECISION) : DEFAULT_FRICTION;
+	}
+
+	m_vJoints.resize(NumJoints);
+	for(CBox2DJointState &Joint : m_vJoints)
+	{
+		Joint.m_Type = Unpacker.GetInt();
+		if(!IsSavedJoint(Joint.m_Type))
+		{
+			Clear();
+			return false;
+		}
+		Joint.m_BodyA = Unpacker.GetIntRange(0, NumBodies - 1);
+		Joint.m_BodyB = Unpacker.GetIntRange(0, NumBodies - 1);
+		Joint.m_CollideConnected = Unpacker.GetIntRange(0, 1);
+		Joint.m_AnchorA = Unpacker.GetVec(POS_PRECISION);
+		Joint.m_AnchorB = Unpacker.GetVec(POS_PRECISION);
+		Joint.m_ReferenceAngle = Unpacker.GetFloat(ANGLE_PRECISION);
+		Joint.m_Length = Unpacker.GetFloat(POS_PRECISION);
+	}
+
+	if(Unpacker.Error() || !Unpacker.AtEnd())
+	{
+		Clear();
+		return false;
+	}
+	return true;
+}
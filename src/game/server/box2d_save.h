@@ -0,0 +1,54 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_SAVE_H
+#define GAME_SERVER_BOX2D_SAVE_H
+
+#include <base/vmath.h>
+
+#include <vector>
+
+// positions, sizes and anchors are in game units, velocities per second
+struct CBox2DBodyState
+{
+	int m_Type; // b2BodyType
+	vec2 m_Pos;
+	float m_Angle;
+	vec2 m_Vel;
+	float m_AngularVel;
+	ivec2 m_Size;
+	float m_Density;
+	float m_Friction;
+};
+
+struct CBox2DJointState
+{
+	int m_Type; // b2JointType, only distance, revolute and weld joints are saved
+	int m_BodyA; // indices into the bodies of the state
+	int m_BodyB;
+	bool m_CollideConnected;
+	vec2 m_AnchorA; // relative to the bodies
+	vec2 m_AnchorB;
+	float m_ReferenceAngle; // revolute and weld joints
+	float m_Length; // distance joints
+};
+
+/*
+	The boxes and joints of a box2d world. The packed format is a list of
+	variable length ints, all values are fixed point, so it is the same
+	on every platform and around 20 bytes per box.
+*/
+class CBox2DWorldState
+{
+public:
+	std::vector<CBox2DBodyState> m_vBodies;
+	std::vector<CBox2DJointState> m_vJoints;
+
+	void Clear();
+	bool Empty() const { return m_vBodies.empty(); }
+
+	void Pack(std::vector<unsigned char> &vData) const;
+	// returns false and leaves the state empty if the data is invalid
+	bool Unpack(const unsigned char *pData, int Size);
+};
+
+#endif
@@ -0,0 +1,50 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_shapes.h"
+
+#include <engine/server.h>
+
+#include <game/generated/protocol.h>
+
+int CBox2DShapes::Add(ivec2 Size)
+{
+	int Free = -1;
+	for(unsigned i = 0; i < m_vShapes.size(); i++)
+	{
+		if(m_vShapes[i].m_RefCount && m_vShapes[i].m_Size == Size)
+		{
+			m_vShapes[i].m_RefCount++;
+			return i;
+		}
+		if(!m_vShapes[i].m_RefCount && Free == -1)
+			Free = i;
+	}
+
+	if(Free == -1)
+	{
+		Free = m_vShapes.size();
+		m_vShapes.emplace_back();
+	}
+	m_vShapes[Free].m_Size = Size;
+	m_vShapes[Free].m_RefCount = 1;
+	return Free;
+}
+
+void CBox2DShapes::Remove(int ShapeID)
+{
+	m_vShapes[ShapeID].m_RefCount--;
+}
+
+void CBox2DShapes::Snap(IServer *pServer) const
+{
+	for(unsigned i = 0; i < m_vShapes.size(); i++)
+	{
+		if(!m_vShapes[i].m_RefCount)
+			continue;
+		CNetObj_Box2DShape *pShape = static_cast<CNetObj_Box2DShape *>(pServer->SnapNewItem(NETOBJTYPE_BOX2DSHAPE, i, sizeof(CNetObj_Box2DShape)));
+		if(!pShape)
+			return;
+		pShape->m_Width = m_vShapes[i].m_Size.x;
+		pShape->m_Height = m_vShapes[i].m_Size.y;
+	}
+}
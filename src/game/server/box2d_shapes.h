@@ -0,0 +1,31 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_SHAPES_H
+#define GAME_SERVER_BOX2D_SHAPES_H
+
+#include <base/vmath.h>
+
+#include <vector>
+
+class IServer;
+
+// the distinct box sizes in use, snapped once per snapshot as Box2DShape
+// items that the Box2DBody items refer to by their ID
+class CBox2DShapes
+{
+	struct CShape
+	{
+		ivec2 m_Size;
+		int m_RefCount;
+	};
+
+	std::vector<CShape> m_vShapes;
+
+public:
+	int Add(ivec2 Size);
+	void Remove(int ShapeID);
+
+	void Snap(IServer *pServer) const;
+};
+
+#endif
@@ -0,0 +1,106 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_tee.h"
+
+CBox2DTee::CBox2DTee()
+{
+	m_pWorld = 0;
+	m_pBody = 0;
+	m_SnapSlot = -1;
+	m_HammerDir = vec2(0, 0);
+	m_HammerTick = 0;
+	m_HammerTickAdd = 0;
+}
+
+void CBox2DTee::Create(CBox2DWorld *pWorld, vec2 Pos)
+{
+	m_pWorld = pWorld;
+	b2Vec2 Position(Pos.x / B2_SCALE, Pos.y / B2_SCALE);
+
+	if(!m_pWorld->m_vpTeeBodyPool.empty())
+	{
+		m_pBody = m_pWorld->m_vpTeeBodyPool.back();
+		m_pWorld->m_vpTeeBodyPool.pop_back();
+		// move it while it's disabled, so it doesn't sweep through the world
+		m_pBody->SetTransform(Position, 0.0f);
+		m_pBody->SetLinearVelocity(b2Vec2(0, 0));
+		m_pBody->SetEnabled(true);
+	}
+	else
+	{
+		b2BodyDef BodyDef;
+		BodyDef.position = Position;
+		BodyDef.type = b2_kinematicBody;
+		BodyDef.fixedRotation = true;
+		m_pBody = m_pWorld->CreateBody(&BodyDef);
+
+		b2CircleShape Shape;
+		Shape.m_radius = 30 / 2 / B2_SCALE;
+		b2FixtureDef FixtureDef;
+		FixtureDef.density = 1.f;
+		FixtureDef.shape = &Shape;
+		m_pBody->CreateFixture(&FixtureDef);
+	}
+	m_SnapSlot = m_pWorld->AddSnapBody(m_pBody);
+	m_pBody->SetAwake(true);
+
+	m_HammerTick = 0;
+	m_HammerTickAdd = 0;
+}
+
+void CBox2DTee::Destroy()
+{
+	if(m_pBody)
+	{
+		m_pWorld->RemoveSnapBody(m_SnapSlot);
+		// the body is reused by the next tee that spawns
+		m_pWorld->m_Contacts.RemoveBody(m_pBody);
+		m_pBody->SetLinearVelocity(b2Vec2(0, 0));
+		m_pBody->SetEnabled(false);
+		m_pWorld->m_vpTeeBodyPool.push_back(m_pBody);
+	}
+	m_pWorld = 0;
+	m_pBody = 0;
+	m_SnapSlot = -1;
+}
+
+void CBox2DTee::Hammer(vec2 Dir)
+{
+	m_HammerDir = Dir;
+	m_HammerTick = 0;
+	m_HammerTickAdd = 10;
+}
+
+void CBox2DTee::Tick(vec2 Pos, float SteppedTime, float StepTime)
+{
+	Pos += m_HammerDir * m_HammerTick;
+
+	m_HammerTick += m_HammerTickAdd;
+	if(m_HammerTick >= 60)
+		m_HammerTickAdd = -20;
+	else if(m_HammerTick == 0)
+		m_HammerTickAdd = 0;
+
+	// the world does no step this tick, the body gets there in the next one
+	if(SteppedTime <= 0.0f)
+	{
+		m_pBody->SetLinearVelocity(b2Vec2(0, 0));
+		return;
+	}
+
+	b2Vec2 Target(Pos.x / B2_SCALE, Pos.y / B2_SCALE);
+	b2Vec2 Move = Target - m_pBody->GetPosition();
+	// box2d caps how far a body moves per step. a faster tee, on speedups
+	// or when it's teleported, would fall behind and fling every box in
+	// its way while catching up. instead it jumps over the part of the way
+	// the world can't sweep, and the rest is still swept with continuous
+	// collision, so boxes can't tunnel through it
+	float MaxMove = b2_maxTranslation * SteppedTime / StepTime;
+	float Length = Move.Length();
+	if(Length > MaxMove)
+	{
+		Move *= MaxMove / Length;
+		m_pBody->SetTransform(Target - Move, 0.0f);
+	}
+	m_pBody->SetLinearVelocity(1.0f / SteppedTime * Move);
+}
@@ -0,0 +1,49 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_TEE_H
+#define GAME_SERVER_BOX2D_TEE_H
+
+#include <base/vmath.h>
+
+#include <box2d/box2d.h>
+
+#include "box2d_world.h"
+
+/*
+	The body of a tee in a box2d world. It is kinematic and gets the
+	velocity that takes it to the tee's position (plus the hammer swing)
+	within the steps of a tick, so it pushes boxes out of the way without
+	ever being pushed back. Box2D sweeps it against the boxes like a
+	bullet, as long as it doesn't move more than a step can cover.
+	Destroyed bodies are disabled and kept in the world's tee body pool for
+	the next spawn.
+*/
+class CBox2DTee
+{
+	CBox2DWorld *m_pWorld;
+	b2Body *m_pBody;
+	int m_SnapSlot;
+
+	vec2 m_HammerDir;
+	int m_HammerTick;
+	int m_HammerTickAdd;
+
+public:
+	CBox2DTee();
+
+	void Create(CBox2DWorld *pWorld, vec2 Pos);
+	void Destroy();
+	bool Exists() const { return m_pBody != 0; }
+
+	void Hammer(vec2 Dir);
+	// moves the body to Pos, plus the hammer swing, during the next step
+	// of the world. SteppedTime is how far that step advances the world,
+	// in substeps of StepTime, see CBox2DWorld::NumDueSubsteps()
+	void Tick(vec2 Pos, float SteppedTime, float StepTime);
+
+	CBox2DWorld *World() const { return m_pWorld; }
+	b2Body *Body() const { return m_pBody; }
+	const CBox2DTransform &SnapTransform() const { return m_pWorld->SnapTransform(m_SnapSlot); }
+};
+
+#endif
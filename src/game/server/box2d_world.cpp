@@ -0,0 +1,356 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "box2d_world.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/jobs.h>
+
+#include <cmath>
+
+class CBox2DWorld::CStepJob : public IJob
+{
+	CBox2DWorld *m_pWorld;
+
+	void Run()
+	{
+		m_pWorld->RunStep();
+		m_pWorld->m_StepDone.Signal();
+	}
+
+public:
+	CStepJob(CBox2DWorld *pWorld) :
+		m_pWorld(pWorld) {}
+};
+
+CBox2DWorld::CBox2DWorld(const b2Vec2 &Gravity) :
+	b2World(Gravity), m_Explosions(this)
+{
+	m_FirstFreeSnapBody = -1;
+	m_FrontTransforms = 0;
+	m_DeltaTime = 0.0f;
+	m_StepTime = 0.0f;
+	m_MaxSubsteps = 1;
+	m_VelocityIterations = 0;
+	m_PositionIterations = 0;
+	m_Accumulator = 0.0f;
+	m_NumDroppedSteps = 0;
+	mem_zero(&m_StepStats, sizeof(m_StepStats));
+	m_Stepping = false;
+	m_TransformsPending = false;
+	m_NextBoxID = 0;
+	m_LastUsedTick = 0;
+	m_NumBoxes = 0;
+	SetContactListener(&m_Contacts);
+}
+
+CBox2DWorld::~CBox2DWorld()
+{
+	Sync();
+}
+
+static CBox2DTransform GetTransform(const b2Body *pBody)
+{
+	CBox2DTransform Transform;
+	Transform.m_Pos = vec2(pBody->GetPosition().x * B2_SCALE, pBody->GetPosition().y * B2_SCALE);
+	Transform.m_Angle = pBody->GetAngle();
+	return Transform;
+}
+
+void CBox2DWorld::StoreTransforms(bool Prev)
+{
+	for(CSnapBody &SnapBody : m_vSnapBodies)
+	{
+		if(!SnapBody.m_pBody)
+			continue;
+		(Prev ? SnapBody.m_Prev : SnapBody.m_Cur) = GetTransform(SnapBody.m_pBody);
+	}
+}
+
+void CBox2DWorld::RunStep()
+{
+	// the world advances by the game time of a tick, not by the time the
+	// tick took. a server that falls behind runs the missed ticks itself,
+	// and CBox2DGovernor lowers the iterations when the steps get slow.
+	// steps due beyond MaxSubsteps are carried to the next tick, a small
+	// tolerance keeps float rounding from leaving a step behind
+	int Substeps = NumDueSubsteps(m_DeltaTime, m_StepTime, m_MaxSubsteps);
+	m_Accumulator += m_DeltaTime;
+	m_Accumulator -= Substeps * m_StepTime;
+	if(m_Accumulator > m_DeltaTime)
+	{
+		// more than a tick behind, the step time doesn't fit into
+		// MaxSubsteps. let the world run slower instead of falling
+		// further behind every tick
+		m_NumDroppedSteps += (int)((m_Accumulator - m_DeltaTime) / m_StepTime);
+		m_Accumulator = m_DeltaTime;
+	}
+
+	// bodies destroyed since the last step may have ended contacts
+	m_Contacts.Clear();
+
+	b2Profile &Profile = m_StepStats.m_Profile;
+	mem_zero(&Profile, sizeof(Profile));
+	for(int i = 0; i < Substeps; i++)
+	{
+		if(i == Substeps - 1)
+			StoreTransforms(true);
+		Step(m_StepTime, m_VelocityIterations, m_PositionIterations);
+
+		const b2Profile &StepProfile = GetProfile();
+		Profile.step += StepProfile.step;
+		Profile.collide += StepProfile.collide;
+		Profile.solve += StepProfile.solve;
+		Profile.solveInit += StepProfile.solveInit;
+		Profile.solveVelocity += StepProfile.solveVelocity;
+		Profile.solvePosition += StepProfile.solvePosition;
+		Profile.broadphase += StepProfile.broadphase;
+		Profile.solveTOI += StepProfile.solveTOI;
+	}
+	if(Substeps)
+		StoreTransforms(false);
+	m_Contacts.Finish();
+
+	m_StepStats.m_NumSubsteps = Substeps;
+	m_StepStats.m_NumBodies = GetBodyCount();
+	m_StepStats.m_NumContacts = GetContactCount();
+	m_StepStats.m_NumAwakeBodies = 0;
+	for(const b2Body *pBody = GetBodyList(); pBody; pBody = pBody->GetNext())
+		m_StepStats.m_NumAwakeBodies += pBody->IsAwake();
+
+	float Alpha = m_DeltaTime != m_StepTime ? clamp(m_Accumulator / m_StepTime, 0.0f, 1.0f) : 1.0f;
+	std::vector<CBox2DTransform> &vTransforms = m_avTransforms[m_FrontTransforms ^ 1];
+	for(unsigned i = 0; i < m_vSnapBodies.size(); i++)
+	{
+		const CSnapBody &SnapBody = m_vSnapBodies[i];
+		if(!SnapBody.m_pBody)
+			continue;
+		vTransforms[i].m_Pos = mix(SnapBody.m_Prev.m_Pos, SnapBody.m_Cur.m_Pos, Alpha);
+		vTransforms[i].m_Angle = mix(SnapBody.m_Prev.m_Angle, SnapBody.m_Cur.m_Angle, Alpha);
+	}
+}
+
+int CBox2DWorld::NumDueSubsteps(float DeltaTime, float StepTime, int MaxSubsteps) const
+{
+	return minimum((int)((m_Accumulator + DeltaTime) / StepTime + 0.001f), MaxSubsteps);
+}
+
+void CBox2DWorld::StartStep(float DeltaTime, float StepTime, int MaxSubsteps, int VelocityIterations, int PositionIterations, CJobPool *pJobPool)
+{
+	dbg_assert(!m_Stepping, "box2d world stepped without sync");
+
+	m_DeltaTime = DeltaTime;
+	m_StepTime = StepTime;
+	m_MaxSubsteps = MaxSubsteps;
+	m_VelocityIterations = VelocityIterations;
+	m_PositionIterations = PositionIterations;
+
+	// the transforms are published on Sync() either way, so the snapshots
+	// show the same state with and without a job pool
+	m_TransformsPending = true;
+	if(!pJobPool)
+	{
+		RunStep();
+		return;
+	}
+
+	// jobs can't be queued twice, so every step gets a new one
+	m_Stepping = true;
+	pJobPool->Add(std::make_shared<CStepJob>(this));
+}
+
+void CBox2DWorld::Sync()
+{
+	if(m_Stepping)
+	{
+		m_StepDone.Wait();
+		m_Stepping = false;
+	}
+	if(m_TransformsPending)
+	{
+		m_FrontTransforms ^= 1;
+		m_TransformsPending = false;
+	}
+}
+
+int CBox2DWorld::AddSnapBody(b2Body *pBody)
+{
+	int Slot = m_FirstFreeSnapBody;
+	if(Slot == -1)
+	{
+		Slot = m_vSnapBodies.size();
+		m_vSnapBodies.emplace_back();
+		m_avTransforms[0].emplace_back();
+		m_avTransforms[1].emplace_back();
+	}
+	else
+	{
+		m_FirstFreeSnapBody = m_vSnapBodies[Slot].m_NextFree;
+	}
+	// the body is visible right away, before it went through a step
+	CBox2DTransform Transform = GetTransform(pBody);
+	m_vSnapBodies[Slot].m_pBody = pBody;
+	m_vSnapBodies[Slot].m_NextFree = -1;
+	m_vSnapBodies[Slot].m_Prev = Transform;
+	m_vSnapBodies[Slot].m_Cur = Transform;
+	m_avTransforms[0][Slot] = Transform;
+	m_avTransforms[1][Slot] = Transform;
+	return Slot;
+}
+
+b2Body *CBox2DWorld::CreateBox(const CBox2DBodyState &Body, uintptr_t UserData)
+{
+	m_NumBoxes++;
+	return CreateBox2DBox(this, Body, UserData);
+}
+
+void CBox2DWorld::DestroyBox(b2Body *pBody)
+{
+	m_NumBoxes--;
+	m_Contacts.RemoveBody(pBody);
+	DestroyBody(pBody);
+}
+
+bool CBox2DWorld::Reclaimable(int Tick, int TickSpeed) const
+{
+	return m_NumBoxes == 0 && m_LastUsedTick + TickSpeed * 10 < Tick;
+}
+
+b2Body *CreateBox2DBox(b2World *pWorld, const CBox2DBodyState &Body, uintptr_t UserData)
+{
+	b2BodyDef BodyDef;
+	BodyDef.position = b2Vec2(Body.m_Pos.x / B2_SCALE, Body.m_Pos.y / B2_SCALE);
+	BodyDef.angle = Body.m_Angle;
+	BodyDef.type = (b2BodyType)Body.m_Type;
+	BodyDef.userData.pointer = UserData;
+	b2Body *pBody = pWorld->CreateBody(&BodyDef);
+
+	b2PolygonShape Shape;
+	Shape.SetAsBox(Body.m_Size.x / 2.0f / B2_SCALE, Body.m_Size.y / 2.0f / B2_SCALE);
+	b2FixtureDef FixtureDef;
+	FixtureDef.density = Body.m_Density;
+	FixtureDef.friction = Body.m_Friction;
+	FixtureDef.shape = &Shape;
+	pBody->CreateFixture(&FixtureDef);
+
+	// static bodies ignore these
+	pBody->SetLinearVelocity(b2Vec2(Body.m_Vel.x / B2_SCALE, Body.m_Vel.y / B2_SCALE));
+	pBody->SetAngularVelocity(Body.m_AngularVel);
+	return pBody;
+}
+
+void CreateBox2DJoints(b2World *pWorld, const std::vector<CBox2DJointState> &vJoints, const std::vector<b2Body *> &vpBodies)
+{
+	int NumBodies = vpBodies.size();
+	for(const CBox2DJointState &Joint : vJoints)
+	{
+		if(Joint.m_BodyA >= NumBodies || Joint.m_BodyB >= NumBodies)
+			continue;
+		b2Vec2 AnchorA(Joint.m_AnchorA.x / B2_SCALE, Joint.m_AnchorA.y / B2_SCALE);
+		b2Vec2 AnchorB(Joint.m_AnchorB.x / B2_SCALE, Joint.m_AnchorB.y / B2_SCALE);
+		b2Body *pBodyA = vpBodies[Joint.m_BodyA];
+		b2Body *pBodyB = vpBodies[Joint.m_BodyB];
+		if(Joint.m_Type == e_distanceJoint)
+		{
+			b2DistanceJointDef JointDef;
+			JointDef.bodyA = pBodyA;
+			JointDef.bodyB = pBodyB;
+			JointDef.collideConnected = Joint.m_CollideConnected;
+			JointDef.localAnchorA = AnchorA;
+			JointDef.localAnchorB = AnchorB;
+			JointDef.length = Joint.m_Length / B2_SCALE;
+			pWorld->CreateJoint(&JointDef);
+		}
+		else if(Joint.m_Type == e_revoluteJoint)
+		{
+			b2RevoluteJointDef JointDef;
+			JointDef.bodyA = pBodyA;
+			JointDef.bodyB = pBodyB;
+			JointDef.collideConnected = Joint.m_CollideConnected;
+			JointDef.localAnchorA = AnchorA;
+			JointDef.localAnchorB = AnchorB;
+			JointDef.referenceAngle = Joint.m_ReferenceAngle;
+			pWorld->CreateJoint(&JointDef);
+		}
+		else if(Joint.m_Type == e_weldJoint)
+		{
+			b2WeldJointDef JointDef;
+			JointDef.bodyA = pBodyA;
+			JointDef.bodyB = pBodyB;
+			JointDef.collideConnected = Joint.m_CollideConnected;
+			JointDef.localAnchorA = AnchorA;
+			JointDef.localAnchorB = AnchorB;
+			JointDef.referenceAngle = Joint.m_ReferenceAngle;
+			pWorld->CreateJoint(&JointDef);
+		}
+	}
+}
+
+static bool IsTouching(const b2Body *pBody)
+{
+	for(const b2ContactEdge *pEdge = pBody->GetContactList(); pEdge; pEdge = pEdge->next)
+	{
+		if(pEdge->contact->IsTouching())
+			return true;
+	}
+	return false;
+}
+
+bool UpdateBox2DKeyframe(CNetObj_Box2DBody *pKeyframe, const b2Body *pBody, int Tick, float TickTime, int MaxTicks, float MaxError, float Radius)
+{
+	int Flags = 0;
+	if(pBody->GetType() == b2_staticBody)
+		Flags |= BOX2DBODYFLAG_STATIC;
+	else if(pBody->GetType() == b2_kinematicBody)
+		Flags |= BOX2DBODYFLAG_KINEMATIC;
+	if(!pBody->IsAwake())
+		Flags |= BOX2DBODYFLAG_ASLEEP;
+	bool AtRest = Flags & (BOX2DBODYFLAG_STATIC | BOX2DBODYFLAG_ASLEEP);
+
+	vec2 Pos = vec2(pBody->GetPosition().x, pBody->GetPosition().y) * B2_SCALE;
+	float Angle = pBody->GetAngle();
+	if(pKeyframe->m_Tick >= 0 && Flags == pKeyframe->m_Flags)
+	{
+		// bodies at rest stay where they are until something wakes them up
+		if(AtRest)
+			return false;
+		int Ticks = Tick - pKeyframe->m_Tick;
+		if(Ticks <= MaxTicks)
+		{
+			// the clients see bodies that lie on something fall through it
+			// without collisions, but they have them. kinematic bodies
+			// don't fall at all
+			vec2 Gravity(0.0f, 0.0f);
+			if(!(Flags & BOX2DBODYFLAG_KINEMATIC) && !IsTouching(pBody))
+			{
+				b2Vec2 WorldGravity = pBody->GetWorld()->GetGravity();
+				Gravity = vec2(WorldGravity.x, WorldGravity.y) * (B2_SCALE * TickTime * TickTime);
+			}
+			vec2 PredictedPos;
+			float PredictedAngle;
+			ExtrapolateBox2DBody(pKeyframe, Ticks, Gravity, &PredictedPos, &PredictedAngle);
+			float AngleError = absolute(remainderf(Angle - PredictedAngle, 2 * pi));
+			if(distance(Pos, PredictedPos) + AngleError * Radius <= MaxError)
+				return false;
+		}
+	}
+
+	vec2 Vel = vec2(pBody->GetLinearVelocity().x, pBody->GetLinearVelocity().y) * (B2_SCALE * TickTime);
+	pKeyframe->m_X = round_to_int(Pos.x);
+	pKeyframe->m_Y = round_to_int(Pos.y);
+	pKeyframe->m_Angle = round_to_int(Angle / (2 * pi) * 65536) & 0xffff;
+	pKeyframe->m_VelX = AtRest ? 0 : round_to_int(Vel.x * 256.0f);
+	pKeyframe->m_VelY = AtRest ? 0 : round_to_int(Vel.y * 256.0f);
+	pKeyframe->m_AngularVel = AtRest ? 0 : round_to_int(pBody->GetAngularVelocity() * TickTime / (2 * pi) * 65536);
+	pKeyframe->m_Tick = Tick;
+	pKeyframe->m_Flags = Flags;
+	return true;
+}
+
+void CBox2DWorld::RemoveSnapBody(int Slot)
+{
+	m_vSnapBodies[Slot].m_pBody = 0;
+	m_vSnapBodies[Slot].m_NextFree = m_FirstFreeSnapBody;
+	m_FirstFreeSnapBody = Slot;
+}
@@ -0,0 +1,147 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_BOX2D_WORLD_H
+#define GAME_SERVER_BOX2D_WORLD_H
+
+#include <base/tl/threading.h>
+#include <base/vmath.h>
+
+#include <box2d/box2d.h>
+
+#include <game/box2d_keyframe.h>
+
+#include "box2d_contacts.h"
+#include "box2d_explosion.h"
+#include "box2d_save.h"
+
+#include <vector>
+
+class CJobPool;
+
+struct CBox2DTransform
+{
+	vec2 m_Pos; // in game units
+	float m_Angle;
+};
+
+// what the last StartStep() cost, the profile is summed over its substeps
+struct CBox2DStepStats
+{
+	b2Profile m_Profile;
+	int m_NumSubsteps;
+	int m_NumBodies;
+	int m_NumAwakeBodies;
+	int m_NumContacts;
+};
+
+/*
+	A box2d world of the server, there is one per ddrace team. The step can
+	run on a job pool, in parallel to the other worlds and while the main
+	thread builds the snapshots of the last tick:
+
+		OnTick: Sync() - entity ticks - StartStep()
+		DoSnapshot: Snap() reads SnapTransform()
+		OnTickFinished: Sync()
+
+	Between StartStep() and Sync() only the cached snap transforms may be
+	used, everything else (creating and destroying bodies, joint targets,
+	impulses, queries) has to happen after Sync(), i.e. at a step boundary.
+*/
+class CBox2DWorld : public b2World
+{
+	struct CSnapBody
+	{
+		b2Body *m_pBody;
+		int m_NextFree;
+		// before and after the last step, for interpolating between them
+		CBox2DTransform m_Prev;
+		CBox2DTransform m_Cur;
+	};
+
+	std::vector<CSnapBody> m_vSnapBodies;
+	int m_FirstFreeSnapBody;
+	// written by the step into the back buffer, swapped on Sync()
+	std::vector<CBox2DTransform> m_avTransforms[2];
+	int m_FrontTransforms;
+
+	float m_DeltaTime;
+	float m_StepTime;
+	int m_MaxSubsteps;
+	int m_VelocityIterations;
+	int m_PositionIterations;
+	float m_Accumulator;
+	int m_NumDroppedSteps;
+	CBox2DStepStats m_StepStats;
+	int m_NumBoxes;
+
+	bool m_Stepping;
+	bool m_TransformsPending;
+	CSemaphore m_StepDone;
+
+	class CStepJob;
+	void RunStep();
+	void StoreTransforms(bool Prev);
+
+public:
+	CBox2DWorld(const b2Vec2 &Gravity);
+	~CBox2DWorld();
+
+	CBox2DExplosions m_Explosions;
+	// the merged contact events of the last step, only valid after Sync()
+	CBox2DContactListener m_Contacts;
+	// disabled bodies of destroyed tees, see CBox2DTee
+	std::vector<b2Body *> m_vpTeeBodyPool;
+	// what the next box gets as its id in the teehistorian
+	int m_NextBoxID;
+	// the last tick a character was in the world or boxes were added
+	int m_LastUsedTick;
+
+	// boxes, as opposed to the map and the tees, see CreateBox2DBox()
+	b2Body *CreateBox(const CBox2DBodyState &Body, uintptr_t UserData);
+	void DestroyBox(b2Body *pBody);
+	int NumBoxes() const { return m_NumBoxes; }
+	// whether the world can be destroyed: it has been unused for 10 seconds
+	// and has no boxes left. boxes nobody is around for, like those loaded
+	// or placed from the console, are kept
+	bool Reclaimable(int Tick, int TickSpeed) const;
+
+	// advances the world by DeltaTime in fixed steps of StepTime, at most
+	// MaxSubsteps of them, as a job of pJobPool if one is given. steps that
+	// don't fit are done in the next tick, those more than a tick behind are
+	// dropped. the world must not be accessed until Sync() has been called.
+	// if the two times differ, the snap transforms are interpolated between
+	// the last two steps
+	void StartStep(float DeltaTime, float StepTime, int MaxSubsteps, int VelocityIterations, int PositionIterations, CJobPool *pJobPool);
+	// waits for a running step and publishes its transforms, so until then
+	// the snap transforms are those of the step before
+	void Sync();
+	// how many substeps the next StartStep() with these times will do,
+	// only valid while the world isn't stepping
+	int NumDueSubsteps(float DeltaTime, float StepTime, int MaxSubsteps) const;
+
+	// bodies whose transforms are cached after every step for snapping
+	int AddSnapBody(b2Body *pBody);
+	void RemoveSnapBody(int Slot);
+	const CBox2DTransform &SnapTransform(int Slot) const { return m_avTransforms[m_FrontTransforms][Slot]; }
+
+	// steps skipped because the world fell more than a tick behind
+	int NumDroppedSteps() const { return m_NumDroppedSteps; }
+	// only valid after Sync()
+	const CBox2DStepStats &StepStats() const { return m_StepStats; }
+};
+
+// a box of a state, velocities included. the server, the benchmark and the
+// teehistorian replay all build their boxes with this, so they match
+b2Body *CreateBox2DBox(b2World *pWorld, const CBox2DBodyState &Body, uintptr_t UserData);
+// the joints of a state, vpBodies are its bodies in the world. joints
+// between bodies that weren't created are skipped
+void CreateBox2DJoints(b2World *pWorld, const std::vector<CBox2DJointState> &vJoints, const std::vector<b2Body *> &vpBodies);
+
+// takes a new keyframe of the body at Tick, unless the clients can still
+// extrapolate the last one: it's at most MaxTicks old and no point within
+// Radius of the body's center is off by more than MaxError units.
+// TickTime is how far the world advances per tick. returns whether the
+// keyframe changed
+bool UpdateBox2DKeyframe(CNetObj_Box2DBody *pKeyframe, const b2Body *pBody, int Tick, float TickTime, int MaxTicks, float MaxError, float Radius);
+
+#endif
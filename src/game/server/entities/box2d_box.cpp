@@ -9,6 +9,7 @@
 #include <game/generated/protocol.h>
 
 #include <engine/shared/config.h>
+#include <game/server/player.h>
 #include <game/server/teams.h>
 
 
@@ -29,30 +30,28 @@ void Rotate(vec2* vertex, float x_orig, float y_orig, float angle)
 }
 
 
-CBox2DBox::CBox2DBox(CGameWorld *pGameWorld, vec2 Pos, vec2 Size, float Angle, b2World* World, b2BodyType bodytype, float dens) :
+CBox2DBox::CBox2DBox(CGameWorld *pGameWorld, CBox2DWorld *pWorld, const CBox2DBodyState &Body) :
 	CEntity(pGameWorld, CGameWorld::ENTTYPE_LASER)
 {
-	m_Pos = Pos;
-	m_Size = Size;
-	m_World = World;
-
-	// the box
- 	b2BodyDef BodyDef;
-	BodyDef.position = b2Vec2(Pos.x / SCALE, Pos.y / SCALE);
-	BodyDef.type = bodytype;
-	m_Body = GameServer()->m_b2world->CreateBody(&BodyDef);
-
-	b2PolygonShape Shape;
-	Shape.SetAsBox(Size.x / 2 / SCALE, Size.y / 2 / SCALE);
-	b2FixtureDef FixtureDef;
-	FixtureDef.density = dens;
-	FixtureDef.shape = &Shape;
-	m_Body->CreateFixture(&FixtureDef);
+	m_Pos = Body.m_Pos;
+	m_Size = vec2(Body.m_Size.x, Body.m_Size.y);
+	m_World = pWorld;
+	m_HistoryID = m_World->m_NextBoxID++;
+
+	m_Body = m_World->CreateBox(Body, (uintptr_t)this);
+	m_SnapSlot = m_World->AddSnapBody(m_Body);
+	m_ShapeID = GameServer()->m_b2shapes.Add(Body.m_Size);
+
+	mem_zero(&m_Keyframe, sizeof(m_Keyframe));
+	m_Keyframe.m_Tick = -1;
+	m_Keyframe.m_Shape = m_ShapeID;
+	UpdateKeyframe();
 
 	m_ID2 = Server()->SnapNewID();
 	m_ID3 = Server()->SnapNewID();
 	m_ID4 = Server()->SnapNewID();
 
+	GameServer()->AddB2Box(this);
 	GameWorld()->InsertEntity(this);
 }
 
@@ -61,19 +60,22 @@ CBox2DBox::~CBox2DBox()
 	Server()->SnapFreeID(m_ID2);
 	Server()->SnapFreeID(m_ID3);
 	Server()->SnapFreeID(m_ID4);
-	if (GameServer()->m_b2world)
+	if(m_Body)
 	{
-		m_World->DestroyBody(m_Body);
+		if(GameServer()->TeeHistorianActive())
+			GameServer()->TeeHistorian()->RecordB2BoxDestroy(GameServer()->B2WorldTeam(m_World), m_HistoryID);
+		m_World->RemoveSnapBody(m_SnapSlot);
+		m_World->DestroyBox(m_Body);
 	}
+	GameServer()->m_b2shapes.Remove(m_ShapeID);
 
-	for (unsigned i=0; i<GameServer()->m_b2bodies.size(); i++)
-	{
-		if (GameServer()->m_b2bodies[i] == this)
-		{
-			GameServer()->m_b2bodies.erase(GameServer()->m_b2bodies.begin() + i);
-			break;
-		}
-	}
+	if(m_BoxIndex >= 0)
+		GameServer()->RemoveB2Box(this);
+}
+
+void CBox2DBox::ReleaseBody()
+{
+	m_Body = 0;
 }
 
 void CBox2DBox::Tick()
@@ -83,6 +85,7 @@ void CBox2DBox::Tick()
 	{
 		m_MarkedForDestroy = true;
 	}
+	UpdateKeyframe();
 }
 
 void CBox2DBox::TickPaused()
@@ -90,19 +93,65 @@ void CBox2DBox::TickPaused()
 
 }
 
+void CBox2DBox::UpdateKeyframe()
+{
+	// the body is where the step of the last tick left it, the step of this
+	// one only starts after the entities ticked. the lasers show the same
+	// state, see CBox2DWorld::Sync()
+	UpdateBox2DKeyframe(&m_Keyframe, m_Body, Server()->Tick() - 1, GameServer()->B2TickTime(),
+		g_Config.m_B2KeyframeInterval, g_Config.m_B2KeyframeError, length(m_Size) / 2);
+}
+
+void CBox2DBox::UpdateVertices()
+{
+	// the body itself may be stepped on the physics thread right now
+	const CBox2DTransform &Transform = m_World->SnapTransform(m_SnapSlot);
+	vec2 pos = Transform.m_Pos;
+	m_aVertices[0] = vec2(pos.x - (m_Size.x/2), pos.y - (m_Size.y/2));
+	m_aVertices[1] = vec2(pos.x + (m_Size.x/2), pos.y - (m_Size.y/2));
+	m_aVertices[2] = vec2(pos.x + (m_Size.x/2), pos.y + (m_Size.y/2));
+	m_aVertices[3] = vec2(pos.x - (m_Size.x/2), pos.y + (m_Size.y/2));
+
+	float angle = Transform.m_Angle; // radians
+
+	// FUCK THIS MATH
+	for (int i=0; i<4; i++)
+	{
+		Rotate(&m_aVertices[i], pos.x, pos.y, angle);
+	}
+}
+
+void CBox2DBox::PreSnap()
+{
+	UpdateVertices();
+}
+
 void CBox2DBox::Snap(int SnappingClient)
 {
-	vec2 pos(m_Body->GetPosition().x * SCALE, m_Body->GetPosition().y * SCALE);
-	vec2 vertices[4] = {
-		vec2(pos.x - (m_Size.x/2), pos.y - (m_Size.y/2)),
-		vec2(pos.x + (m_Size.x/2), pos.y - (m_Size.y/2)),
-		vec2(pos.x + (m_Size.x/2), pos.y + (m_Size.y/2)),
-		vec2(pos.x - (m_Size.x/2), pos.y + (m_Size.y/2))
-	};
-
-	if (NetworkClipped(SnappingClient) and NetworkClipped(SnappingClient, vertices[0]) and NetworkClipped(SnappingClient, vertices[1]) and NetworkClipped(SnappingClient, vertices[2]) and NetworkClipped(SnappingClient, vertices[3]))
+	// CGameContext::OnSnap calls SnapVisible() for the boxes the client sees
+}
+
+void CBox2DBox::SnapVisible(int SnappingClient, bool OtherTeam)
+{
+	CPlayer *pPlayer = SnappingClient >= 0 ? GameServer()->m_apPlayers[SnappingClient] : 0;
+	if (!pPlayer or !pPlayer->m_Box2DSupport)
+	{
+		// demos and clients that don't know the box2d items
+		SnapLasers();
+		return;
+	}
+
+	CNetObj_Box2DBody *pBody = static_cast<CNetObj_Box2DBody *>(Server()->SnapNewItem(NETOBJTYPE_BOX2DBODY, GetID(), sizeof(CNetObj_Box2DBody)));
+	if(!pBody)
 		return;
 
+	*pBody = m_Keyframe;
+	if(OtherTeam)
+		pBody->m_Flags |= BOX2DBODYFLAG_OTHERTEAM;
+}
+
+void CBox2DBox::SnapLasers()
+{
 	CNetObj_Laser *pObj1 = static_cast<CNetObj_Laser *>(Server()->SnapNewItem(NETOBJTYPE_LASER, GetID(), sizeof(CNetObj_Laser)));
 	CNetObj_Laser *pObj2 = static_cast<CNetObj_Laser *>(Server()->SnapNewItem(NETOBJTYPE_LASER, m_ID2, sizeof(CNetObj_Laser)));
 	CNetObj_Laser *pObj3 = static_cast<CNetObj_Laser *>(Server()->SnapNewItem(NETOBJTYPE_LASER, m_ID3, sizeof(CNetObj_Laser)));
@@ -110,14 +159,7 @@ void CBox2DBox::Snap(int SnappingClient)
 	if(!pObj1 or !pObj2 or !pObj3 or !pObj4)
 		return;
 
-	float angle = m_Body->GetAngle(); // radians
-
-	// FUCK THIS MATH
-	for (int i=0; i<4; i++)
-	{
-		Rotate(&vertices[i], pos.x, pos.y, angle);
-	}
-
+	const vec2 *vertices = m_aVertices;
 	pObj1->m_X = (int)vertices[1].x;
 	pObj1->m_Y = (int)vertices[1].y;
 	pObj1->m_FromX = (int)vertices[0].x;
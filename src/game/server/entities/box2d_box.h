@@ -4,25 +4,51 @@
 #define GAME_SERVER_ENTITIES_BOX2D_BOX_H
 
 #include <box2d/box2d.h>
+#include <game/generated/protocol.h>
+#include <game/server/box2d_world.h>
 #include <game/server/entity.h>
 
 class CBox2DBox : public CEntity
 {
 public:
-	CBox2DBox(CGameWorld *pGameWorld, vec2 Pos, vec2 Size, float Angle, b2World* World, b2BodyType bodytype, float dens);
+	CBox2DBox(CGameWorld *pGameWorld, CBox2DWorld *pWorld, const CBox2DBodyState &Body);
 	~CBox2DBox();
 
 	virtual void Tick();
 	virtual void TickPaused();
+	virtual void PreSnap();
 	virtual void Snap(int SnappingClient);
+	// OtherTeam marks boxes of another team than the one the client sees
+	void SnapVisible(int SnappingClient, bool OtherTeam);
 
 	b2Body* getBody() { return m_Body; }
+	CBox2DWorld* getWorld() { return m_World; }
+	ivec2 getSize() const { return ivec2(round_to_int(m_Size.x), round_to_int(m_Size.y)); }
+
+	// where the box is in CGameContext::m_b2bodies, -1 once it's taken out
+	int m_BoxIndex;
+	// leaves the body to the world, for deleting the world right after
+	void ReleaseBody();
+	// identifies the box in the teehistorian, unique within its world
+	int m_HistoryID;
 
 private:
-	b2World* m_World;
+	CBox2DWorld* m_World;
 	b2Body* m_Body;
+	int m_SnapSlot;
+	int m_ShapeID;
 	vec2 m_Size;
 	int m_ID2, m_ID3, m_ID4; // for the other box corners
+
+	// what clients that support the box2d items extrapolate the box from
+	CNetObj_Box2DBody m_Keyframe;
+	void UpdateKeyframe();
+
+	// the corners for the lasers, computed before the clients are snapped
+	vec2 m_aVertices[4];
+	void UpdateVertices();
+
+	void SnapLasers();
 };
 
 #endif
@@ -87,50 +87,33 @@ bool CCharacter::Spawn(CPlayer *pPlayer, vec2 Pos)
 
 	Server()->StartRecord(m_pPlayer->GetCID());
 
-	// box2d
-	b2BodyDef BodyDef;
-	BodyDef.position = b2Vec2(m_Pos.x / 30.f, m_Pos.y / 30.f);
-	BodyDef.type = b2_dynamicBody;
-	m_b2Body = GameServer()->m_b2world->CreateBody(&BodyDef);
-
-	b2CircleShape Shape;
-	Shape.m_radius = 30 / 2 / 30.f;
-	b2FixtureDef FixtureDef;
-	FixtureDef.density = 1.f;
-	FixtureDef.shape = &Shape;
-	m_b2Body->CreateFixture(&FixtureDef);
-
-	// dummy body
-	b2BodyDef dBodyDef;
-	m_DummyBody = GameServer()->m_b2world->CreateBody(&dBodyDef);
-
-	b2MouseJointDef def;
-	def.bodyA = m_DummyBody;
-	def.bodyB = m_b2Body;
-	def.target = BodyDef.position;
-	def.maxForce = g_Config.m_B2TeeJointMaxForce;
-	def.damping = g_Config.m_B2TeeJointDamping;
-	def.stiffness = g_Config.m_B2TeeJointStiffness;
-	def.collideConnected = true;
-
-	m_TeeJoint = (b2MouseJoint *) GameServer()->m_b2world->CreateJoint(&def);
-	m_b2Body->SetAwake(true);
-
-	m_b2HammerTick = m_b2HammerTickAdd = 0;
+	CreateB2Body();
 
 	return true;
 }
 
+void CCharacter::CreateB2Body()
+{
+	CBox2DWorld *pWorld = GameServer()->B2World(Team());
+	if(GameServer()->TeeHistorianActive())
+		GameServer()->TeeHistorian()->RecordB2TeeCreate(m_pPlayer->GetCID(), Team(), m_Pos.x, m_Pos.y);
+	m_b2Tee.Create(pWorld, m_Pos);
+}
+
+void CCharacter::DestroyB2Body()
+{
+	if(m_b2Tee.Exists() && GameServer()->TeeHistorianActive())
+		GameServer()->TeeHistorian()->RecordB2TeeDestroy(m_pPlayer->GetCID());
+	m_b2Tee.Destroy();
+}
+
 void CCharacter::Destroy()
 {
 	GameServer()->m_World.m_Core.m_apCharacters[m_pPlayer->GetCID()] = 0;
 	m_Alive = false;
 	m_Solo = false;
 
-	if(m_b2Body) GameServer()->m_b2world->DestroyBody(m_b2Body);
-	if(m_DummyBody) GameServer()->m_b2world->DestroyBody(m_DummyBody);
-	m_b2Body = 0;
-	m_DummyBody = 0;
+	DestroyB2Body();
 }
 
 void CCharacter::SetWeapon(int W)
@@ -497,9 +480,9 @@ void CCharacter::FireWeapon()
 			Hits++;
 		}
 
-		m_b2HammerTick = 0;
-		m_b2HammerTickAdd = 10;
-		m_b2HammerJointDir = Direction;
+		if(GameServer()->TeeHistorianActive())
+			GameServer()->TeeHistorian()->RecordB2TeeHammer(m_pPlayer->GetCID(), Direction.x, Direction.y);
+		m_b2Tee.Hammer(Direction);
 
 		// if we Hit anything, we have to wait for the reload
 		if(Hits)
@@ -956,19 +939,12 @@ void CCharacter::TickDefered()
 		}
 	}
 
-	b2Vec2 pos(m_Core.m_Pos.x / 30.f, m_Core.m_Pos.y / 30.f);
-	if (m_TeeJoint)
+	// follow the character into the box2d world of its current team, the
+	// body follows it there in CGameContext::TickB2Worlds()
+	if(!m_b2Tee.Exists() || m_b2Tee.World() != GameServer()->m_apB2Worlds[Team()])
 	{
-		pos.x += ((m_b2HammerTick) * m_b2HammerJointDir.x) / 30.f;
-		pos.y += ((m_b2HammerTick) * m_b2HammerJointDir.y) / 30.f;
-
-		m_b2HammerTick += m_b2HammerTickAdd;
-		if (m_b2HammerTick >= 60)
-			m_b2HammerTickAdd = -20;
-		else if (m_b2HammerTick == 0)
-			m_b2HammerTickAdd = 0;
-
-		m_TeeJoint->SetTarget(pos);
+		DestroyB2Body();
+		CreateB2Body();
 	}
 }
 
@@ -1038,10 +1014,7 @@ void CCharacter::Die(int Killer, int Weapon)
 	GameServer()->CreateDeath(m_Pos, m_pPlayer->GetCID(), Teams()->TeamMask(Team(), -1, m_pPlayer->GetCID()));
 	Teams()->OnCharacterDeath(GetPlayer()->GetCID(), Weapon);
 
-	if(m_b2Body) GameServer()->m_b2world->DestroyBody(m_b2Body);
-	if(m_DummyBody) GameServer()->m_b2world->DestroyBody(m_DummyBody);
-	m_b2Body = 0;
-	m_DummyBody = 0;
+	DestroyB2Body();
 }
 
 bool CCharacter::TakeDamage(vec2 Force, int Dmg, int From, int Weapon)
@@ -1144,6 +1117,29 @@ bool CCharacter::TakeDamage(vec2 Force, int Dmg, int From, int Weapon)
 	return true;
 }
 
+void CCharacter::PreSnap()
+{
+	// This could probably happen when m_Jetpack changes instead
+	// jetpack and ninjajetpack prediction
+	bool Ninja = m_Core.m_ActiveWeapon == WEAPON_NINJA || m_DeepFreeze || m_FreezeTime > 0 || m_FreezeTime == -1;
+	if(m_Jetpack && !Ninja)
+	{
+		if(!(m_NeededFaketuning & FAKETUNE_JETPACK))
+		{
+			m_NeededFaketuning |= FAKETUNE_JETPACK;
+			GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone);
+		}
+	}
+	else
+	{
+		if(m_NeededFaketuning & FAKETUNE_JETPACK)
+		{
+			m_NeededFaketuning &= ~FAKETUNE_JETPACK;
+			GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone);
+		}
+	}
+}
+
 //TODO: Move the emote stuff to a function
 void CCharacter::SnapCharacter(int SnappingClient, int ID)
 {
@@ -1170,28 +1166,6 @@ void CCharacter::SnapCharacter(int SnappingClient, int ID)
 		Weapon = WEAPON_NINJA;
 	}
 
-	// This could probably happen when m_Jetpack changes instead
-	// jetpack and ninjajetpack prediction
-	if(m_pPlayer->GetCID() == SnappingClient)
-	{
-		if(m_Jetpack && Weapon != WEAPON_NINJA)
-		{
-			if(!(m_NeededFaketuning & FAKETUNE_JETPACK))
-			{
-				m_NeededFaketuning |= FAKETUNE_JETPACK;
-				GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone);
-			}
-		}
-		else
-		{
-			if(m_NeededFaketuning & FAKETUNE_JETPACK)
-			{
-				m_NeededFaketuning &= ~FAKETUNE_JETPACK;
-				GameServer()->SendTuningParams(m_pPlayer->GetCID(), m_TuneZone);
-			}
-		}
-	}
-
 	// change eyes, use ninja graphic and set ammo count if player has ninjajetpack
 	if(m_pPlayer->m_NinjaJetpack && m_Jetpack && m_Core.m_ActiveWeapon == WEAPON_GUN && !m_DeepFreeze && !(m_FreezeTime > 0 || m_FreezeTime == -1) && !m_Core.m_HasTelegunGun)
 	{
@@ -1235,8 +1209,9 @@ void CCharacter::SnapCharacter(int SnappingClient, int ID)
 		if (g_Config.m_B2TeeLaser && SnappingClient == m_pPlayer->GetCID())
 		{
 			CNetObj_Laser *pB2Body = static_cast<CNetObj_Laser *>(Server()->SnapNewItem(NETOBJTYPE_LASER, ID, sizeof(CNetObj_Laser)));
-			pB2Body->m_FromX = pB2Body->m_X = m_b2Body->GetPosition().x * 30.f;
-			pB2Body->m_FromY = pB2Body->m_Y = m_b2Body->GetPosition().y * 30.f;
+			vec2 B2Pos = m_b2Tee.SnapTransform().m_Pos;
+			pB2Body->m_FromX = pB2Body->m_X = B2Pos.x;
+			pB2Body->m_FromY = pB2Body->m_Y = B2Pos.y;
 			pB2Body->m_StartTick = Server()->Tick();
 		}
 
@@ -6,6 +6,7 @@
 #include <box2d/box2d.h>
 
 #include <engine/antibot.h>
+#include <game/server/box2d_tee.h>
 #include <game/server/entity.h>
 #include <game/server/save.h>
 
@@ -41,6 +42,7 @@ public:
 	virtual void Tick();
 	virtual void TickDefered();
 	virtual void TickPaused();
+	virtual void PreSnap();
 	virtual void Snap(int SnappingClient);
 
 	bool IsGrounded();
@@ -271,11 +273,11 @@ public:
 	bool HasTelegunGrenade() { return m_Core.m_HasTelegunGrenade; };
 	bool HasTelegunLaser() { return m_Core.m_HasTelegunLaser; };
 
-	b2Body* m_b2Body;
-	b2Body* m_DummyBody;
-	b2MouseJoint* m_TeeJoint;
-	vec2 m_b2HammerJointDir;
-	int m_b2HammerTick, m_b2HammerTickAdd;
+	// the body lives in the box2d world of the character's team
+	void CreateB2Body();
+	void DestroyB2Body();
+
+	CBox2DTee m_b2Tee;
 };
 
 enum
@@ -25,6 +25,7 @@ CDragger::CDragger(CGameWorld *pGameWorld, vec2 Pos, float Strength, bool NW,
 	m_CaughtTeam = CaughtTeam;
 	GameWorld()->InsertEntity(this);
 
+	mem_zero(m_SoloEnts, sizeof(m_SoloEnts));
 	for(int &SoloID : m_SoloIDs)
 	{
 		SoloID = -1;
@@ -133,6 +134,40 @@ void CDragger::Drag()
 	}
 }
 
+CDragger::~CDragger()
+{
+	for(int &SoloID : m_SoloIDs)
+	{
+		if(SoloID != -1)
+			Server()->SnapFreeID(SoloID);
+	}
+}
+
+void CDragger::UpdateSoloIDs()
+{
+	// one id for every solo character that may be snapped, several clients
+	// are snapped at once so they can't be taken while snapping
+	int NumSolo = 0;
+	for(auto *pSoloEnt : m_SoloEnts)
+	{
+		if(pSoloEnt)
+			NumSolo++;
+	}
+
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(i < NumSolo && m_SoloIDs[i] == -1)
+		{
+			m_SoloIDs[i] = Server()->SnapNewID();
+		}
+		else if(i >= NumSolo && m_SoloIDs[i] != -1)
+		{
+			Server()->SnapFreeID(m_SoloIDs[i]);
+			m_SoloIDs[i] = -1;
+		}
+	}
+}
+
 void CDragger::Reset()
 {
 	m_MarkedForDestroy = true;
@@ -156,7 +191,7 @@ void CDragger::Tick()
 		Move();
 	}
 	Drag();
-	return;
+	UpdateSoloIDs();
 }
 
 void CDragger::Snap(int SnappingClient)
@@ -166,15 +201,6 @@ void CDragger::Snap(int SnappingClient)
 
 	CCharacter *Target = m_Target;
 
-	for(int &SoloID : m_SoloIDs)
-	{
-		if(SoloID == -1)
-			break;
-
-		Server()->SnapFreeID(SoloID);
-		SoloID = -1;
-	}
-
 	int pos = 0;
 
 	for(int i = -1; i < MAX_CLIENTS; i++)
@@ -229,8 +255,10 @@ void CDragger::Snap(int SnappingClient)
 		}
 		else
 		{
-			m_SoloIDs[pos] = Server()->SnapNewID();
-			obj = static_cast<CNetObj_Laser *>(Server()->SnapNewItem( // TODO: Have to free IDs again?
+			// the ids are from the last tick
+			if(m_SoloIDs[pos] == -1)
+				continue;
+			obj = static_cast<CNetObj_Laser *>(Server()->SnapNewItem(
 				NETOBJTYPE_LASER, m_SoloIDs[pos], sizeof(CNetObj_Laser)));
 			pos++;
 		}
@@ -18,10 +18,12 @@ class CDragger : public CEntity
 
 	CCharacter *m_SoloEnts[MAX_CLIENTS];
 	int m_SoloIDs[MAX_CLIENTS];
+	void UpdateSoloIDs();
 
 public:
 	CDragger(CGameWorld *pGameWorld, vec2 Pos, float Strength, bool NW,
 		int CaughtTeam, int Layer = 0, int Number = 0);
+	~CDragger();
 
 	virtual void Reset();
 	virtual void Tick();
@@ -254,34 +254,27 @@ void CLaser::TickPaused()
 	++m_EvalTick;
 }
 
-void CLaser::Snap(int SnappingClient)
+void CLaser::PreSnap()
 {
-	if(NetworkClipped(SnappingClient))
-		return;
-	CCharacter *OwnerChar = 0;
-	if(m_Owner >= 0)
-		OwnerChar = GameServer()->GetPlayerChar(m_Owner);
-	if(!OwnerChar)
-		return;
-
 	CCharacter *pOwnerChar = 0;
-	int64_t TeamMask = -1LL;
-
 	if(m_Owner >= 0)
 		pOwnerChar = GameServer()->GetPlayerChar(m_Owner);
+	if(!pOwnerChar)
+		return;
 
-	if(pOwnerChar && pOwnerChar->IsAlive())
+	int64_t TeamMask = -1LL;
+	if(pOwnerChar->IsAlive())
 		TeamMask = pOwnerChar->Teams()->TeamMask(pOwnerChar->Team(), -1, m_Owner);
 
-	if(!CmaskIsSet(TeamMask, SnappingClient))
-		return;
-	CNetObj_Laser *pObj = static_cast<CNetObj_Laser *>(Server()->SnapNewItem(NETOBJTYPE_LASER, GetID(), sizeof(CNetObj_Laser)));
-	if(!pObj)
-		return;
-
+	CNetObj_Laser *pObj = static_cast<CNetObj_Laser *>(GameServer()->m_SnapItems.Create(NETOBJTYPE_LASER, GetID(), sizeof(CNetObj_Laser), m_Pos, TeamMask));
 	pObj->m_X = (int)m_Pos.x;
 	pObj->m_Y = (int)m_Pos.y;
 	pObj->m_FromX = (int)m_From.x;
 	pObj->m_FromY = (int)m_From.y;
 	pObj->m_StartTick = m_EvalTick;
 }
+
+void CLaser::Snap(int SnappingClient)
+{
+	// the laser is the same for every client that sees it, see PreSnap()
+}
@@ -17,6 +17,7 @@ CPickup::CPickup(CGameWorld *pGameWorld, int Type, int SubType, int Layer, int N
 
 	m_Layer = Layer;
 	m_Number = Number;
+	m_SnapShared = false;
 
 	Reset();
 
@@ -149,8 +150,44 @@ void CPickup::TickPaused()
 		++m_SpawnTick;*/
 }
 
+void CPickup::FillInfo(CNetObj_Pickup *pP, bool Sixup)
+{
+	pP->m_X = (int)m_Pos.x;
+	pP->m_Y = (int)m_Pos.y;
+	pP->m_Type = m_Type;
+	if(Sixup)
+	{
+		if(m_Type == POWERUP_WEAPON)
+			pP->m_Type = m_Subtype == WEAPON_SHOTGUN ? 3 : m_Subtype == WEAPON_GRENADE ? 2 : 4;
+		else if(m_Type == POWERUP_NINJA)
+			pP->m_Type = 5;
+	}
+	else
+		pP->m_Subtype = m_Subtype;
+}
+
+void CPickup::PreSnap()
+{
+	// on a switch layer, it blinks for the teams the switch is off for
+	int Tick = (Server()->Tick() % Server()->TickSpeed()) % 11;
+	m_SnapShared = !(m_Layer == LAYER_SWITCH && m_Number > 0 && !Tick);
+	if(!m_SnapShared)
+		return;
+
+	// pickups aren't clipped, see Snap()
+	CSnapItems *pSnapItems = &GameServer()->m_SnapItems;
+	int64_t SixupClients = pSnapItems->SixupClients();
+	FillInfo(static_cast<CNetObj_Pickup *>(pSnapItems->Create(NETOBJTYPE_PICKUP, GetID(), sizeof(CNetObj_Pickup), m_Pos, ~SixupClients, true, false)), false);
+	if(SixupClients)
+		FillInfo(static_cast<CNetObj_Pickup *>(pSnapItems->Create(NETOBJTYPE_PICKUP, GetID(), 3 * 4, m_Pos, SixupClients, false, false)), true);
+}
+
 void CPickup::Snap(int SnappingClient)
 {
+	// the same for every client unless it blinks, see PreSnap()
+	if(m_SnapShared)
+		return;
+
 	/*if(m_SpawnTick != -1 || NetworkClipped(SnappingClient))
 		return;*/
 
@@ -171,18 +208,7 @@ void CPickup::Snap(int SnappingClient)
 	if(!pP)
 		return;
 
-	pP->m_X = (int)m_Pos.x;
-	pP->m_Y = (int)m_Pos.y;
-	pP->m_Type = m_Type;
-	if(Server()->IsSixup(SnappingClient))
-	{
-		if(m_Type == POWERUP_WEAPON)
-			pP->m_Type = m_Subtype == WEAPON_SHOTGUN ? 3 : m_Subtype == WEAPON_GRENADE ? 2 : 4;
-		else if(m_Type == POWERUP_NINJA)
-			pP->m_Type = 5;
-	}
-	else
-		pP->m_Subtype = m_Subtype;
+	FillInfo(pP, Server()->IsSixup(SnappingClient));
 }
 
 void CPickup::Move()
@@ -15,11 +15,16 @@ public:
 	virtual void Reset();
 	virtual void Tick();
 	virtual void TickPaused();
+	virtual void PreSnap();
 	virtual void Snap(int SnappingClient);
 
 private:
 	int m_Type;
 	int m_Subtype;
+
+	// whether PreSnap() added the pickup for all clients
+	bool m_SnapShared;
+	void FillInfo(CNetObj_Pickup *pP, bool Sixup);
 	//int m_SpawnTick;
 
 	// DDRace
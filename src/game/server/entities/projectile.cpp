@@ -10,6 +10,7 @@
 #include <engine/shared/config.h>
 #include <game/server/teams.h>
 
+#include "box2d_box.h"
 #include "character.h"
 
 #include <box2d/box2d.h>
@@ -46,6 +47,10 @@ CProjectile::CProjectile(
 
 	m_TuneZone = GameServer()->Collision()->IsTune(GameServer()->Collision()->GetMapIndex(m_Pos));
 
+	m_B2RayTick = -1;
+	m_pB2HitBox = 0;
+	m_SnapShared = false;
+
 	GameWorld()->InsertEntity(this);
 }
 
@@ -107,6 +112,33 @@ vec2 CProjectile::GetPos(float Time)
 	return CalcPos(m_Pos, m_Direction, Curvature, Speed, Time);
 }
 
+void CProjectile::CastB2Ray()
+{
+	m_B2RayTick = Server()->Tick();
+	m_pB2HitBox = 0;
+
+	CBox2DWorld *pB2World = GameServer()->m_apB2Worlds[m_Owner >= 0 ? GameServer()->GetDDRaceTeam(m_Owner) : (int)TEAM_FLOCK];
+	if(!pB2World)
+		return;
+
+	float Pt = (Server()->Tick() - m_StartTick - 1) / (float)Server()->TickSpeed();
+	float Ct = (Server()->Tick() - m_StartTick) / (float)Server()->TickSpeed();
+	b2Vec2 From(GetPos(Pt).x / B2_SCALE, GetPos(Pt).y / B2_SCALE);
+	b2Vec2 To(GetPos(Ct).x / B2_SCALE, GetPos(Ct).y / B2_SCALE);
+	if((To - From).LengthSquared() < b2_epsilon)
+		return;
+
+	BodySweepRay Ray;
+	Ray.m_pBox = 0;
+	pB2World->RayCast(&Ray, From, To);
+	if(!Ray.m_pBox)
+		return;
+
+	m_pB2HitBox = Ray.m_pBox;
+	m_B2HitPos = vec2(Ray.m_point.x * B2_SCALE, Ray.m_point.y * B2_SCALE);
+	m_B2HitNormal = vec2(Ray.m_normal.x, Ray.m_normal.y);
+}
+
 void CProjectile::Tick()
 {
 	float Pt = (Server()->Tick() - m_StartTick - 1) / (float)Server()->TickSpeed();
@@ -118,6 +150,18 @@ void CProjectile::Tick()
 	int Collide = GameServer()->Collision()->IntersectLine(PrevPos, CurPos, &ColPos, &NewPos);
 	CCharacter *pOwnerChar = 0;
 
+	// projectiles fired during this tick missed the batched rays
+	if(m_B2RayTick != Server()->Tick())
+		CastB2Ray();
+	bool B2Hit = m_pB2HitBox && distance(PrevPos, m_B2HitPos) < distance(PrevPos, ColPos);
+	if(B2Hit)
+	{
+		// the box is in front of the wall. stay a bit outside of it, so
+		// the rays of an explosion here don't start within the box
+		ColPos = m_B2HitPos + m_B2HitNormal * 2.0f;
+		Collide = 0;
+	}
+
 	if(m_Owner >= 0)
 		pOwnerChar = GameServer()->GetPlayerChar(m_Owner);
 
@@ -129,15 +173,6 @@ void CProjectile::Tick()
 	if(m_LifeSpan > -1)
 		m_LifeSpan--;
 
-	BodyCollideQuery queryCallback;
-	b2Vec2 b2Pos(ColPos.x / 30.f, ColPos.y / 30.f);
-	queryCallback.Body = 0;
-	queryCallback.findPos = b2Pos;
-	b2AABB aabb;
-	aabb.lowerBound = b2Vec2(b2Pos.x - 0.001, b2Pos.y - 0.001);
-	aabb.upperBound = b2Vec2(b2Pos.x + 0.001, b2Pos.y + 0.001);
-	GameServer()->m_b2world->QueryAABB(&queryCallback, aabb);
-
 	int64_t TeamMask = -1LL;
 	bool IsWeaponCollide = false;
 	if(
@@ -159,8 +194,20 @@ void CProjectile::Tick()
 		return;
 	}
 
-	if(((pTargetChr && (pOwnerChar ? !(pOwnerChar->m_Hit & CCharacter::DISABLE_HIT_GRENADE) : g_Config.m_SvHit || m_Owner == -1 || pTargetChr == pOwnerChar)) || Collide || GameLayerClipped(CurPos) || queryCallback.Body) && !IsWeaponCollide)
+	if(((pTargetChr && (pOwnerChar ? !(pOwnerChar->m_Hit & CCharacter::DISABLE_HIT_GRENADE) : g_Config.m_SvHit || m_Owner == -1 || pTargetChr == pOwnerChar)) || Collide || GameLayerClipped(CurPos) || B2Hit) && !IsWeaponCollide)
 	{
+		if(B2Hit && !pTargetChr)
+		{
+			b2Body *pBody = m_pB2HitBox->getBody();
+			if(pBody->GetType() == b2_dynamicBody)
+			{
+				vec2 Impulse = normalize(CurPos - PrevPos) * (float)g_Config.m_B2ProjectileImpulse;
+				if(GameServer()->TeeHistorianActive())
+					GameServer()->TeeHistorian()->RecordB2Impulse(GameServer()->B2WorldTeam(m_pB2HitBox->getWorld()), m_pB2HitBox->m_HistoryID, Impulse.x, Impulse.y, m_B2HitPos.x / B2_SCALE, m_B2HitPos.y / B2_SCALE);
+				pBody->ApplyLinearImpulse(b2Vec2(Impulse.x, Impulse.y), b2Vec2(m_B2HitPos.x / B2_SCALE, m_B2HitPos.y / B2_SCALE), true);
+			}
+		}
+
 		if(m_Explosive /*??*/ && (!pTargetChr || (pTargetChr && (!m_Freeze || (m_Type == WEAPON_SHOTGUN && Collide)))))
 		{
 			int Number = 1;
@@ -307,8 +354,56 @@ void CProjectile::FillInfo(CNetObj_Projectile *pProj)
 	pProj->m_Type = m_Type;
 }
 
+void CProjectile::PreSnap()
+{
+	// on a switch layer, it blinks for the teams the switch is off for
+	int Tick = (Server()->Tick() % Server()->TickSpeed()) % ((m_Explosive) ? 6 : 20);
+	m_SnapShared = !(m_Layer == LAYER_SWITCH && m_Number > 0 && !Tick);
+	if(!m_SnapShared)
+		return;
+
+	CCharacter *pOwnerChar = 0;
+	int64_t TeamMask = -1LL;
+
+	if(m_Owner >= 0)
+		pOwnerChar = GameServer()->GetPlayerChar(m_Owner);
+
+	if(pOwnerChar && pOwnerChar->IsAlive())
+		TeamMask = pOwnerChar->Teams()->TeamMask(pOwnerChar->Team(), -1, m_Owner);
+
+	float Ct = (Server()->Tick() - m_StartTick) / (float)Server()->TickSpeed();
+	vec2 Pos = GetPos(Ct);
+	CSnapItems *pSnapItems = &GameServer()->m_SnapItems;
+
+	// one item for each kind of client
+	CNetObj_DDNetProjectile DDNetProjectile;
+	bool ExtraInfo = FillExtraInfo(&DDNetProjectile);
+	if(ExtraInfo)
+	{
+		int64_t AntipingClients = TeamMask & pSnapItems->ClientsFromVersion(VERSION_DDNET_ANTIPING_PROJECTILE);
+		int64_t NewClients = TeamMask & pSnapItems->ClientsFromVersion(VERSION_DDNET_MSG_LEGACY);
+		void *pProj = pSnapItems->Create(NETOBJTYPE_DDNETPROJECTILE, GetID(), sizeof(DDNetProjectile), Pos, NewClients);
+		mem_copy(pProj, &DDNetProjectile, sizeof(DDNetProjectile));
+		if(AntipingClients & ~NewClients)
+		{
+			pProj = pSnapItems->Create(NETOBJTYPE_PROJECTILE, GetID(), sizeof(DDNetProjectile), Pos, AntipingClients & ~NewClients, false);
+			mem_copy(pProj, &DDNetProjectile, sizeof(DDNetProjectile));
+		}
+		TeamMask &= ~AntipingClients;
+	}
+	if(TeamMask || !ExtraInfo)
+	{
+		CNetObj_Projectile *pProj = static_cast<CNetObj_Projectile *>(pSnapItems->Create(NETOBJTYPE_PROJECTILE, GetID(), sizeof(CNetObj_Projectile), Pos, TeamMask, !ExtraInfo));
+		FillInfo(pProj);
+	}
+}
+
 void CProjectile::Snap(int SnappingClient)
 {
+	// the same for every client that sees it unless it blinks, see PreSnap()
+	if(m_SnapShared)
+		return;
+
 	float Ct = (Server()->Tick() - m_StartTick) / (float)Server()->TickSpeed();
 
 	if(NetworkClipped(SnappingClient, GetPos(Ct)))
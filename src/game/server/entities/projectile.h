@@ -28,6 +28,7 @@ public:
 	virtual void Reset();
 	virtual void Tick();
 	virtual void TickPaused();
+	virtual void PreSnap();
 	virtual void Snap(int SnappingClient);
 
 private:
@@ -47,8 +48,18 @@ private:
 	bool m_Freeze;
 	int m_TuneZone;
 
+	// whether PreSnap() added the projectile for all clients
+	bool m_SnapShared;
+
+	// the box hit on the way to the current position, if any
+	int m_B2RayTick;
+	class CBox2DBox *m_pB2HitBox;
+	vec2 m_B2HitPos;
+	vec2 m_B2HitNormal;
+
 public:
 	void SetBouncing(int Value);
+	void CastB2Ray();
 	bool FillExtraInfo(CNetObj_DDNetProjectile *pProj);
 };
 
@@ -101,6 +101,16 @@ public:
 	*/
 	virtual void TickPaused() {}
 
+	/*
+		Function: PreSnap
+			Called once before the snapshots of the clients are
+			generated. The clients are snapped from several threads at
+			once, so whatever would change the entity while snapping
+			happens here, and items that are the same for every client
+			that sees them are added to CGameContext::m_SnapItems.
+	*/
+	virtual void PreSnap() {}
+
 	/*
 		Function: Snap
 			Called when a new snapshot is being generated for a specific
@@ -68,7 +68,8 @@ void CEventHandler::Snap(int SnappingClient)
 
 void CEventHandler::EventToSixup(int *Type, int *Size, const char **pData)
 {
-	static char s_aEventStore[128];
+	// per thread, several clients are snapped at once
+	static thread_local char s_aEventStore[128];
 	if(*Type == NETEVENTTYPE_DAMAGEIND)
 	{
 		const CNetEvent_DamageInd *pEvent = (const CNetEvent_DamageInd *)(*pData);
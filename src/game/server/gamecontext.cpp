@@ -12,19 +12,25 @@
 #include <engine/server/server.h>
 #include <engine/shared/config.h>
 #include <engine/shared/datafile.h>
+#include <engine/shared/jobs.h>
 #include <engine/shared/linereader.h>
 #include <engine/shared/memheap.h>
 #include <engine/storage.h>
 #include <game/collision.h>
+#include <game/box2d_map.h>
 #include <game/gamecore.h>
 #include <game/version.h>
 #include <string.h>
+#include <unordered_map>
 
 #include <game/generated/protocol7.h>
 #include <game/generated/protocolglue.h>
 
 #include "entities/character.h"
+#include "box2d_history.h"
+#include "box2d_prefab.h"
 #include "entities/box2d_box.h"
+#include "entities/projectile.h"
 #include "gamemodes/DDRace.h"
 #include "player.h"
 #include "score.h"
@@ -65,12 +71,30 @@ void CGameContext::Construct(int Resetting)
 	m_aDeleteTempfile[0] = 0;
 	m_TeeHistorianActive = false;
 
-	b2Vec2 gravity(0.f, 9.81f);
-	m_b2world = new b2World(gravity);
+	for(int i = 0; i < MAX_CLIENTS + 1; i++)
+		m_apB2Worlds[i] = 0;
+	for(auto &pWorld : m_apB2ViewWorlds)
+		pWorld = 0;
+	m_pB2JobPool = 0;
+	m_B2JobPoolThreads = 0;
+	m_B2NumCulled = 0;
+	m_B2NumContactEvents = 0;
+	m_B2NumDroppedContactEvents = 0;
+	m_B2ReloadMapSha256 = SHA256_ZEROED;
+	m_B2MapSha256 = SHA256_ZEROED;
+	m_B2TickStart = 0;
 }
 
 void CGameContext::Destruct(int Resetting)
 {
+	// before the players, their characters may have bodies in the worlds
+	for(int i = 0; i < MAX_CLIENTS + 1; i++)
+	{
+		if(m_apB2Worlds[i])
+			DestroyB2World(i);
+	}
+	delete m_pB2JobPool;
+
 	for(auto &pPlayer : m_apPlayers)
 		delete pPlayer;
 
@@ -83,19 +107,16 @@ void CGameContext::Destruct(int Resetting)
 		m_pScore = nullptr;
 	}
 
-	if (m_b2world)
-	{
-		delete m_b2world;
-		m_b2world = NULL;
-	}
 }
 
-CGameContext::CGameContext()
+CGameContext::CGameContext() :
+	m_B2Profile(SERVER_TICK_SPEED * 10)
 {
 	Construct(NO_RESET);
 }
 
-CGameContext::CGameContext(int Reset)
+CGameContext::CGameContext(int Reset) :
+	m_B2Profile(SERVER_TICK_SPEED * 10)
 {
 	Construct(Reset);
 }
@@ -112,6 +133,12 @@ void CGameContext::Clear()
 	CVoteOptionServer *pVoteOptionLast = m_pVoteOptionLast;
 	int NumVoteOptions = m_NumVoteOptions;
 	CTuningParams Tuning = m_Tuning;
+	// the ddrace teams don't survive a map change, so only the boxes outside
+	// of them are kept
+	CBox2DWorldState B2ReloadState;
+	if(g_Config.m_B2KeepOnReload && m_apB2Worlds[TEAM_FLOCK])
+		SaveB2World(TEAM_FLOCK, &B2ReloadState);
+	SHA256_DIGEST B2MapSha256 = m_B2MapSha256;
 
 	m_Resetting = true;
 	this->~CGameContext();
@@ -122,6 +149,8 @@ void CGameContext::Clear()
 	m_pVoteOptionLast = pVoteOptionLast;
 	m_NumVoteOptions = NumVoteOptions;
 	m_Tuning = Tuning;
+	m_B2ReloadState = std::move(B2ReloadState);
+	m_B2ReloadMapSha256 = B2MapSha256;
 }
 
 void CGameContext::TeeHistorianWrite(const void *pData, int DataSize, void *pUser)
@@ -278,39 +307,13 @@ void CGameContext::CreateExplosion(vec2 Pos, int Owner, int Weapon, bool NoDamag
 	}
 
 	// apply force to box2d objects
-	b2Vec2 b2Pos(Pos.x / 30.f, Pos.y / 30.f);
-	b2Vec2 b2Rad((Radius) / 30.f, (Radius) / 30.f);
-	Strength = Tuning()->m_ExplosionStrength;
-
-	int numRays = 32;
-	for (int i=0; i<numRays; i++)
+	int B2Team = Owner >= 0 ? GetDDRaceTeam(Owner) : ActivatedTeam >= 0 ? ActivatedTeam : (int)TEAM_FLOCK;
+	if(m_apB2Worlds[B2Team])
 	{
-		float angle = ((i / (float)numRays) * 360) / 180.f * b2_pi;
-		b2Vec2 rayDir(sinf(angle), cosf(angle));
-
-		// use a "particle" system, essentially very tiny circles, that hits objects at high speeds
-		b2BodyDef bd;
-		bd.type = b2_dynamicBody;
-		bd.fixedRotation = true; // don't rotate
-		bd.bullet = true; // avoid tunneling at high speed
-		bd.linearDamping = 10; // slow down
-		bd.gravityScale = 0; // don't be affected by gravity
-		bd.position = b2Pos;
-		bd.linearVelocity = (Strength * 30.f) * rayDir;
-		b2Body* body = m_b2world->CreateBody(&bd);
-
-		b2CircleShape circle;
-		circle.m_radius = 0.05; // ok so basically i'm very... you get the drill
-
-		b2FixtureDef fd;
-		fd.shape = &circle;
-		fd.density = 60 / (float)numRays;
-		fd.friction = 0;
-		fd.restitution = 0.99f;
-		fd.filter.groupIndex = -1;
-		body->CreateFixture(&fd);
-
-		m_b2explosions.push_back(body);
+		b2Vec2 b2Pos(Pos.x / 30.f, Pos.y / 30.f);
+		if(m_TeeHistorianActive)
+			m_TeeHistorian.RecordB2Explosion(B2Team, b2Pos.x, b2Pos.y, Tuning()->m_ExplosionStrength, g_Config.m_B2ExplosionMode);
+		m_apB2Worlds[B2Team]->m_Explosions.Create(b2Pos, Tuning()->m_ExplosionStrength, g_Config.m_B2ExplosionMode);
 	}
 }
 
@@ -811,6 +814,12 @@ void CGameContext::SendTuningParams(int ClientID, int Zone)
 
 void CGameContext::OnTick()
 {
+	m_B2TickStart = time_get();
+	// wait for the box2d steps started last tick before anything touches the
+	// worlds. their contacts are handled here, so the sounds and the pushes
+	// are part of this tick
+	SyncB2Worlds(true);
+
 	// check tuning
 	CheckPureTuning();
 
@@ -834,6 +843,7 @@ void CGameContext::OnTick()
 
 	// copy tuning
 	m_World.m_Core.m_Tuning[0] = m_Tuning;
+	CastB2Projectiles();
 	m_World.Tick();
 
 	//if(world.paused) // make sure that the game object always updates
@@ -1107,19 +1117,7 @@ void CGameContext::OnTick()
 		m_SqlRandomMapResult = nullptr;
 	}
 
-	if (m_b2world)
-	{
-		m_b2world->Step(1. / g_Config.m_B2WorldFps, 8, 3);
-		for (unsigned i=0; i<m_b2explosions.size(); i++)
-		{
-			if (m_b2explosions[i]->GetLinearVelocity().x < 5.f and m_b2explosions[i]->GetLinearVelocity().y < 5.f) // delete
-			{
-				m_b2world->DestroyBody(m_b2explosions[i]);
-				m_b2explosions.erase(m_b2explosions.begin() + i);
-				--i;
-			}
-		}
-	}
+	TickB2Worlds();
 
 #ifdef CONF_DEBUG
 	if(g_Config.m_DbgDummies)
@@ -2239,6 +2237,10 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 			CNetMsg_Cl_ShowDistance *pMsg = (CNetMsg_Cl_ShowDistance *)pRawMsg;
 			pPlayer->m_ShowDistance = vec2(pMsg->m_X, pMsg->m_Y);
 		}
+		else if(MsgID == NETMSGTYPE_CL_BOX2DSUPPORT)
+		{
+			pPlayer->m_Box2DSupport = true;
+		}
 		else if(MsgID == NETMSGTYPE_CL_SETSPECTATORMODE && !m_World.m_Paused)
 		{
 			CNetMsg_Cl_SetSpectatorMode *pMsg = (CNetMsg_Cl_SetSpectatorMode *)pRawMsg;
@@ -3072,15 +3074,35 @@ void CGameContext::ConVote(IConsole::IResult *pResult, void *pUserData)
 		pSelf->ForceVote(pResult->m_ClientID, false);
 }
 
+static CBox2DBodyState B2BoxState(vec2 Pos, ivec2 Size, float Angle, b2BodyType Type, float Density)
+{
+	CBox2DBodyState Body;
+	Body.m_Type = Type;
+	Body.m_Pos = Pos;
+	Body.m_Angle = Angle;
+	Body.m_Vel = vec2(0, 0);
+	Body.m_AngularVel = 0.0f;
+	Body.m_Size = Size;
+	Body.m_Density = Density;
+	Body.m_Friction = 0.2f;
+	return Body;
+}
+
 void CGameContext::ConB2CreateBox(IConsole::IResult *pResult, void *pUserData)
 {
 	CGameContext *pSelf = (CGameContext *)pUserData;
 
 	CCharacter *Char = pSelf->GetPlayerChar(pResult->m_ClientID);
 	if (not Char) return;
+	if(!pSelf->B2CanCreateBox())
+	{
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", "Too many boxes, see b2_max_boxes");
+		return;
+	}
 
-	vec2 size(pResult->GetInteger(0), pResult->GetInteger(1));
-	pSelf->m_b2bodies.push_back(new CBox2DBox(&pSelf->m_World, vec2(Char->m_Pos.x, Char->m_Pos.y-128), size, 0, pSelf->m_b2world, b2_dynamicBody, 1.f));
+	CBox2DWorldState State;
+	State.m_vBodies.push_back(B2BoxState(vec2(Char->m_Pos.x, Char->m_Pos.y-128), ivec2(pResult->GetInteger(0), pResult->GetInteger(1)), 0, b2_dynamicBody, 1.f));
+	pSelf->AddB2Boxes(pSelf->B2World(Char->Team()), State);
 	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", "Created box above you");
 }
 
@@ -3090,10 +3112,16 @@ void CGameContext::ConB2CreateGround(IConsole::IResult *pResult, void *pUserData
 
 	CCharacter *Char = pSelf->GetPlayerChar(pResult->m_ClientID);
 	if (not Char) return;
+	if(!pSelf->B2CanCreateBox())
+	{
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", "Too many boxes, see b2_max_boxes");
+		return;
+	}
 
-	vec2 size(pResult->GetInteger(0), pResult->GetInteger(1));
 	float angle = ((pResult->NumArguments() >= 2) ? pResult->GetInteger(2) : 0) / 180 * b2_pi;
-	pSelf->m_b2bodies.push_back(new CBox2DBox(&pSelf->m_World, vec2(Char->m_Pos.x, Char->m_Pos.y+28), size, angle, pSelf->m_b2world, b2_kinematicBody, 0.f));
+	CBox2DWorldState State;
+	State.m_vBodies.push_back(B2BoxState(vec2(Char->m_Pos.x, Char->m_Pos.y+28), ivec2(pResult->GetInteger(0), pResult->GetInteger(1)), angle, b2_kinematicBody, 0.f));
+	pSelf->AddB2Boxes(pSelf->B2World(Char->Team()), State);
 
 	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", "Created ground");
 }
@@ -3102,16 +3130,176 @@ void CGameContext::ConB2ClearWorld(IConsole::IResult *pResult, void *pUserData)
 {
 	CGameContext *pSelf = (CGameContext *)pUserData;
 
-	for (unsigned i=0; i<pSelf->m_b2bodies.size(); i++)
+	for(auto *pWorld : pSelf->m_apB2Worlds)
 	{
-		if (pSelf->m_b2bodies[i])
-			delete pSelf->m_b2bodies[i];
+		if(pWorld)
+			pSelf->ClearB2Boxes(pWorld);
 	}
-	pSelf->m_b2bodies.clear();
 
 	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", "Cleared world");
 }
 
+void CGameContext::ConB2Status(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+
+	int NumWorlds = 0;
+	for(auto *pWorld : pSelf->m_apB2Worlds)
+		NumWorlds += pWorld != 0;
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "worlds=%d boxes=%d culled=%d quality_level=%d iterations=%d/%d contact_events=%d dropped_events=%d", NumWorlds, (int)pSelf->m_b2bodies.size(), pSelf->m_B2NumCulled,
+		pSelf->m_B2Governor.Level(), pSelf->m_B2Governor.VelocityIterations(), pSelf->m_B2Governor.PositionIterations(),
+		pSelf->m_B2NumContactEvents, pSelf->m_B2NumDroppedContactEvents);
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+}
+
+static int B2ConsoleTeam(CGameContext *pSelf, IConsole::IResult *pResult)
+{
+	if(pResult->NumArguments() > 1)
+		return clamp(pResult->GetInteger(1), (int)TEAM_FLOCK, (int)TEAM_SUPER);
+	CCharacter *pChr = pSelf->GetPlayerChar(pResult->m_ClientID);
+	return pChr ? pChr->Team() : (int)TEAM_FLOCK;
+}
+
+void CGameContext::ConB2SaveWorld(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+
+	CBox2DWorldState State;
+	pSelf->SaveB2World(B2ConsoleTeam(pSelf, pResult), &State);
+	std::vector<unsigned char> vData;
+	State.Pack(vData);
+
+	char aBuf[256];
+	IOHANDLE File = pSelf->Storage()->OpenFile(pResult->GetString(0), IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+	{
+		str_format(aBuf, sizeof(aBuf), "failed to open '%s' for writing", pResult->GetString(0));
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+		return;
+	}
+	io_write(File, vData.data(), vData.size());
+	io_close(File);
+
+	str_format(aBuf, sizeof(aBuf), "saved %d boxes and %d joints (%d bytes)", (int)State.m_vBodies.size(), (int)State.m_vJoints.size(), (int)vData.size());
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+}
+
+void CGameContext::ConB2LoadWorld(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+
+	char aBuf[256];
+	IOHANDLE File = pSelf->Storage()->OpenFile(pResult->GetString(0), IOFLAG_READ, IStorage::TYPE_SAVE);
+	if(!File)
+	{
+		str_format(aBuf, sizeof(aBuf), "failed to open '%s'", pResult->GetString(0));
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+		return;
+	}
+	long Length = io_length(File);
+	std::vector<unsigned char> vData(maximum(Length, 0L));
+	unsigned Read = io_read(File, vData.data(), vData.size());
+	io_close(File);
+
+	CBox2DWorldState State;
+	if(Length < 0 || Read != vData.size() || !State.Unpack(vData.data(), vData.size()))
+	{
+		str_format(aBuf, sizeof(aBuf), "'%s' is not a valid box2d world", pResult->GetString(0));
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+		return;
+	}
+
+	pSelf->LoadB2World(B2ConsoleTeam(pSelf, pResult), State);
+	str_format(aBuf, sizeof(aBuf), "loaded %d boxes and %d joints", (int)State.m_vBodies.size(), (int)State.m_vJoints.size());
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+}
+
+void CGameContext::ConB2Prefab(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+
+	CCharacter *Char = pSelf->GetPlayerChar(pResult->m_ClientID);
+	if (not Char) return;
+
+	char aBuf[256];
+	IOHANDLE File = pSelf->Storage()->OpenFile(pResult->GetString(0), IOFLAG_READ, IStorage::TYPE_ALL);
+	if(!File)
+	{
+		str_format(aBuf, sizeof(aBuf), "failed to open '%s'", pResult->GetString(0));
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+		return;
+	}
+	long Length = io_length(File);
+	std::vector<char> vData(maximum(Length, 0L));
+	unsigned Read = io_read(File, vData.data(), vData.size());
+	io_close(File);
+
+	CBox2DPrefab Prefab;
+	char aError[128] = "read error";
+	if(Length < 0 || Read != vData.size() || !Prefab.FromJson(vData.data(), vData.size(), aError, sizeof(aError)))
+	{
+		str_format(aBuf, sizeof(aBuf), "'%s' is not a valid prefab: %s", pResult->GetString(0), aError);
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+		return;
+	}
+
+	int Columns = pResult->NumArguments() > 1 ? clamp(pResult->GetInteger(1), 1, 100) : 1;
+	int Rows = pResult->NumArguments() > 2 ? clamp(pResult->GetInteger(2), 1, 100) : 1;
+	int Spacing = pResult->NumArguments() > 3 ? maximum(pResult->GetInteger(3), 0) : 0;
+	int NumBoxes = Prefab.State().m_vBodies.size() * Columns * Rows;
+	if(NumBoxes > CBox2DPrefab::MAX_BOXES)
+	{
+		str_format(aBuf, sizeof(aBuf), "%d boxes are too many, at most %d can be created at once", NumBoxes, (int)CBox2DPrefab::MAX_BOXES);
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+		return;
+	}
+	CBox2DWorldState State;
+	State.m_vBodies.reserve(Prefab.State().m_vBodies.size() * Columns * Rows);
+	State.m_vJoints.reserve(Prefab.State().m_vJoints.size() * Columns * Rows);
+	Prefab.Instantiate(&State, vec2(Char->m_Pos.x, Char->m_Pos.y - 128), Columns, Rows, Spacing);
+
+	int Created = pSelf->AddB2Boxes(pSelf->B2World(Char->Team()), State);
+	str_format(aBuf, sizeof(aBuf), "created %d of %d boxes", Created, (int)State.m_vBodies.size());
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+}
+
+void CGameContext::ConB2Profile(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+	const CBox2DProfile &Profile = pSelf->m_B2Profile;
+
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "last %d ticks, times in ms", Profile.NumSamples());
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+	for(int i = 0; i < CBox2DProfileSample::NUM_VALUES; i++)
+	{
+		str_format(aBuf, sizeof(aBuf), "%s: p50=%.3f p95=%.3f p99=%.3f max=%.3f", CBox2DProfileSample::Name(i),
+			Profile.Percentile(i, 0.5f), Profile.Percentile(i, 0.95f), Profile.Percentile(i, 0.99f), Profile.Percentile(i, 1.0f));
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+	}
+}
+
+void CGameContext::ConB2ProfileCsv(IConsole::IResult *pResult, void *pUserData)
+{
+	CGameContext *pSelf = (CGameContext *)pUserData;
+
+	char aBuf[256];
+	IOHANDLE File = pSelf->Storage()->OpenFile(pResult->GetString(0), IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+	{
+		str_format(aBuf, sizeof(aBuf), "failed to open '%s' for writing", pResult->GetString(0));
+		pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+		return;
+	}
+	pSelf->m_B2Profile.WriteCsv(File);
+	io_close(File);
+
+	str_format(aBuf, sizeof(aBuf), "wrote %d ticks to '%s'", pSelf->m_B2Profile.NumSamples(), pResult->GetString(0));
+	pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+}
+
 void CGameContext::ConchainSpecialMotdupdate(IConsole::IResult *pResult, void *pUserData, IConsole::FCommandCallback pfnCallback, void *pCallbackUserData)
 {
 	pfnCallback(pResult, pCallbackUserData);
@@ -3164,6 +3352,12 @@ void CGameContext::OnConsoleInit()
 	Console()->Register("b2_create_box", "i[width] i[height]", CFGFLAG_SERVER, ConB2CreateBox, this, "create a box in the Box2D world using your current position");
 	Console()->Register("b2_create_ground", "i[width] i[height] ?i[angle OPTIONAL]", CFGFLAG_SERVER, ConB2CreateGround, this, "create ground in the Box2D world using your current position");
 	Console()->Register("b2_clear_world", "", CFGFLAG_SERVER, ConB2ClearWorld, this, "clear all bodies (except tee bodies) in the Box2D world");
+	Console()->Register("b2_status", "", CFGFLAG_SERVER, ConB2Status, this, "show the number of Box2D worlds and boxes, and how many boxes were culled from the snapshots and how many contact events there were last tick");
+	Console()->Register("b2_save_world", "s[file] ?i[team]", CFGFLAG_SERVER, ConB2SaveWorld, this, "save the boxes of your team's Box2D world (or of the given team) to a file");
+	Console()->Register("b2_load_world", "s[file] ?i[team]", CFGFLAG_SERVER, ConB2LoadWorld, this, "replace the boxes of your team's Box2D world (or of the given team) with the ones from a file");
+	Console()->Register("b2_prefab", "s[file] ?i[columns] ?i[rows] ?i[spacing]", CFGFLAG_SERVER, ConB2Prefab, this, "create a grid of copies of a json prefab above you");
+	Console()->Register("b2_profile", "", CFGFLAG_SERVER, ConB2Profile, this, "show percentiles of the Box2D step times and body counts over the last 10 seconds");
+	Console()->Register("b2_profile_csv", "s[file]", CFGFLAG_SERVER, ConB2ProfileCsv, this, "write the Box2D step times and body counts of the last 10 seconds to a csv file");
 
 	Console()->Chain("sv_motd", ConchainSpecialMotdupdate, this);
 
@@ -3184,6 +3378,7 @@ void CGameContext::OnInit(/*class IKernel *pKernel*/)
 	m_pAntibot->RoundStart(this);
 	m_World.SetGameServer(this);
 	m_Events.SetGameServer(this);
+	m_SnapItems.SetGameServer(this);
 
 	m_GameUuid = RandomUuid();
 	Console()->SetTeeHistorianCommandCallback(CommandCallback, this);
@@ -3204,6 +3399,23 @@ void CGameContext::OnInit(/*class IKernel *pKernel*/)
 	m_Layers.Init(Kernel());
 	m_Collision.Init(&m_Layers);
 
+	// every team's world gets its own map body made from these
+	if(g_Config.m_B2MapColliders)
+	{
+		std::vector<unsigned char> vSolid;
+		GetSolidTiles(Collision(), vSolid);
+		FindTileOutlines(vSolid.data(), Collision()->GetWidth(), Collision()->GetHeight(), m_vB2MapOutlines);
+
+		int NumEdges = 0;
+		for(const CTileOutline &Outline : m_vB2MapOutlines)
+			NumEdges += Outline.size();
+		dbg_msg("box2d", "found %d map outlines with %d edges", (int)m_vB2MapOutlines.size(), NumEdges);
+
+		int NumSkipped = GetPhysicsQuads(&m_Layers, m_vB2MapQuads);
+		if(!m_vB2MapQuads.empty() || NumSkipped)
+			dbg_msg("box2d", "found %d physics quads, skipped %d animated or flat ones", (int)m_vB2MapQuads.size(), NumSkipped);
+	}
+
 	char aMapName[128];
 	int MapSize;
 	SHA256_DIGEST MapSha256;
@@ -3211,6 +3423,8 @@ void CGameContext::OnInit(/*class IKernel *pKernel*/)
 	Server()->GetMapInfo(aMapName, sizeof(aMapName), &MapSize, &MapSha256, &MapCrc);
 	m_MapBugs = GetMapBugs(aMapName, MapSize, MapSha256);
 
+	m_B2MapSha256 = MapSha256;
+
 	// reset everything here
 	//world = new GAMEWORLD;
 	//players = new CPlayer[MAX_CLIENTS];
@@ -3366,6 +3580,11 @@ void CGameContext::OnInit(/*class IKernel *pKernel*/)
 		}
 	}
 
+	// after the teehistorian started, it records the boxes like any others
+	if(!m_B2ReloadState.Empty() && m_B2ReloadMapSha256 == m_B2MapSha256)
+		LoadB2World(TEAM_FLOCK, m_B2ReloadState);
+	m_B2ReloadState.Clear();
+
 	if(!m_pScore)
 	{
 		m_pScore = new CScore(this, ((CServer *)Server())->DbPool());
@@ -3638,6 +3857,8 @@ void CGameContext::OnShutdown()
 			Server()->SetErrorShutdown("teehistorian close error");
 		}
 		aio_free(m_pTeeHistorianFile);
+		// the box2d worlds are destroyed after this
+		m_TeeHistorianActive = false;
 	}
 
 	DeleteTempfile();
@@ -3697,6 +3918,25 @@ void CGameContext::OnSnap(int ClientID)
 		Server()->SendMsg(&Msg, MSGFLAG_RECORD | MSGFLAG_NOSEND, ClientID);
 	}
 
+	if(ClientID > -1 && m_apPlayers[ClientID]->m_Box2DSupport)
+	{
+		m_b2shapes.Snap(Server());
+		SnapB2World();
+	}
+
+	// boxes can only be deleted during the tick, so the lists are still valid
+	if(ClientID == -1)
+	{
+		for(auto *pBox : m_b2bodies)
+			pBox->SnapVisible(ClientID, false);
+	}
+	else
+	{
+		for(auto *pBox : m_avB2VisibleBoxes[ClientID])
+			pBox->SnapVisible(ClientID, pBox->getWorld() != m_apB2ViewWorlds[ClientID]);
+	}
+
+	m_SnapItems.Snap(ClientID);
 	m_World.Snap(ClientID);
 	m_pController->Snap(ClientID);
 	m_Events.Snap(ClientID);
@@ -3710,12 +3950,544 @@ void CGameContext::OnSnap(int ClientID)
 	if(ClientID > -1)
 		m_apPlayers[ClientID]->FakeSnap();
 }
-void CGameContext::OnPreSnap() {}
+void CGameContext::OnPreSnap()
+{
+	// OnSnap() runs for several clients at once, everything it would
+	// change is done here, and the items all clients share are built once
+	m_SnapItems.Clear();
+	m_World.PreSnap();
+	m_SnapItems.Finish();
+}
 void CGameContext::OnPostSnap()
 {
 	m_Events.Clear();
 }
 
+void CGameContext::OnTickFinished()
+{
+	// network input and console commands may modify the box2d worlds. the
+	// contacts stay recorded until the next tick, bodies destroyed until
+	// then take their events with them
+	SyncB2Worlds(false);
+}
+
+static const b2Vec2 s_B2Gravity(0.f, 9.81f);
+
+CBox2DWorld *CGameContext::B2World(int Team)
+{
+	if(!m_apB2Worlds[Team])
+	{
+		m_apB2Worlds[Team] = new CBox2DWorld(s_B2Gravity);
+		if(m_TeeHistorianActive)
+			m_TeeHistorian.RecordB2WorldCreate(Team, !m_vB2MapOutlines.empty(), !m_vB2MapQuads.empty());
+		if(!m_vB2MapOutlines.empty())
+			CreateMapBody(m_apB2Worlds[Team], m_vB2MapOutlines);
+		if(!m_vB2MapQuads.empty())
+			CreateQuadsBody(m_apB2Worlds[Team], m_vB2MapQuads);
+		m_apB2Worlds[Team]->m_LastUsedTick = Server()->Tick();
+	}
+	return m_apB2Worlds[Team];
+}
+
+int CGameContext::B2WorldTeam(const CBox2DWorld *pWorld) const
+{
+	for(int i = 0; i < MAX_CLIENTS + 1; i++)
+	{
+		if(m_apB2Worlds[i] == pWorld)
+			return i;
+	}
+	return -1;
+}
+
+void CGameContext::DestroyB2World(int Team)
+{
+	CBox2DWorld *pWorld = m_apB2Worlds[Team];
+	pWorld->Sync();
+
+	for(auto &pPlayer : m_apPlayers)
+	{
+		CCharacter *pChr = pPlayer ? pPlayer->GetCharacter() : 0;
+		if(pChr && pChr->m_b2Tee.World() == pWorld)
+			pChr->DestroyB2Body();
+	}
+	ClearB2Boxes(pWorld, true);
+
+	if(m_TeeHistorianActive)
+		m_TeeHistorian.RecordB2WorldDestroy(Team);
+	delete pWorld;
+	m_apB2Worlds[Team] = 0;
+}
+
+void CGameContext::ClearB2Boxes(CBox2DWorld *pWorld, bool DeletingWorld)
+{
+	pWorld->Sync();
+
+	// one pass that deletes the boxes of the world and moves the others
+	// together, instead of every box taking itself out of the list
+	unsigned NumKept = 0;
+	for(CBox2DBox *pBox : m_b2bodies)
+	{
+		if(pBox->getWorld() != pWorld)
+		{
+			pBox->m_BoxIndex = NumKept;
+			m_b2bodies[NumKept++] = pBox;
+			continue;
+		}
+		pBox->m_BoxIndex = -1;
+		// b2World frees all of its bodies, fixtures and contacts at once,
+		// destroying them one by one would update the broadphase for each
+		if(DeletingWorld)
+			pBox->ReleaseBody();
+		delete pBox;
+	}
+	m_b2bodies.resize(NumKept);
+}
+
+void CGameContext::AddB2Box(CBox2DBox *pBox)
+{
+	pBox->m_BoxIndex = m_b2bodies.size();
+	m_b2bodies.push_back(pBox);
+}
+
+void CGameContext::RemoveB2Box(CBox2DBox *pBox)
+{
+	// the last box takes its place
+	CBox2DBox *pLast = m_b2bodies.back();
+	m_b2bodies[pBox->m_BoxIndex] = pLast;
+	pLast->m_BoxIndex = pBox->m_BoxIndex;
+	m_b2bodies.pop_back();
+	pBox->m_BoxIndex = -1;
+}
+
+void CGameContext::SaveB2World(int Team, CBox2DWorldState *pState)
+{
+	pState->Clear();
+	CBox2DWorld *pWorld = m_apB2Worlds[Team];
+	if(!pWorld)
+		return;
+	pWorld->Sync();
+
+	std::unordered_map<const b2Body *, int> BodyIndices;
+	for(CBox2DBox *pBox : m_b2bodies)
+	{
+		if(pBox->getWorld() != pWorld)
+			continue;
+		const b2Body *pBody = pBox->getBody();
+		BodyIndices[pBody] = pState->m_vBodies.size();
+
+		CBox2DBodyState Body;
+		Body.m_Type = pBody->GetType();
+		Body.m_Pos = vec2(pBody->GetPosition().x, pBody->GetPosition().y) * B2_SCALE;
+		Body.m_Angle = pBody->GetAngle();
+		Body.m_Vel = vec2(pBody->GetLinearVelocity().x, pBody->GetLinearVelocity().y) * B2_SCALE;
+		Body.m_AngularVel = pBody->GetAngularVelocity();
+		Body.m_Size = pBox->getSize();
+		Body.m_Density = pBody->GetFixtureList()->GetDensity();
+		Body.m_Friction = pBody->GetFixtureList()->GetFriction();
+		pState->m_vBodies.push_back(Body);
+	}
+
+	// only joints between boxes are saved
+	for(b2Joint *pJoint = pWorld->GetJointList(); pJoint; pJoint = pJoint->GetNext())
+	{
+		auto BodyA = BodyIndices.find(pJoint->GetBodyA());
+		auto BodyB = BodyIndices.find(pJoint->GetBodyB());
+		if(BodyA == BodyIndices.end() || BodyB == BodyIndices.end())
+			continue;
+
+		CBox2DJointState Joint;
+		Joint.m_Type = pJoint->GetType();
+		Joint.m_BodyA = BodyA->second;
+		Joint.m_BodyB = BodyB->second;
+		Joint.m_CollideConnected = pJoint->GetCollideConnected();
+		Joint.m_ReferenceAngle = 0.0f;
+		Joint.m_Length = 0.0f;
+		b2Vec2 AnchorA, AnchorB;
+		switch(pJoint->GetType())
+		{
+		case e_distanceJoint:
+		{
+			b2DistanceJoint *pDistance = (b2DistanceJoint *)pJoint;
+			AnchorA = pDistance->GetLocalAnchorA();
+			AnchorB = pDistance->GetLocalAnchorB();
+			Joint.m_Length = pDistance->GetLength() * B2_SCALE;
+			break;
+		}
+		case e_revoluteJoint:
+		{
+			b2RevoluteJoint *pRevolute = (b2RevoluteJoint *)pJoint;
+			AnchorA = pRevolute->GetLocalAnchorA();
+			AnchorB = pRevolute->GetLocalAnchorB();
+			Joint.m_ReferenceAngle = pRevolute->GetReferenceAngle();
+			break;
+		}
+		case e_weldJoint:
+		{
+			b2WeldJoint *pWeld = (b2WeldJoint *)pJoint;
+			AnchorA = pWeld->GetLocalAnchorA();
+			AnchorB = pWeld->GetLocalAnchorB();
+			Joint.m_ReferenceAngle = pWeld->GetReferenceAngle();
+			break;
+		}
+		default:
+			continue;
+		}
+		Joint.m_AnchorA = vec2(AnchorA.x, AnchorA.y) * B2_SCALE;
+		Joint.m_AnchorB = vec2(AnchorB.x, AnchorB.y) * B2_SCALE;
+		pState->m_vJoints.push_back(Joint);
+	}
+}
+
+void CGameContext::LoadB2World(int Team, const CBox2DWorldState &State)
+{
+	if(State.Empty() && !m_apB2Worlds[Team])
+		return;
+	CBox2DWorld *pWorld = B2World(Team);
+	pWorld->Sync();
+	ClearB2Boxes(pWorld);
+	pWorld->m_LastUsedTick = Server()->Tick();
+	AddB2Boxes(pWorld, State);
+}
+
+int CGameContext::AddB2Boxes(CBox2DWorld *pWorld, const CBox2DWorldState &State)
+{
+	int NumBodies = State.m_vBodies.size();
+	if(g_Config.m_B2MaxBoxes && (int)m_b2bodies.size() + NumBodies > g_Config.m_B2MaxBoxes)
+	{
+		NumBodies = maximum(g_Config.m_B2MaxBoxes - (int)m_b2bodies.size(), 0);
+		dbg_msg("box2d", "only creating %d of %d boxes, see b2_max_boxes", NumBodies, (int)State.m_vBodies.size());
+	}
+
+	if(m_TeeHistorianActive)
+	{
+		// the boxes as they are created, so a replay builds the same ones
+		CBox2DWorldState Created;
+		Created.m_vBodies.assign(State.m_vBodies.begin(), State.m_vBodies.begin() + NumBodies);
+		for(const CBox2DJointState &Joint : State.m_vJoints)
+		{
+			if(Joint.m_BodyA < NumBodies && Joint.m_BodyB < NumBodies)
+				Created.m_vJoints.push_back(Joint);
+		}
+		std::vector<unsigned char> vData;
+		PackBox2DHistoryState(Created, vData);
+		m_TeeHistorian.RecordB2Boxes(B2WorldTeam(pWorld), pWorld->m_NextBoxID, vData.data(), vData.size());
+	}
+
+	std::vector<b2Body *> vpBodies;
+	vpBodies.reserve(NumBodies);
+	m_b2bodies.reserve(m_b2bodies.size() + NumBodies);
+	for(int i = 0; i < NumBodies; i++)
+	{
+		CBox2DBox *pBox = new CBox2DBox(&m_World, pWorld, State.m_vBodies[i]);
+		vpBodies.push_back(pBox->getBody());
+	}
+	CreateBox2DJoints(pWorld, State.m_vJoints, vpBodies);
+	return NumBodies;
+}
+
+class CVisibleBoxQuery : public b2QueryCallback
+{
+public:
+	std::vector<CBox2DBox *> *m_pvBoxes;
+
+	bool ReportFixture(b2Fixture *pFixture)
+	{
+		// boxes have a single fixture, so they are reported only once
+		CBox2DBox *pBox = (CBox2DBox *)pFixture->GetBody()->GetUserData().pointer;
+		if(pBox)
+			m_pvBoxes->push_back(pBox);
+		return true;
+	}
+};
+
+void CGameContext::UpdateB2Visibility()
+{
+	// the bodies are queried before the step, give them some room to move
+	const float Margin = 64.0f;
+
+	m_B2NumCulled = 0;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		m_avB2VisibleBoxes[i].clear();
+		m_apB2ViewWorlds[i] = 0;
+		if(!m_apPlayers[i])
+			continue;
+
+		// other teams' boxes are only sent to clients that show others,
+		// like their tees
+		CBox2DWorld *pViewWorld = m_apB2Worlds[B2ViewTeam(i)];
+		bool ShowOthers = m_apPlayers[i]->m_ShowOthers == 1;
+		m_apB2ViewWorlds[i] = pViewWorld;
+		if(m_apPlayers[i]->m_ShowAll)
+		{
+			for(auto *pBox : m_b2bodies)
+			{
+				if(ShowOthers || pBox->getWorld() == pViewWorld)
+					m_avB2VisibleBoxes[i].push_back(pBox);
+			}
+			m_B2NumCulled += m_b2bodies.size() - m_avB2VisibleBoxes[i].size();
+			continue;
+		}
+
+		vec2 ViewPos = m_apPlayers[i]->m_ViewPos;
+		vec2 ShowDistance = m_apPlayers[i]->m_ShowDistance + vec2(Margin, Margin);
+		b2AABB aabb;
+		aabb.lowerBound = b2Vec2((ViewPos.x - ShowDistance.x) / B2_SCALE, (ViewPos.y - ShowDistance.y) / B2_SCALE);
+		aabb.upperBound = b2Vec2((ViewPos.x + ShowDistance.x) / B2_SCALE, (ViewPos.y + ShowDistance.y) / B2_SCALE);
+
+		CVisibleBoxQuery Query;
+		Query.m_pvBoxes = &m_avB2VisibleBoxes[i];
+		for(auto *pWorld : m_apB2Worlds)
+		{
+			if(pWorld && (ShowOthers || pWorld == pViewWorld))
+				pWorld->QueryAABB(&Query, aabb);
+		}
+		m_B2NumCulled += m_b2bodies.size() - m_avB2VisibleBoxes[i].size();
+	}
+}
+
+int CGameContext::B2ViewTeam(int ClientID)
+{
+	// spectators see the boxes of the player they follow, like its tee
+	CPlayer *pPlayer = m_apPlayers[ClientID];
+	if((pPlayer->GetTeam() == TEAM_SPECTATORS || pPlayer->IsPaused()) && pPlayer->m_SpectatorID != SPEC_FREEVIEW && m_apPlayers[pPlayer->m_SpectatorID])
+		return GetDDRaceTeam(pPlayer->m_SpectatorID);
+	return GetDDRaceTeam(ClientID);
+}
+
+void CGameContext::CastB2Projectiles()
+{
+	// one pass over the projectiles before the entities tick, so the world
+	// is walked in one go instead of from within every projectile's tick
+	for(CProjectile *pProj = (CProjectile *)m_World.FindFirst(CGameWorld::ENTTYPE_PROJECTILE); pProj; pProj = (CProjectile *)pProj->TypeNext())
+		pProj->CastB2Ray();
+}
+
+bool CGameContext::B2CanCreateBox() const
+{
+	return !g_Config.m_B2MaxBoxes || (int)m_b2bodies.size() < g_Config.m_B2MaxBoxes;
+}
+
+void CGameContext::SnapB2World()
+{
+	CNetObj_Box2DWorld *pWorld = static_cast<CNetObj_Box2DWorld *>(Server()->SnapNewItem(NETOBJTYPE_BOX2DWORLD, 0, sizeof(CNetObj_Box2DWorld)));
+	if(!pWorld)
+		return;
+	pWorld->m_TickTime = round_to_int(B2TickTime() * 1000000.0f);
+	pWorld->m_GravityX = round_to_int(s_B2Gravity.x * 1000.0f);
+	pWorld->m_GravityY = round_to_int(s_B2Gravity.y * 1000.0f);
+}
+
+float CGameContext::B2TickTime() const
+{
+	return g_Config.m_B2StepRate ? 1.f / Server()->TickSpeed() : 1.f / g_Config.m_B2WorldFps;
+}
+
+float CGameContext::B2StepTime() const
+{
+	// the steps of a tick must fit into b2_max_substeps, higher step rates
+	// are lowered to that
+	if(g_Config.m_B2StepRate)
+		return maximum(1.f / g_Config.m_B2StepRate, B2TickTime() / g_Config.m_B2MaxSubsteps);
+	return B2TickTime();
+}
+
+void CGameContext::SleepFarB2Boxes()
+{
+	float MaxDistance = g_Config.m_B2SleepDistance;
+	for(CBox2DBox *pBox : m_b2bodies)
+	{
+		b2Body *pBody = pBox->getBody();
+		if(pBody->GetType() != b2_dynamicBody || !pBody->IsAwake())
+			continue;
+
+		bool Near = false;
+		for(CCharacter *pChr = (CCharacter *)m_World.FindFirst(CGameWorld::ENTTYPE_CHARACTER); pChr && !Near; pChr = (CCharacter *)pChr->TypeNext())
+			Near = pChr->m_b2Tee.World() == pBox->getWorld() && distance(pChr->m_Pos, pBox->m_Pos) < MaxDistance;
+		if(!Near)
+		{
+			if(m_TeeHistorianActive)
+				m_TeeHistorian.RecordB2Sleep(B2WorldTeam(pBox->getWorld()), pBox->m_HistoryID);
+			pBody->SetAwake(false);
+		}
+	}
+}
+
+void CGameContext::SyncB2Worlds(bool HandleContacts)
+{
+	if(HandleContacts)
+	{
+		m_B2NumContactEvents = 0;
+		m_B2NumDroppedContactEvents = 0;
+	}
+	for(int i = 0; i < MAX_CLIENTS + 1; i++)
+	{
+		if(!m_apB2Worlds[i])
+			continue;
+		m_apB2Worlds[i]->Sync();
+		if(HandleContacts)
+			HandleB2Contacts(i);
+	}
+}
+
+void CGameContext::HandleB2Contacts(int Team)
+{
+	CBox2DContactListener &Contacts = m_apB2Worlds[Team]->m_Contacts;
+	m_B2NumContactEvents += Contacts.NumEvents();
+	m_B2NumDroppedContactEvents += Contacts.NumDropped();
+
+	// a collapsing pile would be all noise
+	const int MAX_SOUNDS = 8;
+	int NumSounds = 0;
+	int64_t Mask = ((CGameControllerDDRace *)m_pController)->m_Teams.TeamMask(Team);
+	for(int i = 0; i < Contacts.NumEvents(); i++)
+	{
+		const CBox2DContactEvent &Event = Contacts.Event(i);
+		if(Event.m_Type != CBox2DContactEvent::IMPACT)
+			continue;
+
+		CCharacter *pHit = 0;
+		bool HitIsA = false;
+		for(CCharacter *pChr = (CCharacter *)m_World.FindFirst(CGameWorld::ENTTYPE_CHARACTER); pChr && !pHit; pChr = (CCharacter *)pChr->TypeNext())
+		{
+			b2Body *pTeeBody = pChr->m_b2Tee.Body();
+			if(pTeeBody && (pTeeBody == Event.m_pBodyA || pTeeBody == Event.m_pBodyB))
+			{
+				pHit = pChr;
+				HitIsA = pTeeBody == Event.m_pBodyA;
+			}
+		}
+
+		// the tee bodies are kinematic and never get pushed back by the boxes,
+		// so a box that hits a tee passes on its speed itself. only the box's
+		// own speed counts, a tee running into a box doesn't bounce off it
+		b2Body *pOther = HitIsA ? Event.m_pBodyB : Event.m_pBodyA;
+		if(pHit && pOther->GetType() == b2_dynamicBody)
+		{
+			vec2 Dir = HitIsA ? -Event.m_Normal : Event.m_Normal;
+			float BoxSpeed = dot(HitIsA ? Event.m_VelB : Event.m_VelA, Dir);
+			if(g_Config.m_B2ImpactForce && g_Config.m_B2ImpactSpeed && BoxSpeed >= g_Config.m_B2ImpactSpeed)
+			{
+				vec2 Force = Dir * BoxSpeed / Server()->TickSpeed() * (g_Config.m_B2ImpactForce / 100.0f);
+				pHit->TakeDamage(Force, (int)(BoxSpeed / g_Config.m_B2ImpactSpeed), -1, WEAPON_WORLD);
+			}
+		}
+
+		if(NumSounds == MAX_SOUNDS)
+			continue;
+		if(pHit)
+			CreateSound(pHit->m_Pos, SOUND_PLAYER_PAIN_SHORT, Mask);
+		else
+			CreateSound(Event.m_Pos, SOUND_HAMMER_HIT, Mask);
+		NumSounds++;
+	}
+	Contacts.Clear();
+}
+
+void CGameContext::TickB2Tees(CBox2DWorld *pWorld, float SteppedTime)
+{
+	// the tees move to where the teehistorian recorded their characters at
+	// the end of the tick, so a replay can do the same from those records
+	for(auto &pPlayer : m_apPlayers)
+	{
+		CCharacter *pChr = pPlayer ? pPlayer->GetCharacter() : 0;
+		if(!pChr || pChr->m_b2Tee.World() != pWorld)
+			continue;
+		CNetObj_CharacterCore Core;
+		pChr->GetCore().Write(&Core);
+		pChr->m_b2Tee.Tick(vec2(Core.m_X, Core.m_Y), SteppedTime, B2StepTime());
+	}
+}
+
+void CGameContext::TickB2Worlds()
+{
+	for(auto &pPlayer : m_apPlayers)
+	{
+		CCharacter *pChr = pPlayer ? pPlayer->GetCharacter() : 0;
+		if(pChr && m_apB2Worlds[pChr->Team()])
+			m_apB2Worlds[pChr->Team()]->m_LastUsedTick = Server()->Tick();
+	}
+
+	// only empty worlds are destroyed, a while after their last character
+	// died so the tee bodies can be reused on respawn
+	for(int i = 0; i < MAX_CLIENTS + 1; i++)
+	{
+		if(m_apB2Worlds[i] && m_apB2Worlds[i]->Reclaimable(Server()->Tick(), Server()->TickSpeed()))
+			DestroyB2World(i);
+	}
+
+	// all worlds are synced here, so the pool can be replaced
+	if(g_Config.m_B2Threads != m_B2JobPoolThreads)
+	{
+		delete m_pB2JobPool;
+		m_pB2JobPool = 0;
+		if(g_Config.m_B2Threads)
+		{
+			m_pB2JobPool = new CJobPool();
+			m_pB2JobPool->Init(g_Config.m_B2Threads);
+		}
+		m_B2JobPoolThreads = g_Config.m_B2Threads;
+	}
+
+	UpdateB2Visibility();
+
+	// the steps started last tick, and the game tick up to here
+	CBox2DProfileSample Sample;
+	mem_zero(&Sample, sizeof(Sample));
+	Sample.m_Tick = Server()->Tick();
+	float LongestStep = 0.0f;
+	for(auto *pWorld : m_apB2Worlds)
+	{
+		if(!pWorld)
+			continue;
+		const CBox2DStepStats &Stats = pWorld->StepStats();
+		LongestStep = maximum(LongestStep, Stats.m_Profile.step);
+		Sample.m_aValues[CBox2DProfileSample::STEP] += Stats.m_Profile.step;
+		Sample.m_aValues[CBox2DProfileSample::COLLIDE] += Stats.m_Profile.collide;
+		Sample.m_aValues[CBox2DProfileSample::SOLVE] += Stats.m_Profile.solve;
+		Sample.m_aValues[CBox2DProfileSample::BROADPHASE] += Stats.m_Profile.broadphase;
+		Sample.m_aValues[CBox2DProfileSample::SOLVE_TOI] += Stats.m_Profile.solveTOI;
+		Sample.m_aValues[CBox2DProfileSample::BODIES] += Stats.m_NumBodies;
+		Sample.m_aValues[CBox2DProfileSample::AWAKE_BODIES] += Stats.m_NumAwakeBodies;
+		Sample.m_aValues[CBox2DProfileSample::CONTACTS] += Stats.m_NumContacts;
+	}
+	Sample.m_aValues[CBox2DProfileSample::GAME_TICK] = (time_get() - m_B2TickStart) * 1000.0f / time_freq();
+	m_B2Profile.Add(Sample);
+
+	// the worlds of a job pool step in parallel, the tick only waits for the
+	// slowest one. without one they step one after another
+	float StepTime = m_pB2JobPool ? LongestStep : Sample.m_aValues[CBox2DProfileSample::STEP];
+	if(m_B2Governor.Update(StepTime, g_Config.m_B2StepBudget / 1000.0f))
+	{
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "step took %.3fms of %.3fms budget, quality level %d/%d: iterations %d/%d%s",
+			StepTime, g_Config.m_B2StepBudget / 1000.0f,
+			m_B2Governor.Level(), (int)CBox2DGovernor::MAX_LEVEL,
+			m_B2Governor.VelocityIterations(), m_B2Governor.PositionIterations(),
+			m_B2Governor.SleepFarBodies() ? ", far bodies sleep" : "");
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "Box2D", aBuf);
+	}
+	if(m_B2Governor.SleepFarBodies())
+		SleepFarB2Boxes();
+
+	bool Checksum = g_Config.m_B2HistoryChecksum && Server()->Tick() % g_Config.m_B2HistoryChecksum == 0;
+	for(int i = 0; i < MAX_CLIENTS + 1; i++)
+	{
+		CBox2DWorld *pWorld = m_apB2Worlds[i];
+		if(!pWorld)
+			continue;
+		int MaxSubsteps = g_Config.m_B2StepRate ? g_Config.m_B2MaxSubsteps : 1;
+		if(m_TeeHistorianActive && Checksum)
+			m_TeeHistorian.RecordB2Checksum(i, Box2DWorldChecksum(pWorld));
+		TickB2Tees(pWorld, pWorld->NumDueSubsteps(B2TickTime(), B2StepTime(), MaxSubsteps) * B2StepTime());
+		if(m_TeeHistorianActive)
+			m_TeeHistorian.RecordB2Step(i, B2TickTime(), B2StepTime(), MaxSubsteps, m_B2Governor.VelocityIterations(), m_B2Governor.PositionIterations());
+		pWorld->m_Explosions.Tick();
+		pWorld->m_Contacts.SetMinImpactSpeed(g_Config.m_B2ImpactSpeed);
+		pWorld->StartStep(B2TickTime(), B2StepTime(), MaxSubsteps, m_B2Governor.VelocityIterations(), m_B2Governor.PositionIterations(), m_pB2JobPool);
+	}
+}
+
 bool CGameContext::IsClientReady(int ClientID) const
 {
 	return m_apPlayers[ClientID] && m_apPlayers[ClientID]->m_IsReady ? true : false;
@@ -5,11 +5,17 @@
 
 #include <box2d/box2d.h>
 //#include "entities/box2d_box.h"
+#include "box2d_governor.h"
+#include "box2d_profile.h"
+#include "box2d_save.h"
+#include "box2d_shapes.h"
+#include "box2d_world.h"
 
 #include <engine/antibot.h>
 #include <engine/console.h>
 #include <engine/server.h>
 
+#include <game/box2d_map.h>
 #include <game/layers.h>
 #include <game/mapbugs.h>
 #include <game/voting.h>
@@ -18,6 +24,7 @@
 #include <base/tl/string.h>
 
 #include "eventhandler.h"
+#include "snapitems.h"
 //#include "gamecontroller.h"
 #include "gameworld.h"
 #include "teehistorian.h"
@@ -62,6 +69,7 @@ class IStorage;
 struct CAntibotData;
 struct CScoreRandomMapResult;
 class CBox2DBox;
+class CJobPool;
 
 class BodyRangeRay : public b2RayCastCallback
 {
@@ -81,27 +89,27 @@ public:
 	}
 };
 
-class BodyCollideQuery : public b2QueryCallback
+// the first box on a projectile's way, the map and the tees are left to
+// the game's own collision
+class BodySweepRay : public b2RayCastCallback
 {
 public:
-	b2Body* Body;
-	b2Vec2 findPos;
+	CBox2DBox* m_pBox;
+	b2Vec2 m_point;
+	b2Vec2 m_normal;
 
-	bool ReportFixture(b2Fixture* fixture)
+	float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction)
 	{
-		b2Shape* shape = fixture->GetShape();
-		bool inside = shape->TestPoint(fixture->GetBody()->GetTransform(), findPos);
-
-		if (inside)
-		{
-			Body = fixture->GetBody();
-			return false;
-		}
-		return true;
+		CBox2DBox* pBox = (CBox2DBox*)fixture->GetBody()->GetUserData().pointer;
+		if (!pBox || fixture->IsSensor())
+			return -1;
+		m_pBox = pBox;
+		m_point = point;
+		m_normal = normal;
+		return fraction;
 	}
 };
 
-
 class CGameContext : public IGameServer
 {
 	IServer *m_pServer;
@@ -191,6 +199,7 @@ public:
 	void Clear();
 
 	CEventHandler m_Events;
+	CSnapItems m_SnapItems;
 	CPlayer *m_apPlayers[MAX_CLIENTS];
 
 	IGameController *m_pController;
@@ -290,6 +299,7 @@ public:
 	virtual void OnPreSnap();
 	virtual void OnSnap(int ClientID);
 	virtual void OnPostSnap();
+	virtual void OnTickFinished();
 
 	void *PreProcessMsg(int *MsgID, CUnpacker *pUnpacker, int ClientID);
 	void CensorMessage(char *pCensoredMessage, const char *pMessage, int Size);
@@ -335,11 +345,72 @@ public:
 
 	std::shared_ptr<CScoreRandomMapResult> m_SqlRandomMapResult;
 
-	b2World* m_b2world;
+	// one box2d world per ddrace team, created on first use
+	CBox2DWorld* m_apB2Worlds[MAX_CLIENTS + 1];
+	CBox2DWorld* B2World(int Team);
+	// the team of one of the worlds, -1 if it isn't one
+	int B2WorldTeam(const CBox2DWorld *pWorld) const;
+	void DestroyB2World(int Team);
+	// the boxes of a team's world and the joints between them
+	void SaveB2World(int Team, CBox2DWorldState *pState);
+	// replaces the boxes of a team's world, creating them all in one go
+	void LoadB2World(int Team, const CBox2DWorldState &State);
+	// adds the boxes and joints of the state to a world, as many as
+	// b2_max_boxes allows. returns how many boxes it created
+	int AddB2Boxes(CBox2DWorld *pWorld, const CBox2DWorldState &State);
+	// all boxes, in no particular order. boxes add and remove themselves
 	std::vector<CBox2DBox*> m_b2bodies;
-	std::vector<b2Body*> m_b2explosions;
+	void AddB2Box(CBox2DBox *pBox);
+	void RemoveB2Box(CBox2DBox *pBox);
+	// false if b2_max_boxes boxes exist already
+	bool B2CanCreateBox() const;
+	// how far the box2d worlds advance per tick
+	float B2TickTime() const;
+	// and the length of the steps they do it in
+	float B2StepTime() const;
+	CBox2DShapes m_b2shapes;
+	// the boxes in view of each client, updated at the end of every tick.
+	// those are the boxes of the team the client sees, and the other
+	// teams' ones if it shows others
+	std::vector<CBox2DBox*> m_avB2VisibleBoxes[MAX_CLIENTS];
+	// the world of the team each client sees, 0 if it has none yet
+	CBox2DWorld* m_apB2ViewWorlds[MAX_CLIENTS];
+	// the team of the player a client plays or spectates
+	int B2ViewTeam(int ClientID);
+	int m_B2NumCulled;
+	// the contact events of all worlds last tick, and those that didn't fit
+	int m_B2NumContactEvents;
+	int m_B2NumDroppedContactEvents;
 
 private:
+	std::vector<CTileOutline> m_vB2MapOutlines;
+	std::vector<CQuadPolygon> m_vB2MapQuads;
+	CJobPool* m_pB2JobPool;
+	int m_B2JobPoolThreads;
+	// the boxes of the last map, kept across Clear() for a reload
+	CBox2DWorldState m_B2ReloadState;
+	SHA256_DIGEST m_B2ReloadMapSha256;
+	SHA256_DIGEST m_B2MapSha256;
+	// the cost of the box2d steps over the last seconds
+	CBox2DProfile m_B2Profile;
+	int64_t m_B2TickStart;
+	CBox2DGovernor m_B2Governor;
+	void SleepFarB2Boxes();
+	void SnapB2World();
+	// deletes the boxes of a world, leaving their bodies to the world if
+	// it's deleted right after
+	void ClearB2Boxes(CBox2DWorld *pWorld, bool DeletingWorld = false);
+	void SyncB2Worlds(bool HandleContacts);
+	// plays the impact sounds of the contacts of a world's last step and
+	// lets the boxes push the tees they hit
+	void HandleB2Contacts(int Team);
+	// moves the tees of a world to their characters within the time its
+	// next step advances it
+	void TickB2Tees(CBox2DWorld *pWorld, float SteppedTime);
+	void TickB2Worlds();
+	void UpdateB2Visibility();
+	void CastB2Projectiles();
+
 	bool m_VoteWillPass;
 	class CScore *m_pScore;
 
@@ -435,6 +506,12 @@ private:
 	static void ConB2CreateBox(IConsole::IResult *pResult, void *pUserData);
 	static void ConB2CreateGround(IConsole::IResult *pResult, void *pUserData);
 	static void ConB2ClearWorld(IConsole::IResult *pResult, void *pUserData);
+	static void ConB2Status(IConsole::IResult *pResult, void *pUserData);
+	static void ConB2SaveWorld(IConsole::IResult *pResult, void *pUserData);
+	static void ConB2LoadWorld(IConsole::IResult *pResult, void *pUserData);
+	static void ConB2Prefab(IConsole::IResult *pResult, void *pUserData);
+	static void ConB2Profile(IConsole::IResult *pResult, void *pUserData);
+	static void ConB2ProfileCsv(IConsole::IResult *pResult, void *pUserData);
 
 	static void ConVoteMute(IConsole::IResult *pResult, void *pUserData);
 	static void ConVoteUnmute(IConsole::IResult *pResult, void *pUserData);
@@ -104,15 +104,20 @@ void CGameWorld::RemoveEntity(CEntity *pEnt)
 }
 
 //
+void CGameWorld::PreSnap()
+{
+	for(auto *pEnt : m_apFirstEntityTypes)
+		for(; pEnt; pEnt = pEnt->m_pNextTypeEntity)
+			pEnt->PreSnap();
+}
+
 void CGameWorld::Snap(int SnappingClient)
 {
+	// several clients are snapped at once, and snapping can't remove
+	// entities, so it doesn't go through m_pNextTraverseEntity
 	for(auto *pEnt : m_apFirstEntityTypes)
-		for(; pEnt;)
-		{
-			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
+		for(; pEnt; pEnt = pEnt->m_pNextTypeEntity)
 			pEnt->Snap(SnappingClient);
-			pEnt = m_pNextTraverseEntity;
-		}
 }
 
 void CGameWorld::Reset()
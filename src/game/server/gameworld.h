@@ -122,6 +122,13 @@ public:
 	*/
 	void RemoveEntity(CEntity *pEntity);
 
+	/*
+		Function: PreSnap
+			Calls PreSnap on all the entities in the world, once
+			before the clients are snapped.
+	*/
+	void PreSnap();
+
 	/*
 		Function: snap
 			Calls snap on all the entities in the world to create
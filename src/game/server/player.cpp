@@ -107,6 +107,7 @@ void CPlayer::Reset()
 	m_ShowOthers = g_Config.m_SvShowOthersDefault;
 	m_ShowAll = g_Config.m_SvShowAllDefault;
 	m_ShowDistance = vec2(1200, 800);
+	m_Box2DSupport = false;
 	m_SpecTeam = 0;
 	m_NinjaJetpack = false;
 
@@ -173,6 +173,7 @@ public:
 	int m_ShowOthers;
 	bool m_ShowAll;
 	vec2 m_ShowDistance;
+	bool m_Box2DSupport;
 	bool m_SpecTeam;
 	bool m_NinjaJetpack;
 	bool m_Afk;
@@ -473,6 +473,8 @@ int CSaveTeam::Save(int Team)
 				m_pSwitchers[i].m_Type = m_pController->GameServer()->Collision()->m_pSwitchers[i].m_Type[Team];
 			}
 		}
+
+		m_pController->GameServer()->SaveB2World(Team, &m_B2World);
 		return 0;
 	}
 	else
@@ -533,6 +535,8 @@ void CSaveTeam::Load(int Team, bool KeepCurrentWeakStrong)
 			m_pController->GameServer()->Collision()->m_pSwitchers[i].m_Type[Team] = m_pSwitchers[i].m_Type;
 		}
 	}
+
+	m_pController->GameServer()->LoadB2World(Team, m_B2World);
 }
 
 CCharacter *CSaveTeam::MatchCharacter(int ClientID, int SaveID, bool KeepCurrentCharacter)
@@ -567,6 +571,32 @@ char *CSaveTeam::GetString()
 		}
 	}
 
+	// the box2d world goes into an optional last line, as hex. it is left
+	// out if it doesn't fit, the team is loaded without boxes then
+	if(!m_B2World.Empty())
+	{
+		std::vector<unsigned char> vData;
+		m_B2World.Pack(vData);
+		int Length = str_length(m_aString);
+		if(Length + 4 + (int)vData.size() * 2 < (int)sizeof(m_aString))
+		{
+			static const char s_aHex[] = "0123456789abcdef";
+			char *pDst = m_aString + Length;
+			*pDst++ = '\n';
+			*pDst++ = 'b';
+			*pDst++ = '2';
+			*pDst++ = '\t';
+			for(unsigned char Byte : vData)
+			{
+				*pDst++ = s_aHex[Byte >> 4];
+				*pDst++ = s_aHex[Byte & 0xf];
+			}
+			*pDst = 0;
+		}
+		else
+			dbg_msg("save", "box2d world of %d bytes doesn't fit into the savegame", (int)vData.size());
+	}
+
 	return m_aString;
 }
 
@@ -714,6 +744,17 @@ int CSaveTeam::FromString(const char *String)
 		}
 	}
 
+	// older saves and saves without boxes end here
+	m_B2World.Clear();
+	const char *pB2World = str_startswith(m_aString + Pos, "b2\t");
+	if(pB2World)
+	{
+		int Length = str_length(pB2World);
+		std::vector<unsigned char> vData(Length / 2);
+		if(Length % 2 || str_hex_decode(vData.data(), vData.size(), pB2World) || !m_B2World.Unpack(vData.data(), vData.size()))
+			dbg_msg("load", "savegame: couldn't load box2d world");
+	}
+
 	return 0;
 }
 
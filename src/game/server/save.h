@@ -3,6 +3,7 @@
 
 #include <engine/shared/protocol.h>
 #include <game/generated/protocol.h>
+#include <game/server/box2d_save.h>
 #include <game/server/gamecontroller.h>
 
 class IGameController;
@@ -142,6 +143,9 @@ private:
 	};
 	SSimpleSwitchers *m_pSwitchers;
 
+	// the boxes of the team's box2d world
+	CBox2DWorldState m_B2World;
+
 	int m_TeamState;
 	int m_MembersCount;
 	int m_NumSwitchers;
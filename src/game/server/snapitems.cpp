@@ -0,0 +1,165 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include "snapitems.h"
+
+#include "entity.h"
+#include "gamecontext.h"
+#include "player.h"
+
+#include <engine/server.h>
+
+#include <game/collision.h>
+
+CSnapItems::CSnapItems()
+{
+	m_pGameServer = 0;
+	m_Width = 1;
+	m_Height = 1;
+	m_SixupMask = 0;
+	for(int &Version : m_aClientVersions)
+		Version = -1;
+}
+
+void CSnapItems::SetGameServer(CGameContext *pGameServer)
+{
+	m_pGameServer = pGameServer;
+}
+
+void CSnapItems::Clear()
+{
+	m_vItems.clear();
+	m_vData.clear();
+	m_vVersionMasks.clear();
+
+	m_SixupMask = 0;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		bool Ingame = GameServer()->Server()->ClientIngame(i);
+		m_aClientVersions[i] = Ingame ? GameServer()->GetClientVersion(i) : -1;
+		if(Ingame && GameServer()->Server()->IsSixup(i))
+			m_SixupMask |= CmaskOne(i);
+	}
+}
+
+void *CSnapItems::Create(int Type, int ID, int Size, vec2 Pos, int64_t ClientMask, bool Demo, bool Clipped)
+{
+	CItem Item;
+	Item.m_Type = Type;
+	Item.m_ID = ID;
+	Item.m_Size = Size;
+	Item.m_Offset = m_vData.size();
+	Item.m_Pos = Pos;
+	Item.m_ClientMask = ClientMask;
+	Item.m_Demo = Demo;
+	Item.m_Clipped = Clipped;
+	m_vItems.push_back(Item);
+
+	m_vData.resize(m_vData.size() + (Size + sizeof(int) - 1) / sizeof(int), 0);
+	return &m_vData[Item.m_Offset];
+}
+
+int CSnapItems::Cell(vec2 Pos) const
+{
+	int x = clamp((int)floorf(Pos.x / CELL_SIZE), 0, m_Width - 1);
+	int y = clamp((int)floorf(Pos.y / CELL_SIZE), 0, m_Height - 1);
+	return y * m_Width + x;
+}
+
+void CSnapItems::Finish()
+{
+	m_Width = maximum(1, (GameServer()->Collision()->GetWidth() * 32 + CELL_SIZE - 1) / CELL_SIZE);
+	m_Height = maximum(1, (GameServer()->Collision()->GetHeight() * 32 + CELL_SIZE - 1) / CELL_SIZE);
+
+	// counting sort of the clipped items by their cell
+	m_vCellStart.assign(m_Width * m_Height + 1, 0);
+	m_vUnclippedItems.clear();
+	for(unsigned i = 0; i < m_vItems.size(); i++)
+	{
+		if(m_vItems[i].m_Clipped)
+			m_vCellStart[Cell(m_vItems[i].m_Pos) + 1]++;
+		else
+			m_vUnclippedItems.push_back(i);
+	}
+	for(unsigned c = 1; c < m_vCellStart.size(); c++)
+		m_vCellStart[c] += m_vCellStart[c - 1];
+
+	m_vCellItems.resize(m_vCellStart.back());
+	std::vector<int> vNext(m_vCellStart.begin(), m_vCellStart.end() - 1);
+	for(unsigned i = 0; i < m_vItems.size(); i++)
+	{
+		if(m_vItems[i].m_Clipped)
+			m_vCellItems[vNext[Cell(m_vItems[i].m_Pos)]++] = i;
+	}
+}
+
+bool CSnapItems::Visible(const CItem &Item, int SnappingClient) const
+{
+	return SnappingClient == -1 ? Item.m_Demo : CmaskIsSet(Item.m_ClientMask, SnappingClient);
+}
+
+void CSnapItems::SnapItem(const CItem &Item) const
+{
+	void *pData = GameServer()->Server()->SnapNewItem(Item.m_Type, Item.m_ID, Item.m_Size);
+	if(pData)
+		mem_copy(pData, &m_vData[Item.m_Offset], Item.m_Size);
+}
+
+void CSnapItems::Snap(int SnappingClient) const
+{
+	for(int Index : m_vUnclippedItems)
+	{
+		if(Visible(m_vItems[Index], SnappingClient))
+			SnapItem(m_vItems[Index]);
+	}
+
+	const CPlayer *pPlayer = SnappingClient >= 0 ? GameServer()->m_apPlayers[SnappingClient] : 0;
+	if(!pPlayer || pPlayer->m_ShowAll)
+	{
+		for(const CItem &Item : m_vItems)
+		{
+			if(Item.m_Clipped && Visible(Item, SnappingClient))
+				SnapItem(Item);
+		}
+		return;
+	}
+
+	// only the cells around the view, the items outside of the map are in
+	// the cells at its border
+	vec2 ViewPos = pPlayer->m_ViewPos;
+	vec2 ShowDistance = pPlayer->m_ShowDistance;
+	int MinX = clamp((int)floorf((ViewPos.x - ShowDistance.x) / CELL_SIZE), 0, m_Width - 1);
+	int MinY = clamp((int)floorf((ViewPos.y - ShowDistance.y) / CELL_SIZE), 0, m_Height - 1);
+	int MaxX = clamp((int)floorf((ViewPos.x + ShowDistance.x) / CELL_SIZE), 0, m_Width - 1);
+	int MaxY = clamp((int)floorf((ViewPos.y + ShowDistance.y) / CELL_SIZE), 0, m_Height - 1);
+	for(int y = MinY; y <= MaxY; y++)
+	{
+		for(int x = MinX; x <= MaxX; x++)
+		{
+			int c = y * m_Width + x;
+			for(int i = m_vCellStart[c]; i < m_vCellStart[c + 1]; i++)
+			{
+				const CItem &Item = m_vItems[m_vCellItems[i]];
+				if(Visible(Item, SnappingClient) && !NetworkClipped(GameServer(), SnappingClient, Item.m_Pos))
+					SnapItem(Item);
+			}
+		}
+	}
+}
+
+int64_t CSnapItems::ClientsFromVersion(int Version)
+{
+	for(const auto &VersionMask : m_vVersionMasks)
+	{
+		if(VersionMask.first == Version)
+			return VersionMask.second;
+	}
+
+	int64_t Mask = 0;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(m_aClientVersions[i] >= Version)
+			Mask |= CmaskOne(i);
+	}
+	m_vVersionMasks.emplace_back(Version, Mask);
+	return Mask;
+}
@@ -0,0 +1,87 @@
+/* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
+/* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#ifndef GAME_SERVER_SNAPITEMS_H
+#define GAME_SERVER_SNAPITEMS_H
+
+#include <base/system.h>
+#include <base/vmath.h>
+
+#include <engine/shared/protocol.h>
+
+#include <utility>
+#include <vector>
+
+/*
+	The snap items that are the same for every client that sees them. The
+	entities add them once per tick in CEntity::PreSnap(), with the position
+	they are clipped by and the mask of the clients that may see them. The
+	clipped items are sorted into a grid, so snapping a client only looks at
+	the items around its view instead of asking every entity again.
+*/
+class CSnapItems
+{
+	enum
+	{
+		// in world units, about the size of a default view
+		CELL_SIZE = 1024,
+	};
+
+	class CItem
+	{
+	public:
+		int m_Type;
+		int m_ID;
+		int m_Size;
+		int m_Offset;
+		vec2 m_Pos;
+		int64_t m_ClientMask;
+		bool m_Demo;
+		bool m_Clipped;
+	};
+
+	std::vector<CItem> m_vItems;
+	std::vector<int> m_vData;
+
+	// m_vCellItems holds the indices of the clipped items of cell c from
+	// m_vCellStart[c] to m_vCellStart[c + 1], the others are in
+	// m_vUnclippedItems
+	int m_Width;
+	int m_Height;
+	std::vector<int> m_vCellStart;
+	std::vector<int> m_vCellItems;
+	std::vector<int> m_vUnclippedItems;
+
+	int m_aClientVersions[MAX_CLIENTS];
+	int64_t m_SixupMask;
+	// ClientsFromVersion() for the versions asked for this tick
+	std::vector<std::pair<int, int64_t>> m_vVersionMasks;
+
+	class CGameContext *m_pGameServer;
+
+	int Cell(vec2 Pos) const;
+	void SnapItem(const CItem &Item) const;
+	bool Visible(const CItem &Item, int SnappingClient) const;
+
+public:
+	CGameContext *GameServer() const { return m_pGameServer; }
+	void SetGameServer(CGameContext *pGameServer);
+
+	CSnapItems();
+	// removes the items of the last tick, before the entities add theirs
+	void Clear();
+	// returns the zeroed data of the new item to fill in, valid until the
+	// next Create(). Clipped items are left out for the clients that can't
+	// see Pos, Demo adds the item to the server demo
+	void *Create(int Type, int ID, int Size, vec2 Pos, int64_t ClientMask = -1LL, bool Demo = true, bool Clipped = true);
+	// sorts the items into the grid, after all were created
+	void Finish();
+	// adds the items SnappingClient sees to its snapshot, -1 for the
+	// server demo. several clients may be snapped at once
+	void Snap(int SnappingClient) const;
+
+	// the clients with a ddnet version of at least Version
+	int64_t ClientsFromVersion(int Version);
+	int64_t SixupClients() const { return m_SixupMask; }
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "teehistorian.h"
+#include "box2d_history.h"
 
 #include <engine/shared/config.h>
 #include <engine/shared/json.h>
@@ -13,22 +14,6 @@ static const char TEEHISTORIAN_VERSION[] = "2";
 #include <engine/shared/teehistorian_ex_chunks.h>
 #undef UUID
 
-enum
-{
-	TEEHISTORIAN_NONE,
-	TEEHISTORIAN_FINISH,
-	TEEHISTORIAN_TICK_SKIP,
-	TEEHISTORIAN_PLAYER_NEW,
-	TEEHISTORIAN_PLAYER_OLD,
-	TEEHISTORIAN_INPUT_DIFF,
-	TEEHISTORIAN_INPUT_NEW,
-	TEEHISTORIAN_MESSAGE,
-	TEEHISTORIAN_JOIN,
-	TEEHISTORIAN_DROP,
-	TEEHISTORIAN_CONSOLE_COMMAND,
-	TEEHISTORIAN_EX,
-};
-
 CTeeHistorian::CTeeHistorian()
 {
 	m_State = STATE_START;
@@ -563,6 +548,202 @@ void CTeeHistorian::RecordTeamLoadFailure(int Team)
 	WriteExtra(UUID_TEEHISTORIAN_LOAD_FAILURE, Buffer.Data(), Buffer.Size());
 }
 
+void CTeeHistorian::RecordB2WorldCreate(int Team, bool MapOutlines, bool MapQuads)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(Team);
+	Buffer.AddInt(MapOutlines);
+	Buffer.AddInt(MapQuads);
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_world_create team=%d map_outlines=%d map_quads=%d", Team, MapOutlines, MapQuads);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_WORLD_CREATE, Buffer.Data(), Buffer.Size());
+}
+
+void CTeeHistorian::RecordB2WorldDestroy(int Team)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(Team);
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_world_destroy team=%d", Team);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_WORLD_DESTROY, Buffer.Data(), Buffer.Size());
+}
+
+void CTeeHistorian::RecordB2Boxes(int Team, int FirstID, const void *pState, int StateSize)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(Team);
+	Buffer.AddInt(FirstID);
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_boxes team=%d first_id=%d state_size=%d", Team, FirstID, StateSize);
+	}
+
+	// the state doesn't fit into a packer with a few hundred boxes
+	std::vector<unsigned char> vData(Buffer.Data(), Buffer.Data() + Buffer.Size());
+	vData.insert(vData.end(), (const unsigned char *)pState, (const unsigned char *)pState + StateSize);
+	WriteExtra(UUID_TEEHISTORIAN_B2_BOXES, vData.data(), vData.size());
+}
+
+void CTeeHistorian::RecordB2BoxDestroy(int Team, int ID)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(Team);
+	Buffer.AddInt(ID);
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_box_destroy team=%d id=%d", Team, ID);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_BOX_DESTROY, Buffer.Data(), Buffer.Size());
+}
+
+void CTeeHistorian::RecordB2TeeCreate(int ClientID, int Team, float x, float y)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(ClientID);
+	Buffer.AddInt(Team);
+	Buffer.AddInt(Box2DFloatBits(x));
+	Buffer.AddInt(Box2DFloatBits(y));
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_tee_create cid=%d team=%d x=%f y=%f", ClientID, Team, x, y);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_TEE_CREATE, Buffer.Data(), Buffer.Size());
+}
+
+void CTeeHistorian::RecordB2TeeDestroy(int ClientID)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(ClientID);
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_tee_destroy cid=%d", ClientID);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_TEE_DESTROY, Buffer.Data(), Buffer.Size());
+}
+
+void CTeeHistorian::RecordB2TeeHammer(int ClientID, float DirX, float DirY)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(ClientID);
+	Buffer.AddInt(Box2DFloatBits(DirX));
+	Buffer.AddInt(Box2DFloatBits(DirY));
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_tee_hammer cid=%d dir_x=%f dir_y=%f", ClientID, DirX, DirY);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_TEE_HAMMER, Buffer.Data(), Buffer.Size());
+}
+
+void CTeeHistorian::RecordB2Impulse(int Team, int ID, float ImpulseX, float ImpulseY, float PointX, float PointY)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(Team);
+	Buffer.AddInt(ID);
+	Buffer.AddInt(Box2DFloatBits(ImpulseX));
+	Buffer.AddInt(Box2DFloatBits(ImpulseY));
+	Buffer.AddInt(Box2DFloatBits(PointX));
+	Buffer.AddInt(Box2DFloatBits(PointY));
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_impulse team=%d id=%d impulse_x=%f impulse_y=%f", Team, ID, ImpulseX, ImpulseY);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_IMPULSE, Buffer.Data(), Buffer.Size());
+}
+
+void CTeeHistorian::RecordB2Explosion(int Team, float x, float y, float Strength, int Mode)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(Team);
+	Buffer.AddInt(Box2DFloatBits(x));
+	Buffer.AddInt(Box2DFloatBits(y));
+	Buffer.AddInt(Box2DFloatBits(Strength));
+	Buffer.AddInt(Mode);
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_explosion team=%d x=%f y=%f strength=%f mode=%d", Team, x, y, Strength, Mode);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_EXPLOSION, Buffer.Data(), Buffer.Size());
+}
+
+void CTeeHistorian::RecordB2Sleep(int Team, int ID)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(Team);
+	Buffer.AddInt(ID);
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_sleep team=%d id=%d", Team, ID);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_SLEEP, Buffer.Data(), Buffer.Size());
+}
+
+void CTeeHistorian::RecordB2Step(int Team, float DeltaTime, float StepTime, int MaxSubsteps, int VelocityIterations, int PositionIterations)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(Team);
+	Buffer.AddInt(Box2DFloatBits(DeltaTime));
+	Buffer.AddInt(Box2DFloatBits(StepTime));
+	Buffer.AddInt(MaxSubsteps);
+	Buffer.AddInt(VelocityIterations);
+	Buffer.AddInt(PositionIterations);
+
+	if(m_Debug > 1)
+	{
+		dbg_msg("teehistorian", "box2d_step team=%d delta_time=%f step_time=%f max_substeps=%d iterations=%d/%d", Team, DeltaTime, StepTime, MaxSubsteps, VelocityIterations, PositionIterations);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_STEP, Buffer.Data(), Buffer.Size());
+}
+
+void CTeeHistorian::RecordB2Checksum(int Team, unsigned Checksum)
+{
+	CPacker Buffer;
+	Buffer.Reset();
+	Buffer.AddInt(Team);
+	Buffer.AddInt(Checksum);
+
+	if(m_Debug)
+	{
+		dbg_msg("teehistorian", "box2d_checksum team=%d checksum=%08x", Team, Checksum);
+	}
+
+	WriteExtra(UUID_TEEHISTORIAN_B2_CHECKSUM, Buffer.Data(), Buffer.Size());
+}
+
 void CTeeHistorian::EndInputs()
 {
 	dbg_assert(m_State == STATE_INPUTS, "invalid teehistorian state");
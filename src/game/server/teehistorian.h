@@ -13,6 +13,23 @@ class CConfig;
 class CTuningParams;
 class CUuidManager;
 
+// the chunk types, negated in the file
+enum
+{
+	TEEHISTORIAN_NONE,
+	TEEHISTORIAN_FINISH,
+	TEEHISTORIAN_TICK_SKIP,
+	TEEHISTORIAN_PLAYER_NEW,
+	TEEHISTORIAN_PLAYER_OLD,
+	TEEHISTORIAN_INPUT_DIFF,
+	TEEHISTORIAN_INPUT_NEW,
+	TEEHISTORIAN_MESSAGE,
+	TEEHISTORIAN_JOIN,
+	TEEHISTORIAN_DROP,
+	TEEHISTORIAN_CONSOLE_COMMAND,
+	TEEHISTORIAN_EX,
+};
+
 class CTeeHistorian
 {
 public:
@@ -81,6 +98,23 @@ public:
 	void RecordAuthLogin(int ClientID, int Level, const char *pAuthName);
 	void RecordAuthLogout(int ClientID);
 
+	// the operations on the box2d worlds, see CBox2DReplay. teams identify
+	// the worlds, boxes have an id per world counting up from 0
+	void RecordB2WorldCreate(int Team, bool MapOutlines, bool MapQuads);
+	void RecordB2WorldDestroy(int Team);
+	// pState is packed with PackBox2DHistoryState(), the boxes get ids
+	// starting at FirstID
+	void RecordB2Boxes(int Team, int FirstID, const void *pState, int StateSize);
+	void RecordB2BoxDestroy(int Team, int ID);
+	void RecordB2TeeCreate(int ClientID, int Team, float x, float y);
+	void RecordB2TeeDestroy(int ClientID);
+	void RecordB2TeeHammer(int ClientID, float DirX, float DirY);
+	void RecordB2Impulse(int Team, int ID, float ImpulseX, float ImpulseY, float PointX, float PointY);
+	void RecordB2Explosion(int Team, float x, float y, float Strength, int Mode);
+	void RecordB2Sleep(int Team, int ID);
+	void RecordB2Step(int Team, float DeltaTime, float StepTime, int MaxSubsteps, int VelocityIterations, int PositionIterations);
+	void RecordB2Checksum(int Team, unsigned Checksum);
+
 	int m_Debug; // Possible values: 0, 1, 2.
 
 private:
@@ -184,10 +184,25 @@ MACRO_CONFIG_INT(SvPractice, sv_practice, 1, 0, 1, CFGFLAG_SERVER, "Enable pract
 
 // Box2D
 MACRO_CONFIG_INT(B2WorldFps, b2_world_fps, 30, 0, 300, CFGFLAG_SERVER, "box2d world fps (not really fps, higher value slows down the world)")
-MACRO_CONFIG_INT(B2TeeJointMaxForce, b2_teejoint_maxforce, 100000, 0, 2147483647, CFGFLAG_SERVER, "maxForce value for the tee's box2d mouse joint")
-MACRO_CONFIG_INT(B2TeeJointDamping, b2_teejoint_damping, 4, 0, 2147483647, CFGFLAG_SERVER, "damping value for the tee's box2d mouse joint")
-MACRO_CONFIG_INT(B2TeeJointStiffness, b2_teejoint_stiffness, 100000, 0, 2147483647, CFGFLAG_SERVER, "stiffness value for the tee's box2d mouse joint")
+MACRO_CONFIG_INT(B2StepRate, b2_step_rate, 0, 0, 1000, CFGFLAG_SERVER, "fixed box2d step rate in Hz, independent of the server tick speed (0 = one step of 1/b2_world_fps per tick)")
+MACRO_CONFIG_INT(B2MaxSubsteps, b2_max_substeps, 4, 1, 32, CFGFLAG_SERVER, "maximum number of box2d steps per tick with b2_step_rate, higher step rates are lowered to fit")
+MACRO_CONFIG_INT(B2TeeJointMaxForce, b2_teejoint_maxforce, 100000, 0, 2147483647, CFGFLAG_SERVER, "(deprecated) The tee bodies have no mouse joint anymore")
+MACRO_CONFIG_INT(B2TeeJointDamping, b2_teejoint_damping, 4, 0, 2147483647, CFGFLAG_SERVER, "(deprecated) The tee bodies have no mouse joint anymore")
+MACRO_CONFIG_INT(B2TeeJointStiffness, b2_teejoint_stiffness, 100000, 0, 2147483647, CFGFLAG_SERVER, "(deprecated) The tee bodies have no mouse joint anymore")
+MACRO_CONFIG_INT(B2Threads, b2_threads, 0, 0, 32, CFGFLAG_SERVER, "number of threads stepping the box2d team worlds in parallel, while the snapshots are built (0 = step on the main thread)")
+MACRO_CONFIG_INT(B2MapColliders, b2_map_colliders, 1, 0, 1, CFGFLAG_SERVER, "build static box2d colliders from the solid tiles and the quads of the Box2D group of the map on map load")
+MACRO_CONFIG_INT(B2ExplosionMode, b2_explosion_mode, 0, 0, 1, CFGFLAG_SERVER, "how explosions push box2d bodies (0 = impulse rays, 1 = pooled particle bodies)")
+MACRO_CONFIG_INT(B2ProjectileImpulse, b2_projectile_impulse, 5, 0, 1000, CFGFLAG_SERVER, "impulse given to a box2d box hit by a projectile")
 MACRO_CONFIG_INT(B2TeeLaser, b2_tee_laser, 0, 0, 1, CFGFLAG_SERVER, "draws your tee in the box2d world as a laser")
+MACRO_CONFIG_INT(B2StepBudget, b2_step_budget, 0, 0, 1000000, CFGFLAG_SERVER, "box2d step time per tick in microseconds, of the slowest world with b2_threads and of all worlds together without, above it the solver iterations are lowered and far bodies put to sleep (0 = no budget)")
+MACRO_CONFIG_INT(B2SleepDistance, b2_sleep_distance, 1600, 0, 1000000, CFGFLAG_SERVER, "distance to the closest tee beyond which boxes are put to sleep when b2_step_budget is exceeded")
+MACRO_CONFIG_INT(B2MaxBoxes, b2_max_boxes, 1000, 0, 100000, CFGFLAG_SERVER, "maximum number of box2d boxes in all worlds together (0 = no limit)")
+MACRO_CONFIG_INT(B2KeyframeInterval, b2_keyframe_interval, 25, 1, 1000, CFGFLAG_SERVER, "maximum number of ticks between two keyframes of an awake box2d body for clients that extrapolate them")
+MACRO_CONFIG_INT(B2KeyframeError, b2_keyframe_error, 2, 0, 100, CFGFLAG_SERVER, "how far in units the clients' extrapolation of a box2d body may be off before it gets a new keyframe")
+MACRO_CONFIG_INT(B2ImpactSpeed, b2_impact_speed, 300, 0, 100000, CFGFLAG_SERVER, "how fast in units per second box2d bodies have to hit something to make a sound or push a tee (0 = no impacts)")
+MACRO_CONFIG_INT(B2ImpactForce, b2_impact_force, 0, 0, 1000, CFGFLAG_SERVER, "how much of its speed in percent a box2d body that hits a tee at least at b2_impact_speed passes on to it (0 = boxes don't push tees)")
+MACRO_CONFIG_INT(B2HistoryChecksum, b2_history_checksum, 50, 0, 100000, CFGFLAG_SERVER, "record a checksum of every box2d world in the teehistorian every this many ticks (0 = never)")
+MACRO_CONFIG_INT(B2KeepOnReload, b2_keep_on_reload, 1, 0, 1, CFGFLAG_SERVER, "keep the box2d boxes outside of teams when the same map is reloaded")
 
 MACRO_CONFIG_INT(ClVideoPauseWithDemo, cl_video_pausewithdemo, 1, 0, 1, CFGFLAG_CLIENT | CFGFLAG_SAVE, "Pause video rendering when demo playing pause")
 MACRO_CONFIG_INT(ClVideoShowhud, cl_video_showhud, 0, 0, 1, CFGFLAG_CLIENT | CFGFLAG_SAVE, "Show ingame HUD when rendering video")
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <game/server/box2d_contacts.h>
+
+// the listener only compares the bodies, it never touches them
+static b2Body *FakeBody(int i)
+{
+	static char s_aBodies[4];
+	return (b2Body *)&s_aBodies[i];
+}
+
+TEST(Box2DContacts, PairOrder)
+{
+	CBox2DContactListener Listener;
+	Listener.Add(CBox2DContactEvent::BEGIN, FakeBody(1), FakeBody(0));
+	ASSERT_EQ(Listener.NumEvents(), 1);
+	EXPECT_EQ(Listener.Event(0).m_pBodyA, FakeBody(0));
+	EXPECT_EQ(Listener.Event(0).m_pBodyB, FakeBody(1));
+
+	// the normal and the velocities go with the bodies
+	Listener.Add(CBox2DContactEvent::IMPACT, FakeBody(3), FakeBody(2), vec2(0, 0), vec2(0, 1), vec2(0, 400), vec2(0, 100));
+	ASSERT_EQ(Listener.NumEvents(), 2);
+	EXPECT_EQ(Listener.Event(1).m_pBodyA, FakeBody(2));
+	EXPECT_EQ(Listener.Event(1).m_Normal, vec2(0, -1));
+	EXPECT_EQ(Listener.Event(1).m_VelA, vec2(0, 100));
+	EXPECT_EQ(Listener.Event(1).m_VelB, vec2(0, 400));
+	EXPECT_EQ(Listener.Event(1).m_Speed, 300.0f);
+}
+
+TEST(Box2DContacts, MergeTouches)
+{
+	CBox2DContactListener Listener;
+	// touched and let go again within the tick
+	Listener.Add(CBox2DContactEvent::BEGIN, FakeBody(0), FakeBody(1));
+	Listener.Add(CBox2DContactEvent::END, FakeBody(0), FakeBody(1));
+	// let go and touched again, still touching
+	Listener.Add(CBox2DContactEvent::END, FakeBody(1), FakeBody(2));
+	Listener.Add(CBox2DContactEvent::BEGIN, FakeBody(2), FakeBody(1));
+	// the only change of the tick
+	Listener.Add(CBox2DContactEvent::END, FakeBody(0), FakeBody(3));
+	Listener.Finish();
+
+	ASSERT_EQ(Listener.NumEvents(), 1);
+	EXPECT_EQ(Listener.Event(0).m_Type, CBox2DContactEvent::END);
+	EXPECT_EQ(Listener.Event(0).m_pBodyA, FakeBody(0));
+	EXPECT_EQ(Listener.Event(0).m_pBodyB, FakeBody(3));
+}
+
+TEST(Box2DContacts, StrongestImpact)
+{
+	CBox2DContactListener Listener;
+	Listener.Add(CBox2DContactEvent::IMPACT, FakeBody(0), FakeBody(1), vec2(10, 0), vec2(1, 0), vec2(300, 0));
+	Listener.Add(CBox2DContactEvent::BEGIN, FakeBody(0), FakeBody(1));
+	Listener.Add(CBox2DContactEvent::IMPACT, FakeBody(2), FakeBody(3), vec2(0, 0), vec2(1, 0), vec2(100, 0));
+	Listener.Add(CBox2DContactEvent::IMPACT, FakeBody(1), FakeBody(0), vec2(20, 0), vec2(-1, 0), vec2(0, 0), vec2(500, 0));
+	Listener.Add(CBox2DContactEvent::IMPACT, FakeBody(0), FakeBody(1), vec2(30, 0), vec2(1, 0), vec2(400, 0));
+	Listener.Finish();
+
+	ASSERT_EQ(Listener.NumEvents(), 3);
+	EXPECT_EQ(Listener.Event(0).m_Type, CBox2DContactEvent::BEGIN);
+	EXPECT_EQ(Listener.Event(1).m_Type, CBox2DContactEvent::IMPACT);
+	EXPECT_EQ(Listener.Event(1).m_Speed, 500.0f);
+	EXPECT_EQ(Listener.Event(1).m_Pos, vec2(20, 0));
+	EXPECT_EQ(Listener.Event(2).m_Type, CBox2DContactEvent::IMPACT);
+	EXPECT_EQ(Listener.Event(2).m_pBodyA, FakeBody(2));
+}
+
+TEST(Box2DContacts, Full)
+{
+	CBox2DContactListener Listener;
+	for(int i = 0; i < CBox2DContactListener::MAX_EVENTS + 5; i++)
+		Listener.Add(CBox2DContactEvent::IMPACT, FakeBody(0), FakeBody(1), vec2(0, 0), vec2(1, 0), vec2(i, 0));
+	EXPECT_EQ(Listener.NumEvents(), (int)CBox2DContactListener::MAX_EVENTS);
+	EXPECT_EQ(Listener.NumDropped(), 5);
+
+	Listener.Finish();
+	ASSERT_EQ(Listener.NumEvents(), 1);
+	EXPECT_EQ(Listener.Event(0).m_Speed, CBox2DContactListener::MAX_EVENTS - 1);
+
+	// the drops are counted per tick as well
+	Listener.Clear();
+	EXPECT_EQ(Listener.NumEvents(), 0);
+	EXPECT_EQ(Listener.NumDropped(), 0);
+}
+
+TEST(Box2DContacts, RemoveBody)
+{
+	CBox2DContactListener Listener;
+	Listener.Add(CBox2DContactEvent::BEGIN, FakeBody(0), FakeBody(1));
+	Listener.Add(CBox2DContactEvent::BEGIN, FakeBody(2), FakeBody(3));
+	Listener.Add(CBox2DContactEvent::IMPACT, FakeBody(1), FakeBody(2), vec2(0, 0), vec2(1, 0), vec2(100, 0));
+	Listener.Finish();
+	Listener.RemoveBody(FakeBody(1));
+	ASSERT_EQ(Listener.NumEvents(), 1);
+	EXPECT_EQ(Listener.Event(0).m_pBodyA, FakeBody(2));
+	EXPECT_EQ(Listener.Event(0).m_pBodyB, FakeBody(3));
+}
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <game/server/box2d_governor.h>
+
+TEST(Box2DGovernor, NoBudget)
+{
+	CBox2DGovernor Governor;
+	EXPECT_FALSE(Governor.Update(100.0f, 0.0f));
+	EXPECT_EQ(Governor.Level(), 0);
+	EXPECT_EQ(Governor.VelocityIterations(), 8);
+	EXPECT_EQ(Governor.PositionIterations(), 3);
+}
+
+TEST(Box2DGovernor, OverBudget)
+{
+	CBox2DGovernor Governor;
+	for(int i = 1; i <= CBox2DGovernor::MAX_LEVEL; i++)
+	{
+		EXPECT_TRUE(Governor.Update(5.0f, 2.0f));
+		EXPECT_EQ(Governor.Level(), i);
+	}
+	EXPECT_FALSE(Governor.Update(5.0f, 2.0f));
+	EXPECT_TRUE(Governor.SleepFarBodies());
+	EXPECT_LT(Governor.VelocityIterations(), 8);
+}
+
+TEST(Box2DGovernor, Recover)
+{
+	CBox2DGovernor Governor;
+	Governor.Update(5.0f, 2.0f);
+	Governor.Update(5.0f, 2.0f);
+	ASSERT_EQ(Governor.Level(), 2);
+
+	// within the budget, but not well below it
+	for(int i = 0; i < CBox2DGovernor::RECOVER_TICKS * 2; i++)
+		EXPECT_FALSE(Governor.Update(1.5f, 2.0f));
+
+	for(int i = 0; i < CBox2DGovernor::RECOVER_TICKS - 1; i++)
+		EXPECT_FALSE(Governor.Update(0.5f, 2.0f));
+	EXPECT_TRUE(Governor.Update(0.5f, 2.0f));
+	EXPECT_EQ(Governor.Level(), 1);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <game/server/box2d_history.h>
+
+#include <box2d/box2d.h>
+
+static CBox2DWorldState TwoBoxes()
+{
+	CBox2DWorldState State;
+	CBox2DBodyState Box = {b2_dynamicBody, vec2(1000.1f, -200.3f), 1.0f / 3.0f, vec2(30.0f, -4.7f), 0.1f, ivec2(64, 32), 1.0f, 0.3f};
+	CBox2DBodyState Ground = {b2_kinematicBody, vec2(0.0f, 640.0f), 0.0f, vec2(0.0f, 0.0f), 0.0f, ivec2(512, 16), 0.0f, 0.2f};
+	State.m_vBodies.push_back(Box);
+	State.m_vBodies.push_back(Ground);
+	CBox2DJointState Joint = {e_revoluteJoint, 0, 1, true, vec2(16.1f, 0.0f), vec2(-100.0f, 8.3f), 0.7f, 0.0f};
+	State.m_vJoints.push_back(Joint);
+	return State;
+}
+
+TEST(Box2DHistory, FloatBits)
+{
+	float aValues[] = {0.0f, -0.0f, 1.0f / 3.0f, -1e-30f, 3.4e38f};
+	for(float Value : aValues)
+	{
+		float Result = Box2DBitsFloat(Box2DFloatBits(Value));
+		EXPECT_EQ(mem_comp(&Result, &Value, sizeof(Value)), 0);
+	}
+}
+
+TEST(Box2DHistory, ExactRoundTrip)
+{
+	CBox2DWorldState State = TwoBoxes();
+	std::vector<unsigned char> vData;
+	PackBox2DHistoryState(State, vData);
+
+	CBox2DWorldState Loaded;
+	ASSERT_TRUE(UnpackBox2DHistoryState(&Loaded, vData.data(), vData.size()));
+	ASSERT_EQ(Loaded.m_vBodies.size(), 2u);
+	ASSERT_EQ(Loaded.m_vJoints.size(), 1u);
+	for(int i = 0; i < 2; i++)
+	{
+		const CBox2DBodyState &Expected = State.m_vBodies[i];
+		const CBox2DBodyState &Body = Loaded.m_vBodies[i];
+		EXPECT_EQ(Body.m_Type, Expected.m_Type);
+		EXPECT_EQ(Body.m_Pos, Expected.m_Pos);
+		EXPECT_EQ(Body.m_Angle, Expected.m_Angle);
+		EXPECT_EQ(Body.m_Vel, Expected.m_Vel);
+		EXPECT_EQ(Body.m_AngularVel, Expected.m_AngularVel);
+		EXPECT_EQ(Body.m_Size, Expected.m_Size);
+		EXPECT_EQ(Body.m_Density, Expected.m_Density);
+		EXPECT_EQ(Body.m_Friction, Expected.m_Friction);
+	}
+	const CBox2DJointState &Expected = State.m_vJoints[0];
+	const CBox2DJointState &Joint = Loaded.m_vJoints[0];
+	EXPECT_EQ(Joint.m_Type, Expected.m_Type);
+	EXPECT_EQ(Joint.m_BodyA, Expected.m_BodyA);
+	EXPECT_EQ(Joint.m_BodyB, Expected.m_BodyB);
+	EXPECT_EQ(Joint.m_CollideConnected, Expected.m_CollideConnected);
+	EXPECT_EQ(Joint.m_AnchorA, Expected.m_AnchorA);
+	EXPECT_EQ(Joint.m_AnchorB, Expected.m_AnchorB);
+	EXPECT_EQ(Joint.m_ReferenceAngle, Expected.m_ReferenceAngle);
+	EXPECT_EQ(Joint.m_Length, Expected.m_Length);
+}
+
+TEST(Box2DHistory, Invalid)
+{
+	std::vector<unsigned char> vData;
+	PackBox2DHistoryState(TwoBoxes(), vData);
+
+	CBox2DWorldState Loaded;
+	EXPECT_FALSE(UnpackBox2DHistoryState(&Loaded, vData.data(), vData.size() - 1));
+	EXPECT_TRUE(Loaded.Empty());
+
+	vData.push_back(0);
+	EXPECT_FALSE(UnpackBox2DHistoryState(&Loaded, vData.data(), vData.size()));
+
+	CBox2DWorldState State = TwoBoxes();
+	State.m_vJoints[0].m_BodyB = 2;
+	vData.clear();
+	PackBox2DHistoryState(State, vData);
+	EXPECT_FALSE(UnpackBox2DHistoryState(&Loaded, vData.data(), vData.size()));
+}
+
+static void AddBox(b2World *pWorld, float x, float y)
+{
+	b2BodyDef BodyDef;
+	BodyDef.type = b2_dynamicBody;
+	BodyDef.position.Set(x, y);
+	b2Body *pBody = pWorld->CreateBody(&BodyDef);
+	b2PolygonShape Shape;
+	Shape.SetAsBox(0.5f, 0.5f);
+	pBody->CreateFixture(&Shape, 1.0f);
+}
+
+TEST(Box2DHistory, Checksum)
+{
+	b2World World1(b2Vec2(0.0f, 9.81f));
+	b2World World2(b2Vec2(0.0f, 9.81f));
+	EXPECT_EQ(Box2DWorldChecksum(&World1), Box2DWorldChecksum(&World2));
+
+	AddBox(&World1, 1.0f, 2.0f);
+	AddBox(&World2, 1.0f, 2.0f);
+	EXPECT_EQ(Box2DWorldChecksum(&World1), Box2DWorldChecksum(&World2));
+
+	// the same simulation gives the same result
+	for(int i = 0; i < 10; i++)
+	{
+		World1.Step(1.0f / 50.0f, 8, 3);
+		World2.Step(1.0f / 50.0f, 8, 3);
+	}
+	EXPECT_EQ(Box2DWorldChecksum(&World1), Box2DWorldChecksum(&World2));
+
+	World2.GetBodyList()->ApplyLinearImpulse(b2Vec2(0.0f, -0.001f), World2.GetBodyList()->GetPosition(), true);
+	EXPECT_NE(Box2DWorldChecksum(&World1), Box2DWorldChecksum(&World2));
+	World1.GetBodyList()->ApplyLinearImpulse(b2Vec2(0.0f, -0.001f), World1.GetBodyList()->GetPosition(), true);
+	EXPECT_EQ(Box2DWorldChecksum(&World1), Box2DWorldChecksum(&World2));
+
+	World1.GetBodyList()->SetAwake(false);
+	EXPECT_NE(Box2DWorldChecksum(&World1), Box2DWorldChecksum(&World2));
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include <game/box2d_keyframe.h>
+
+static CNetObj_Box2DBody Keyframe(int X, int Y, int Angle, int VelX, int VelY, int AngularVel)
+{
+	CNetObj_Box2DBody Body = {};
+	Body.m_X = X;
+	Body.m_Y = Y;
+	Body.m_Angle = Angle;
+	Body.m_VelX = VelX;
+	Body.m_VelY = VelY;
+	Body.m_AngularVel = AngularVel;
+	return Body;
+}
+
+TEST(Box2DKeyframe, AtKeyframe)
+{
+	CNetObj_Box2DBody Body = Keyframe(100, -50, 16384, 256, 512, 100);
+	vec2 Pos;
+	float Angle;
+	ExtrapolateBox2DBody(&Body, 0, vec2(0, 1), &Pos, &Angle);
+	EXPECT_EQ(Pos, vec2(100, -50));
+	EXPECT_FLOAT_EQ(Angle, pi / 2);
+}
+
+TEST(Box2DKeyframe, Velocity)
+{
+	CNetObj_Box2DBody Body = Keyframe(0, 0, 0, 128, -256, 65536 / 100);
+	vec2 Pos;
+	float Angle;
+	ExtrapolateBox2DBody(&Body, 10, vec2(0, 0), &Pos, &Angle);
+	EXPECT_FLOAT_EQ(Pos.x, 5);
+	EXPECT_FLOAT_EQ(Pos.y, -10);
+	EXPECT_NEAR(Angle, 2 * pi / 10, 0.001f);
+}
+
+TEST(Box2DKeyframe, Gravity)
+{
+	// the velocity grows before the body moves: 1 + 2 + 3
+	CNetObj_Box2DBody Body = Keyframe(0, 0, 0, 0, 0, 0);
+	vec2 Pos;
+	float Angle;
+	ExtrapolateBox2DBody(&Body, 3, vec2(0, 1), &Pos, &Angle);
+	EXPECT_FLOAT_EQ(Pos.x, 0);
+	EXPECT_FLOAT_EQ(Pos.y, 6);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <game/box2d_map.h>
+#include <game/mapitems.h>
+
+static std::vector<CTileOutline> Outlines(const char *pMap, int Width, int Height)
+{
+	std::vector<unsigned char> vSolid;
+	for(int i = 0; i < Width * Height; i++)
+		vSolid.push_back(pMap[i] == '#');
+	std::vector<CTileOutline> vOutlines;
+	FindTileOutlines(vSolid.data(), Width, Height, vOutlines);
+	return vOutlines;
+}
+
+TEST(Box2DMap, Empty)
+{
+	EXPECT_TRUE(Outlines("....", 2, 2).empty());
+}
+
+TEST(Box2DMap, SingleTile)
+{
+	std::vector<CTileOutline> vOutlines = Outlines(
+		"..."
+		".#."
+		"...",
+		3, 3);
+	ASSERT_EQ(vOutlines.size(), 1u);
+	CTileOutline Expected = {ivec2(1, 1), ivec2(2, 1), ivec2(2, 2), ivec2(1, 2)};
+	EXPECT_EQ(vOutlines[0], Expected);
+}
+
+TEST(Box2DMap, MergeCollinear)
+{
+	std::vector<CTileOutline> vOutlines = Outlines(
+		"####"
+		"####",
+		4, 2);
+	ASSERT_EQ(vOutlines.size(), 1u);
+	CTileOutline Expected = {ivec2(0, 0), ivec2(4, 0), ivec2(4, 2), ivec2(0, 2)};
+	EXPECT_EQ(vOutlines[0], Expected);
+}
+
+TEST(Box2DMap, Concave)
+{
+	std::vector<CTileOutline> vOutlines = Outlines(
+		"#.."
+		"###",
+		3, 2);
+	ASSERT_EQ(vOutlines.size(), 1u);
+	CTileOutline Expected = {ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(3, 1), ivec2(3, 2), ivec2(0, 2)};
+	EXPECT_EQ(vOutlines[0], Expected);
+}
+
+TEST(Box2DMap, Hole)
+{
+	std::vector<CTileOutline> vOutlines = Outlines(
+		"###"
+		"#.#"
+		"###",
+		3, 3);
+	ASSERT_EQ(vOutlines.size(), 2u);
+	CTileOutline Outer = {ivec2(0, 0), ivec2(3, 0), ivec2(3, 3), ivec2(0, 3)};
+	CTileOutline Hole = {ivec2(1, 1), ivec2(1, 2), ivec2(2, 2), ivec2(2, 1)};
+	EXPECT_EQ(vOutlines[0], Outer);
+	EXPECT_EQ(vOutlines[1], Hole);
+}
+
+TEST(Box2DMap, Diagonal)
+{
+	std::vector<CTileOutline> vOutlines = Outlines(
+		"#."
+		".#",
+		2, 2);
+	ASSERT_EQ(vOutlines.size(), 2u);
+	CTileOutline First = {ivec2(0, 0), ivec2(1, 0), ivec2(1, 1), ivec2(0, 1)};
+	CTileOutline Second = {ivec2(1, 1), ivec2(2, 1), ivec2(2, 2), ivec2(1, 2)};
+	EXPECT_EQ(vOutlines[0], First);
+	EXPECT_EQ(vOutlines[1], Second);
+}
+
+static CQuad Quad(vec2 TopLeft, vec2 TopRight, vec2 BottomLeft, vec2 BottomRight)
+{
+	CQuad Quad = {};
+	vec2 aPoints[4] = {TopLeft, TopRight, BottomLeft, BottomRight};
+	for(int i = 0; i < 4; i++)
+	{
+		Quad.m_aPoints[i].x = f2fx(aPoints[i].x);
+		Quad.m_aPoints[i].y = f2fx(aPoints[i].y);
+	}
+	Quad.m_PosEnv = -1;
+	return Quad;
+}
+
+TEST(Box2DMap, QuadPolygon)
+{
+	CQuad Square = Quad(vec2(0, 0), vec2(64, 0), vec2(0, 32), vec2(64, 32));
+	CQuadPolygon Polygon;
+	ASSERT_TRUE(GetQuadPolygon(&Square, vec2(100, 200), &Polygon));
+	EXPECT_EQ(Polygon.m_aPoints[0], vec2(-100, -200));
+	EXPECT_EQ(Polygon.m_aPoints[1], vec2(-36, -200));
+	EXPECT_EQ(Polygon.m_aPoints[2], vec2(-36, -168));
+	EXPECT_EQ(Polygon.m_aPoints[3], vec2(-100, -168));
+}
+
+TEST(Box2DMap, FlatQuad)
+{
+	CQuad Line = Quad(vec2(0, 0), vec2(64, 0), vec2(0, 0), vec2(64, 0));
+	CQuadPolygon Polygon;
+	EXPECT_FALSE(GetQuadPolygon(&Line, vec2(0, 0), &Polygon));
+
+	// large enough, but box2d would weld two of the corners
+	CQuad Welded = Quad(vec2(0, 0), vec2(64, 0), vec2(0, 64), vec2(0.1f, 64));
+	EXPECT_FALSE(GetQuadPolygon(&Welded, vec2(0, 0), &Polygon));
+
+	// a long sliver, thinner than the slop
+	CQuad Sliver = Quad(vec2(0, 0), vec2(10000, 0), vec2(0, 0.1f), vec2(10000, 0.1f));
+	EXPECT_FALSE(GetQuadPolygon(&Sliver, vec2(0, 0), &Polygon));
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <game/server/box2d_prefab.h>
+
+#include <box2d/box2d.h>
+
+#include <string>
+
+static const char s_aPendulum[] = R"({
+	"boxes": [
+		{"pos": [0, 0], "size": [64, 16], "static": true},
+		{"pos": [0, 100], "size": [32, 32], "density": 2.5, "friction": 0.5, "angle": 90}
+	],
+	"joints": [
+		{"type": "distance", "a": 0, "b": 1, "anchor_b": [0, -16]}
+	]
+})";
+
+static bool Parse(CBox2DPrefab *pPrefab, const char *pJson)
+{
+	char aError[128];
+	return pPrefab->FromJson(pJson, str_length(pJson), aError, sizeof(aError));
+}
+
+TEST(Box2DPrefab, Parse)
+{
+	CBox2DPrefab Prefab;
+	ASSERT_TRUE(Parse(&Prefab, s_aPendulum));
+	const CBox2DWorldState &State = Prefab.State();
+	ASSERT_EQ(State.m_vBodies.size(), 2u);
+	ASSERT_EQ(State.m_vJoints.size(), 1u);
+
+	EXPECT_EQ(State.m_vBodies[0].m_Type, b2_staticBody);
+	EXPECT_FLOAT_EQ(State.m_vBodies[0].m_Density, 1.0f);
+	EXPECT_FLOAT_EQ(State.m_vBodies[0].m_Friction, 0.2f);
+	EXPECT_EQ(State.m_vBodies[1].m_Type, b2_dynamicBody);
+	EXPECT_EQ(State.m_vBodies[1].m_Size, ivec2(32, 32));
+	EXPECT_FLOAT_EQ(State.m_vBodies[1].m_Density, 2.5f);
+	EXPECT_FLOAT_EQ(State.m_vBodies[1].m_Friction, 0.5f);
+	EXPECT_FLOAT_EQ(State.m_vBodies[1].m_Angle, pi / 2);
+	EXPECT_EQ(Prefab.Size(), vec2(64, 124));
+
+	// the anchor of the rotated box is turned with it
+	const CBox2DJointState &Joint = State.m_vJoints[0];
+	EXPECT_EQ(Joint.m_Type, e_distanceJoint);
+	EXPECT_NEAR(Joint.m_Length, distance(vec2(0, 0), vec2(16, 100)), 0.01f);
+}
+
+TEST(Box2DPrefab, Invalid)
+{
+	CBox2DPrefab Prefab;
+	EXPECT_FALSE(Parse(&Prefab, "{"));
+	EXPECT_FALSE(Parse(&Prefab, R"({"boxes": []})"));
+	EXPECT_FALSE(Parse(&Prefab, R"({"boxes": [{"pos": [0, 0]}]})"));
+	EXPECT_FALSE(Parse(&Prefab, R"({"boxes": [{"pos": [0, 0], "size": [8, 8]}], "joints": [{"type": "weld", "a": 0, "b": 1}]})"));
+	EXPECT_FALSE(Parse(&Prefab, R"({"boxes": [{"pos": [0, 0], "size": [8, 8]}], "joints": [{"type": "rope", "a": 0, "b": 0}]})"));
+	EXPECT_TRUE(Prefab.State().Empty());
+
+	std::string Many = R"({"boxes": [)";
+	for(int i = 0; i <= CBox2DPrefab::MAX_BOXES; i++)
+		Many += std::string(i ? "," : "") + R"({"pos": [0, 0], "size": [8, 8]})";
+	Many += "]}";
+	EXPECT_FALSE(Parse(&Prefab, Many.c_str()));
+}
+
+TEST(Box2DPrefab, Instantiate)
+{
+	CBox2DPrefab Prefab;
+	ASSERT_TRUE(Parse(&Prefab, s_aPendulum));
+	CBox2DWorldState State;
+	Prefab.Instantiate(&State, vec2(1000, 500), 3, 2, 10);
+	ASSERT_EQ(State.m_vBodies.size(), 12u);
+	ASSERT_EQ(State.m_vJoints.size(), 6u);
+
+	// the second copy is right of the first, the fourth above it
+	EXPECT_EQ(State.m_vBodies[2].m_Pos, vec2(1074, 500));
+	EXPECT_EQ(State.m_vBodies[6].m_Pos, vec2(1000, 366));
+	EXPECT_EQ(State.m_vJoints[5].m_BodyA, 10);
+	EXPECT_EQ(State.m_vJoints[5].m_BodyB, 11);
+}
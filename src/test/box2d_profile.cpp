@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <game/server/box2d_profile.h>
+
+static CBox2DProfileSample Sample(int Tick, float Step)
+{
+	CBox2DProfileSample Sample;
+	mem_zero(&Sample, sizeof(Sample));
+	Sample.m_Tick = Tick;
+	Sample.m_aValues[CBox2DProfileSample::STEP] = Step;
+	return Sample;
+}
+
+TEST(Box2DProfile, Empty)
+{
+	CBox2DProfile Profile(10);
+	EXPECT_EQ(Profile.NumSamples(), 0);
+	EXPECT_EQ(Profile.Percentile(CBox2DProfileSample::STEP, 0.5f), 0.0f);
+}
+
+TEST(Box2DProfile, Percentiles)
+{
+	CBox2DProfile Profile(100);
+	for(int i = 0; i < 100; i++)
+		Profile.Add(Sample(i, 100 - i));
+	EXPECT_EQ(Profile.Percentile(CBox2DProfileSample::STEP, 0.0f), 1.0f);
+	EXPECT_EQ(Profile.Percentile(CBox2DProfileSample::STEP, 0.5f), 51.0f);
+	EXPECT_EQ(Profile.Percentile(CBox2DProfileSample::STEP, 0.99f), 99.0f);
+	EXPECT_EQ(Profile.Percentile(CBox2DProfileSample::STEP, 1.0f), 100.0f);
+}
+
+TEST(Box2DProfile, RollingWindow)
+{
+	CBox2DProfile Profile(4);
+	Profile.Add(Sample(0, 1000));
+	for(int i = 1; i <= 4; i++)
+		Profile.Add(Sample(i, i));
+	EXPECT_EQ(Profile.NumSamples(), 4);
+	// the spike fell out of the window
+	EXPECT_EQ(Profile.Percentile(CBox2DProfileSample::STEP, 1.0f), 4.0f);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <game/server/box2d_save.h>
+
+#include <box2d/box2d.h>
+
+#include <engine/shared/compression.h>
+
+static CBox2DWorldState TwoBoxes()
+{
+	CBox2DWorldState State;
+	CBox2DBodyState Box = {b2_dynamicBody, vec2(1000.5f, -200.25f), 1.0f, vec2(30.0f, -4.5f), 0.5f, ivec2(64, 32), 1.0f, 0.5f};
+	CBox2DBodyState Ground = {b2_kinematicBody, vec2(0.0f, 640.0f), 0.0f, vec2(0.0f, 0.0f), 0.0f, ivec2(512, 16), 0.0f, 0.2f};
+	State.m_vBodies.push_back(Box);
+	State.m_vBodies.push_back(Ground);
+	CBox2DJointState Joint = {e_revoluteJoint, 0, 1, false, vec2(16.0f, 0.0f), vec2(-100.0f, 8.0f), 0.25f, 0.0f};
+	State.m_vJoints.push_back(Joint);
+	return State;
+}
+
+TEST(Box2DSave, Empty)
+{
+	CBox2DWorldState State;
+	std::vector<unsigned char> vData;
+	State.Pack(vData);
+	CBox2DWorldState Loaded;
+	EXPECT_TRUE(Loaded.Unpack(vData.data(), vData.size()));
+	EXPECT_TRUE(Loaded.Empty());
+	EXPECT_TRUE(Loaded.m_vJoints.empty());
+}
+
+TEST(Box2DSave, RoundTrip)
+{
+	CBox2DWorldState State = TwoBoxes();
+	std::vector<unsigned char> vData;
+	State.Pack(vData);
+
+	CBox2DWorldState Loaded;
+	ASSERT_TRUE(Loaded.Unpack(vData.data(), vData.size()));
+	ASSERT_EQ(Loaded.m_vBodies.size(), 2u);
+	ASSERT_EQ(Loaded.m_vJoints.size(), 1u);
+	for(int i = 0; i < 2; i++)
+	{
+		const CBox2DBodyState &Expected = State.m_vBodies[i];
+		const CBox2DBodyState &Body = Loaded.m_vBodies[i];
+		EXPECT_EQ(Body.m_Type, Expected.m_Type);
+		EXPECT_NEAR(Body.m_Pos.x, Expected.m_Pos.x, 0.01f);
+		EXPECT_NEAR(Body.m_Pos.y, Expected.m_Pos.y, 0.01f);
+		EXPECT_NEAR(Body.m_Angle, Expected.m_Angle, 0.001f);
+		EXPECT_NEAR(Body.m_Vel.x, Expected.m_Vel.x, 0.01f);
+		EXPECT_NEAR(Body.m_Vel.y, Expected.m_Vel.y, 0.01f);
+		EXPECT_NEAR(Body.m_AngularVel, Expected.m_AngularVel, 0.001f);
+		EXPECT_EQ(Body.m_Size, Expected.m_Size);
+		EXPECT_NEAR(Body.m_Density, Expected.m_Density, 0.001f);
+		EXPECT_NEAR(Body.m_Friction, Expected.m_Friction, 0.001f);
+	}
+	const CBox2DJointState &Joint = Loaded.m_vJoints[0];
+	EXPECT_EQ(Joint.m_Type, e_revoluteJoint);
+	EXPECT_EQ(Joint.m_BodyA, 0);
+	EXPECT_EQ(Joint.m_BodyB, 1);
+	EXPECT_FALSE(Joint.m_CollideConnected);
+	EXPECT_NEAR(Joint.m_AnchorB.x, -100.0f, 0.01f);
+	EXPECT_NEAR(Joint.m_ReferenceAngle, 0.25f, 0.001f);
+}
+
+TEST(Box2DSave, Truncated)
+{
+	std::vector<unsigned char> vData;
+	TwoBoxes().Pack(vData);
+	for(unsigned Size = 0; Size < vData.size(); Size++)
+	{
+		CBox2DWorldState Loaded;
+		EXPECT_FALSE(Loaded.Unpack(vData.data(), Size));
+		EXPECT_TRUE(Loaded.Empty());
+	}
+}
+
+TEST(Box2DSave, InvalidJointBody)
+{
+	CBox2DWorldState State = TwoBoxes();
+	State.m_vJoints[0].m_BodyB = 2;
+	std::vector<unsigned char> vData;
+	State.Pack(vData);
+	CBox2DWorldState Loaded;
+	EXPECT_FALSE(Loaded.Unpack(vData.data(), vData.size()));
+}
+
+TEST(Box2DSave, VersionWithoutFriction)
+{
+	// version, bodies, joints, then a box without its friction
+	const int aValues[] = {1, 1, 0, b2_dynamicBody, 64, 128, 0, 0, 0, 0, 32, 32, 1024};
+	std::vector<unsigned char> vData;
+	for(int Value : aValues)
+	{
+		unsigned char aBuf[8];
+		unsigned char *pEnd = CVariableInt::Pack(aBuf, Value);
+		vData.insert(vData.end(), aBuf, pEnd);
+	}
+	CBox2DWorldState Loaded;
+	ASSERT_TRUE(Loaded.Unpack(vData.data(), vData.size()));
+	ASSERT_EQ(Loaded.m_vBodies.size(), 1u);
+	EXPECT_EQ(Loaded.m_vBodies[0].m_Pos, vec2(1, 2));
+	EXPECT_FLOAT_EQ(Loaded.m_vBodies[0].m_Density, 1.0f);
+	EXPECT_FLOAT_EQ(Loaded.m_vBodies[0].m_Friction, 0.2f);
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include <engine/shared/protocol.h>
+#include <game/server/box2d_world.h>
+
+#include <box2d/box2d.h>
+
+// like a world saved before a map reload and loaded into a fresh one, no
+// character comes by afterwards
+TEST(Box2DWorld, KeepLoadedBoxes)
+{
+	CBox2DWorldState Saved;
+	CBox2DBodyState Box = {b2_dynamicBody, vec2(100.0f, 0.0f), 0.0f, vec2(0.0f, 0.0f), 0.0f, ivec2(32, 32), 1.0f, 0.2f};
+	CBox2DBodyState Platform = {b2_staticBody, vec2(100.0f, 64.0f), 0.0f, vec2(0.0f, 0.0f), 0.0f, ivec2(256, 16), 1.0f, 0.2f};
+	Saved.m_vBodies.push_back(Box);
+	Saved.m_vBodies.push_back(Platform);
+	std::vector<unsigned char> vData;
+	Saved.Pack(vData);
+	CBox2DWorldState State;
+	ASSERT_TRUE(State.Unpack(vData.data(), vData.size()));
+
+	CBox2DWorld World(b2Vec2(0.0f, 10.0f));
+	World.m_LastUsedTick = 0;
+	std::vector<b2Body *> vpBodies;
+	for(const CBox2DBodyState &Body : State.m_vBodies)
+		vpBodies.push_back(World.CreateBox(Body, 0));
+	EXPECT_EQ(World.NumBoxes(), 2);
+
+	for(int Tick = 1; Tick <= SERVER_TICK_SPEED * 20; Tick++)
+	{
+		World.StartStep(1.0f / SERVER_TICK_SPEED, 1.0f / SERVER_TICK_SPEED, 1, 8, 3, 0);
+		World.Sync();
+		ASSERT_FALSE(World.Reclaimable(Tick, SERVER_TICK_SPEED));
+	}
+
+	// once the boxes are gone, the world is only kept for a while
+	World.DestroyBox(vpBodies[0]);
+	EXPECT_FALSE(World.Reclaimable(SERVER_TICK_SPEED * 20, SERVER_TICK_SPEED));
+	World.DestroyBox(vpBodies[1]);
+	EXPECT_EQ(World.NumBoxes(), 0);
+	EXPECT_FALSE(World.Reclaimable(SERVER_TICK_SPEED * 10, SERVER_TICK_SPEED));
+	EXPECT_TRUE(World.Reclaimable(SERVER_TICK_SPEED * 20, SERVER_TICK_SPEED));
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <engine/shared/snapshot.h>
+
+#include <algorithm>
+#include <vector>
+
+// a snapshot of Size bytes filled with Tick, so it can be told apart
+static std::vector<char> Snap(int Tick, int Size)
+{
+	return std::vector<char>(Size, (char)Tick);
+}
+
+static void ExpectSnap(CSnapshotStorage *pStorage, int Tick, int Size)
+{
+	CSnapshot *pData;
+	ASSERT_EQ(pStorage->Get(Tick, 0, &pData, 0), Size);
+	EXPECT_EQ(mem_comp(pData, Snap(Tick, Size).data(), Size), 0);
+}
+
+TEST(SnapshotStorage, AddGetPurge)
+{
+	CSnapshotStorage Storage;
+	EXPECT_EQ(Storage.Get(0, 0, 0, 0), -1);
+	for(int Tick = 0; Tick < 10; Tick++)
+		Storage.Add(Tick, Tick * 100, 1000 + Tick, Snap(Tick, 1000 + Tick).data(), 0);
+
+	int64_t Tagtime;
+	CSnapshot *pAlt;
+	EXPECT_EQ(Storage.Get(3, &Tagtime, 0, &pAlt), 1003);
+	EXPECT_EQ(Tagtime, 300);
+	EXPECT_EQ(pAlt, nullptr);
+	for(int Tick = 0; Tick < 10; Tick++)
+		ExpectSnap(&Storage, Tick, 1000 + Tick);
+	EXPECT_EQ(Storage.Get(10, 0, 0, 0), -1);
+	EXPECT_EQ(Storage.Get(-1, 0, 0, 0), -1);
+
+	Storage.PurgeUntil(5);
+	EXPECT_EQ(Storage.m_pFirst->m_Tick, 5);
+	EXPECT_EQ(Storage.m_pLast->m_Tick, 9);
+	EXPECT_EQ(Storage.Get(4, 0, 0, 0), -1);
+	ExpectSnap(&Storage, 5, 1005);
+
+	Storage.PurgeUntil(100);
+	EXPECT_EQ(Storage.m_pFirst, nullptr);
+	EXPECT_EQ(Storage.m_pLast, nullptr);
+	EXPECT_EQ(Storage.Get(9, 0, 0, 0), -1);
+}
+
+TEST(SnapshotStorage, Alt)
+{
+	CSnapshotStorage Storage;
+	Storage.Add(1, 0, 64, Snap(1, 64).data(), 1);
+	CSnapshot *pData;
+	CSnapshot *pAlt;
+	ASSERT_EQ(Storage.Get(1, 0, &pData, &pAlt), 64);
+	ASSERT_NE(pAlt, nullptr);
+	EXPECT_NE(pData, pAlt);
+	EXPECT_EQ(mem_comp(pAlt, Snap(1, 64).data(), 64), 0);
+}
+
+// keeps three seconds of snapshots of changing sizes like the server, the
+// ring wraps around and grows while the holders stay where they are
+TEST(SnapshotStorage, Ring)
+{
+	CSnapshotStorage Storage;
+	std::vector<CSnapshotStorage::CHolder *> vpHolders;
+	for(int Tick = 0; Tick < 2000; Tick++)
+	{
+		int Size = 100 + (Tick * 7919) % 3000;
+		Storage.PurgeUntil(Tick - 150);
+		Storage.Add(Tick, Tick, Size, Snap(Tick, Size).data(), 0);
+		vpHolders.push_back(Storage.m_pLast);
+
+		int Oldest = Tick < 150 ? 0 : Tick - 150;
+		ASSERT_EQ(Storage.m_pFirst->m_Tick, Oldest);
+		for(int Kept = Oldest; Kept <= Tick; Kept += 37)
+		{
+			ASSERT_EQ(Storage.Get(Kept, 0, 0, 0), 100 + (Kept * 7919) % 3000);
+			ASSERT_EQ(vpHolders[Kept]->m_Tick, Kept);
+		}
+	}
+	for(int Tick = 1850; Tick < 2000; Tick++)
+		ExpectSnap(&Storage, Tick, 100 + (Tick * 7919) % 3000);
+
+	// the list is in order
+	int Tick = 1849;
+	for(CSnapshotStorage::CHolder *pHolder = Storage.m_pFirst; pHolder; pHolder = pHolder->m_pNext)
+		EXPECT_EQ(pHolder->m_Tick, Tick++);
+	EXPECT_EQ(Tick, 2000);
+}
+
+TEST(SnapshotStorage, SharedSlots)
+{
+	CSnapshotStorage Storage;
+	// more ticks than the lookup table has slots
+	for(int Tick = 0; Tick < 1000; Tick += 3)
+		Storage.Add(Tick, 0, 16, Snap(Tick, 16).data(), 0);
+	for(int Tick = 0; Tick < 1000; Tick += 3)
+		ExpectSnap(&Storage, Tick, 16);
+	EXPECT_EQ(Storage.Get(1, 0, 0, 0), -1);
+
+	// the oldest snapshot of a tick is found
+	Storage.Add(999, 0, 32, Snap(1, 32).data(), 0);
+	ExpectSnap(&Storage, 999, 16);
+
+	Storage.PurgeUntil(990);
+	for(int Tick = 990; Tick < 1000; Tick += 3)
+		ExpectSnap(&Storage, Tick, 16);
+	EXPECT_EQ(Storage.Get(987, 0, 0, 0), -1);
+
+	Storage.PurgeAll();
+	EXPECT_EQ(Storage.Get(999, 0, 0, 0), -1);
+	Storage.Add(5, 0, 16, Snap(5, 16).data(), 0);
+	ExpectSnap(&Storage, 5, 16);
+}
+
+TEST(SnapshotStorage, Large)
+{
+	CSnapshotStorage Storage;
+	Storage.Add(0, 0, 100, Snap(0, 100).data(), 0);
+	// larger than the first ring
+	Storage.Add(1, 0, CSnapshot::MAX_SIZE, Snap(1, CSnapshot::MAX_SIZE).data(), 1);
+	Storage.Add(2, 0, 100, Snap(2, 100).data(), 0);
+	ExpectSnap(&Storage, 0, 100);
+	ExpectSnap(&Storage, 1, CSnapshot::MAX_SIZE);
+	ExpectSnap(&Storage, 2, 100);
+	Storage.PurgeUntil(1);
+	ExpectSnap(&Storage, 1, CSnapshot::MAX_SIZE);
+	ExpectSnap(&Storage, 2, 100);
+}
+
+TEST(SnapshotDelta, DiffItem)
+{
+	// every size, so all vector widths and the scalar rest are used
+	for(int Size = 0; Size <= 20; Size++)
+	{
+		std::vector<int> vPast(Size), vCurrent(Size), vOut(Size);
+		for(int i = 0; i < Size; i++)
+			vPast[i] = vCurrent[i] = i * 1000 - 7;
+		EXPECT_FALSE(CSnapshotDelta::DiffItem(vPast.data(), vCurrent.data(), vOut.data(), Size));
+		for(int Changed = 0; Changed < Size; Changed++)
+		{
+			vCurrent[Changed] = -123456;
+			EXPECT_TRUE(CSnapshotDelta::DiffItem(vPast.data(), vCurrent.data(), vOut.data(), Size));
+			for(int i = 0; i < Size; i++)
+				EXPECT_EQ(vOut[i], vCurrent[i] - vPast[i]);
+			vCurrent[Changed] = vPast[Changed];
+		}
+	}
+}
+
+// items of many sizes and ids, more than share a slot. type 2 has a static
+// size
+static int BuildSnap(CSnapshotBuilder *pBuilder, char *pData, int Tick)
+{
+	pBuilder->Init();
+	for(int i = 0; i < 300; i++)
+	{
+		// some come and go, some stay the same, some change
+		if((i + Tick) % 7 == 0)
+			continue;
+		int Type = i % 3 + 1;
+		int Size = Type == 2 ? 4 : 1 + i % 13;
+		int *pItem = (int *)pBuilder->NewItem(Type, i * 16, Size * 4);
+		for(int j = 0; j < Size; j++)
+			pItem[j] = i % 5 == 0 ? i + j : i * j + Tick * (j % 3);
+	}
+	return pBuilder->Finish(pData);
+}
+
+TEST(SnapshotDelta, RoundTrip)
+{
+	CSnapshotBuilder Builder;
+	static CSnapshotDelta s_Delta;
+	s_Delta.SetStaticsize(2, 4 * sizeof(int));
+	std::vector<char> vFrom(CSnapshot::MAX_SIZE), vTo(CSnapshot::MAX_SIZE), vDelta(CSnapshot::MAX_SIZE), vUnpacked(CSnapshot::MAX_SIZE);
+	for(int Tick = 1; Tick < 10; Tick++)
+	{
+		BuildSnap(&Builder, vFrom.data(), Tick - 1);
+		int Size = BuildSnap(&Builder, vTo.data(), Tick);
+		CSnapshot *pFrom = (CSnapshot *)vFrom.data();
+		CSnapshot *pTo = (CSnapshot *)vTo.data();
+
+		int DeltaSize = s_Delta.CreateDelta(pFrom, pTo, vDelta.data());
+		ASSERT_GT(DeltaSize, 0);
+		ASSERT_EQ(s_Delta.UnpackDelta(pFrom, (CSnapshot *)vUnpacked.data(), vDelta.data(), DeltaSize), Size);
+
+		// the new items come last
+		CSnapshot *pUnpacked = (CSnapshot *)vUnpacked.data();
+		ASSERT_EQ(pUnpacked->NumItems(), pTo->NumItems());
+		for(int i = 0; i < pTo->NumItems(); i++)
+		{
+			int Index = pUnpacked->GetItemIndex(pTo->GetItem(i)->Key());
+			ASSERT_NE(Index, -1);
+			ASSERT_EQ(pUnpacked->GetItemSize(Index), pTo->GetItemSize(i));
+			EXPECT_EQ(mem_comp(pUnpacked->GetItem(Index)->Data(), pTo->GetItem(i)->Data(), pTo->GetItemSize(i)), 0);
+		}
+
+		// nothing changed
+		EXPECT_EQ(s_Delta.CreateDelta(pTo, pTo, vDelta.data()), 0);
+	}
+}
+
+TEST(SnapshotDeltaCache, Share)
+{
+	CSnapshotBuilder Builder;
+	std::vector<char> vBase(CSnapshot::MAX_SIZE), vSnap(CSnapshot::MAX_SIZE), vSame(CSnapshot::MAX_SIZE), vOther(CSnapshot::MAX_SIZE);
+	int BaseSize = BuildSnap(&Builder, vBase.data(), 1);
+	int Size = BuildSnap(&Builder, vSnap.data(), 2);
+	BuildSnap(&Builder, vSame.data(), 2);
+	CSnapshot *pBase = (CSnapshot *)vBase.data();
+	CSnapshot *pSnap = (CSnapshot *)vSnap.data();
+	CSnapshot *pSame = (CSnapshot *)vSame.data();
+
+	// the same data with two values swapped, like the local flag of two
+	// players, has the same crc
+	mem_copy(vOther.data(), vSnap.data(), Size);
+	CSnapshot *pOther = (CSnapshot *)vOther.data();
+	std::swap(pOther->GetItem(1)->Data()[1], pOther->GetItem(1)->Data()[2]);
+	ASSERT_EQ(pOther->Crc(), pSnap->Crc());
+	ASSERT_NE(mem_comp(pOther, pSnap, Size), 0);
+
+	CSnapshotDeltaCache Cache;
+	EXPECT_EQ(Cache.Find(3, 0, pBase, BaseSize, pBase->Crc(), pSnap, Size, pSnap->Crc()), 3);
+	// two clients with the same snapshots share one delta
+	EXPECT_EQ(Cache.Find(5, 0, pBase, BaseSize, pBase->Crc(), pSame, Size, pSame->Crc()), 3);
+	// but not with other static item sizes, a crc collision or another base
+	EXPECT_EQ(Cache.Find(6, 1, pBase, BaseSize, pBase->Crc(), pSame, Size, pSame->Crc()), 6);
+	EXPECT_EQ(Cache.Find(7, 0, pBase, BaseSize, pBase->Crc(), pOther, Size, pOther->Crc()), 7);
+	EXPECT_EQ(Cache.Find(8, 0, pSnap, Size, pSnap->Crc(), pSame, Size, pSame->Crc()), 8);
+	EXPECT_EQ(Cache.NumLookups(), 5);
+	EXPECT_EQ(Cache.NumHits(), 1);
+
+	// the next tick starts over, the counts are kept
+	Cache.Clear();
+	EXPECT_EQ(Cache.Find(5, 0, pBase, BaseSize, pBase->Crc(), pSame, Size, pSame->Crc()), 5);
+	EXPECT_EQ(Cache.NumLookups(), 6);
+}
@@ -4,10 +4,29 @@
 #include <engine/server.h>
 #include <engine/shared/config.h>
 #include <game/gamecore.h>
+#include <game/server/box2d_history.h>
+#include <game/server/box2d_replay.h>
+#include <game/server/box2d_tee.h>
+#include <game/server/box2d_world.h>
 #include <game/server/teehistorian.h>
 
+#include <vector>
+
 void RegisterGameUuids(CUuidManager *pManager);
 
+// the header lists all uuids and doesn't fit into a CPacker anymore
+class COutputBuffer
+{
+	std::vector<unsigned char> m_vData;
+
+public:
+	void Reset() { m_vData.clear(); }
+	void AddRaw(const void *pData, int Size) { m_vData.insert(m_vData.end(), (const unsigned char *)pData, (const unsigned char *)pData + Size); }
+	int Size() const { return m_vData.size(); }
+	const unsigned char *Data() const { return m_vData.data(); }
+	bool Error() const { return false; }
+};
+
 class TeeHistorian : public ::testing::Test
 {
 protected:
@@ -17,7 +36,7 @@ protected:
 	CUuidManager m_UuidManager;
 	CTeeHistorian::CGameInfo m_GameInfo;
 
-	CPacker m_Buffer;
+	COutputBuffer m_Buffer;
 
 	enum
 	{
@@ -96,7 +115,7 @@ protected:
 		char aTimeBuf[64];
 		str_timestamp_ex(m_GameInfo.m_StartTime, aTimeBuf, sizeof(aTimeBuf), "%Y-%m-%dT%H:%M:%S%z");
 
-		CPacker Buffer;
+		COutputBuffer Buffer;
 		Buffer.Reset();
 		Buffer.AddRaw(&TEEHISTORIAN_UUID, sizeof(TEEHISTORIAN_UUID));
 		Buffer.AddRaw(PREFIX1, str_length(PREFIX1));
@@ -532,3 +551,76 @@ TEST_F(TeeHistorian, LoadFailed)
 	Finish();
 	Expect(EXPECTED, sizeof(EXPECTED));
 }
+
+TEST_F(TeeHistorian, B2Checksum)
+{
+	const unsigned char EXPECTED[] = {
+		// EX uuid=f96c0c63-4c8e-3cb6-93bf-a95862cd06d7 datalen=6
+		0x4a,
+		0xf9, 0x6c, 0x0c, 0x63, 0x4c, 0x8e, 0x3c, 0xb6,
+		0x93, 0xbf, 0xa9, 0x58, 0x62, 0xcd, 0x06, 0xd7,
+		0x06,
+		// team=3
+		0x03,
+		// checksum=0x12345678
+		0xb8, 0xd9, 0xa2, 0xa3, 0x02,
+		// FINISH
+		0x40};
+
+	m_TH.RecordB2Checksum(3, 0x12345678);
+	Finish();
+	Expect(EXPECTED, sizeof(EXPECTED));
+}
+
+TEST_F(TeeHistorian, B2Replay)
+{
+	// a box falls on a walking tee that hammers it, recorded the way
+	// CGameContext::TickB2Worlds() does it
+	const float TickTime = 1.0f / 50;
+	CBox2DWorld World(b2Vec2(0.f, 9.81f));
+	CBox2DTee Tee;
+	CBox2DBodyState Box = {b2_dynamicBody, vec2(96.0f, 0.0f), 0.0f, vec2(0.0f, 0.0f), 0.0f, ivec2(32, 32), 1.0f, 0.2f};
+	CBox2DWorldState State;
+	State.m_vBodies.push_back(Box);
+	std::vector<unsigned char> vState;
+	PackBox2DHistoryState(State, vState);
+
+	for(int t = 1; t <= 100; t++)
+	{
+		Tick(t);
+		vec2 Pos(t * 2, 64);
+		if(t == 1)
+		{
+			m_TH.RecordB2WorldCreate(0, false, false);
+			m_TH.RecordB2Boxes(0, 0, vState.data(), vState.size());
+			CreateBox2DBox(&World, Box, 0);
+			m_TH.RecordB2TeeCreate(0, 0, Pos.x, Pos.y);
+			Tee.Create(&World, Pos);
+		}
+		if(t == 40)
+		{
+			m_TH.RecordB2TeeHammer(0, 0.0f, -1.0f);
+			Tee.Hammer(vec2(0.0f, -1.0f));
+		}
+		Player(0, Pos.x, Pos.y);
+		Inputs();
+
+		if(t % 10 == 0)
+			m_TH.RecordB2Checksum(0, Box2DWorldChecksum(&World));
+		Tee.Tick(Pos, TickTime, TickTime);
+		m_TH.RecordB2Step(0, TickTime, TickTime, 1, 8, 3);
+		World.m_Explosions.Tick();
+		World.StartStep(TickTime, TickTime, 1, 8, 3, 0);
+		World.Sync();
+	}
+	Finish();
+
+	// the chunks after the header
+	int HeaderSize = sizeof(CUuid) + str_length((const char *)m_Buffer.Data() + sizeof(CUuid)) + 1;
+	std::vector<CTileOutline> vOutlines;
+	std::vector<CQuadPolygon> vQuads;
+	CBox2DReplay Replay(vOutlines, vQuads);
+	EXPECT_TRUE(Replay.Run(m_Buffer.Data() + HeaderSize, m_Buffer.Size() - HeaderSize)) << Replay.Error();
+	EXPECT_EQ(Replay.NumChecksums(), 10);
+	EXPECT_EQ(Replay.DivergentTick(), -1);
+}
@@ -0,0 +1,134 @@
+#include <base/system.h>
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/shared/json.h>
+#include <engine/shared/protocol.h>
+#include <engine/storage.h>
+#include <game/box2d_map.h>
+#include <game/collision.h>
+#include <game/layers.h>
+#include <game/server/box2d_replay.h>
+
+#include <vector>
+
+static bool LoadMap(const char *pMapName, std::vector<CTileOutline> &vOutlines, std::vector<CQuadPolygon> &vQuads, SHA256_DIGEST *pSha256)
+{
+	IKernel *pKernel = IKernel::Create();
+	IStorage *pStorage = CreateLocalStorage();
+	IEngineMap *pEngineMap = CreateEngineMap();
+	pKernel->RegisterInterface(pStorage);
+	pKernel->RegisterInterface(pEngineMap); // register as both
+	pKernel->RegisterInterface(static_cast<IMap *>(pEngineMap), false);
+
+	bool Result = pEngineMap->Load(pMapName);
+	if(Result)
+	{
+		// the same map bodies as the server builds them
+		CLayers Layers;
+		CCollision Collision;
+		Layers.Init(pKernel);
+		Collision.Init(&Layers);
+		std::vector<unsigned char> vSolid;
+		GetSolidTiles(&Collision, vSolid);
+		FindTileOutlines(vSolid.data(), Collision.GetWidth(), Collision.GetHeight(), vOutlines);
+		GetPhysicsQuads(&Layers, vQuads);
+		*pSha256 = pEngineMap->Sha256();
+	}
+	delete pKernel;
+	return Result;
+}
+
+// checks that the recording is of the map, returns the size of the header
+static int ReadHeader(const unsigned char *pData, int Size, SHA256_DIGEST MapSha256)
+{
+	static const CUuid TEEHISTORIAN_UUID = CalculateUuid("teehistorian@ddnet.tw");
+	if(Size < (int)sizeof(CUuid) || mem_comp(pData, &TEEHISTORIAN_UUID, sizeof(CUuid)) != 0)
+	{
+		dbg_msg("box2d_replay", "not a teehistorian file");
+		return -1;
+	}
+	const char *pJson = (const char *)pData + sizeof(CUuid);
+	int JsonSize = str_length(pJson);
+	if((int)sizeof(CUuid) + JsonSize >= Size)
+	{
+		dbg_msg("box2d_replay", "the header is truncated");
+		return -1;
+	}
+
+	json_value *pHeader = json_parse(pJson, JsonSize);
+	const json_value *pMapSha256 = pHeader ? json_object_get(pHeader, "map_sha256") : 0;
+	bool SameMap = true;
+	if(pMapSha256 && pMapSha256->type == json_string)
+	{
+		char aMapSha256[SHA256_MAXSTRSIZE];
+		sha256_str(MapSha256, aMapSha256, sizeof(aMapSha256));
+		SameMap = str_comp(json_string_get(pMapSha256), aMapSha256) == 0;
+	}
+	json_value_free(pHeader);
+	if(!SameMap)
+	{
+		dbg_msg("box2d_replay", "the teehistorian was recorded on a different map");
+		return -1;
+	}
+	return sizeof(CUuid) + JsonSize + 1;
+}
+
+// usage: box2d_replay <teehistorian> <map>
+int main(int argc, const char **argv)
+{
+	dbg_logger_stdout();
+	if(argc != 3)
+	{
+		dbg_msg("usage", "%s <teehistorian> <map>", argv[0]);
+		return -1;
+	}
+
+	std::vector<CTileOutline> vOutlines;
+	std::vector<CQuadPolygon> vQuads;
+	SHA256_DIGEST MapSha256;
+	if(!LoadMap(argv[2], vOutlines, vQuads, &MapSha256))
+	{
+		dbg_msg("box2d_replay", "failed to load map '%s'", argv[2]);
+		return -1;
+	}
+
+	IOHANDLE File = io_open(argv[1], IOFLAG_READ);
+	if(!File)
+	{
+		dbg_msg("box2d_replay", "failed to open '%s'", argv[1]);
+		return -1;
+	}
+	long Length = io_length(File);
+	std::vector<unsigned char> vData(maximum(Length, 0L));
+	bool ReadError = Length < 0 || io_read(File, vData.data(), vData.size()) != vData.size();
+	io_close(File);
+	if(ReadError)
+	{
+		dbg_msg("box2d_replay", "failed to read '%s'", argv[1]);
+		return -1;
+	}
+	// neither an unterminated header nor a truncated int at the very end
+	// may be read past the buffer
+	int Size = vData.size();
+	vData.resize(Size + 8, 0);
+	int HeaderSize = ReadHeader(vData.data(), Size, MapSha256);
+	if(HeaderSize < 0)
+		return -1;
+
+	CBox2DReplay Replay(vOutlines, vQuads);
+	bool Result = Replay.Run(vData.data() + HeaderSize, Size - HeaderSize);
+	if(!Result)
+	{
+		if(Replay.DivergentTick() >= 0)
+		{
+			dbg_msg("box2d_replay", "tick %d: the world of team %d diverged, checksum %08x recorded, %08x replayed",
+				Replay.DivergentTick(), Replay.DivergentTeam(), Replay.RecordedChecksum(), Replay.ReplayedChecksum());
+		}
+		else
+		{
+			dbg_msg("box2d_replay", "%s", Replay.Error());
+		}
+	}
+	dbg_msg("box2d_replay", "replayed %d box2d chunks, %d checksums matched", Replay.NumChunks(), Replay.NumChecksums() - (Replay.DivergentTick() >= 0));
+	return Result ? 0 : 1;
+}